@@ -15,12 +15,16 @@
 #ifndef PROTOPUF_ARRAY_H
 #define PROTOPUF_ARRAY_H
 
+#include <bit>
+#include <cstring>
 #include <ranges>
 #include <string>
 #include <vector>
 #include "coder.h"
 #include "varint.h"
 #include "skip.h"
+#include "small_vector.h"
+#include "utf8.h"
 
 namespace pp {
 
@@ -35,6 +39,58 @@ namespace pp {
     template <typename T>
     concept insertable_sized_range = insertable_range<T> && std::ranges::sized_range<T>;
 
+    /// @brief A `std::ranges::sized_range` whose capacity is bounded at compile time, 
+    /// as `T::static_capacity` is the maximum number of elements, i.e. @ref static_vector.
+    template <typename T>
+    concept bounded_range = std::ranges::sized_range<T> && requires {
+        { T::static_capacity } -> std::convertible_to<std::size_t>;
+    };
+
+    /// Checks whether `n` more elements can be inserted into the range `con`, which is false only for a full @ref bounded_range
+    template <std::ranges::sized_range R>
+    constexpr bool has_room(const R& con, std::size_t n = 1) {
+        if constexpr (bounded_range<R>) {
+            return n <= R::static_capacity - std::ranges::size(con);
+        } else {
+            return true;
+        }
+    }
+
+    /// @brief Checks @ref has_room in the @ref coder_mode `Mode`,
+    /// where a failure is reported as @ref coder_error_code::capacity_exceeded at the beginning of `b` (the value which does not fit)
+    template <coder_mode Mode, std::ranges::sized_range R>
+    constexpr bool check_room(const R& con, bytes b, std::size_t n = 1) {
+        if (has_room(con, n)) {
+            return true;
+        }
+
+        report_coder_error<Mode>(coder_error_code::capacity_exceeded, b.data());
+        return false;
+    }
+
+    /// @brief Checks whether values of the @ref coder `C` are encoded as their object representations,
+    /// i.e. fixed-length integers and floating points on a little-endian machine, so that they can be copied in bulk
+    template <typename C>
+    constexpr inline bool is_trivially_encoded = false;
+
+    template <std::integral T> requires (!std::same_as<T, bool>)
+    constexpr inline bool is_trivially_encoded<integer_coder<T>> = std::endian::native == std::endian::little;
+
+    template <std::floating_point T>
+    constexpr inline bool is_trivially_encoded<float_coder<T>> = std::endian::native == std::endian::little;
+
+    /// A concept satisfied while values of the @ref coder `C` can be copied in bulk from their encoded bytes, ref to @ref is_trivially_encoded
+    template <typename C>
+    concept trivially_encoded_coder = coder<C> && is_trivially_encoded<C>;
+
+    /// Reserves the range `con` for `n` elements in total if it supports `reserve`, which is skipped for a @ref bounded_range
+    template <std::ranges::sized_range R>
+    constexpr void reserve_at_least(R& con, std::size_t n) {
+        if constexpr (!bounded_range<R> && requires { con.reserve(n); }) {
+            con.reserve(n);
+        }
+    }
+
     /// @brief A @ref coder for range types, i.e. `std::vector<T>`.
     ///
     /// @param C the @ref coder for the element type of the range types, i.e. `C = integer_coder<int>` for `R = std::vector<int>`
@@ -68,6 +124,35 @@ namespace pp {
 
         template <coder_mode Mode = safe_mode>
         static constexpr decode_result<R, Mode> decode(bytes b) {
+            R con = make_value<R>();
+            if (!Mode::get_value_from_result(decode_append<Mode>(con, b), b)) {
+                return {};
+            }
+
+            return Mode::template make_result<decode_result<R, Mode>>(std::move(con), b);
+        }
+
+        /// @brief Decode into the existing range `con`, which is cleared but keeps its capacity, ref to @ref pp::decode_into
+        template <coder_mode Mode = safe_mode> requires requires(R con) { con.clear(); }
+        static constexpr decode_into_result<Mode> decode_into(R& con, bytes b) {
+            con.clear();
+            return decode_append<Mode>(con, b);
+        }
+
+        /// Decode into the existing range `con` as an @ref in_place_decoder, ref to `decode_into`
+        template <coder_mode Mode = safe_mode> requires requires(R con) { con.clear(); }
+        static constexpr decode_to_result<Mode> decode_to(R& con, bytes b) {
+            return decode_into<Mode>(con, b);
+        }
+
+        /// @brief Decode a range (with its length prefix) from `b`, and append its elements to the range `con`
+        ///
+        /// Elements of @ref trivially_encoded_coder are copied in bulk into a contiguous range,
+        /// and elements of other sequences are decoded by `C::decode_to` into the back of the range.
+        template <coder_mode Mode = safe_mode>
+        static constexpr decode_to_result<Mode> decode_append(R& con, bytes b) {
+            using T = typename C::value_type;
+
             decode_value<uint<8>> decode_len;
             if (!Mode::get_value_from_result(varint_coder<uint<8>>::decode<Mode>(b), decode_len)) {
                 return {};
@@ -75,23 +160,49 @@ namespace pp {
 
             uint<8> len = 0;
             std::tie(len, b) = decode_len;
-            R con;
 
-            if constexpr (requires { con.reserve(); }) {
-                con.reserve(len);
-            }
+            if constexpr (trivially_encoded_coder<C> && std::ranges::contiguous_range<R> &&
+                requires(std::size_t n) { con.resize(n); }) {
+                const std::size_t n = len / sizeof(T);
 
-            const auto origin_b = b;
-            decode_value<typename C::value_type> decode_v;
-            while(begin_diff(b, origin_b) < len) {
-                if (Mode::get_value_from_result(C::template decode<Mode>(b), decode_v)) {
-                    std::tie(*std::inserter(con, con.end()), b) = std::move(decode_v);
-                } else {
+                // the length should be a multiple of the element size, which is checked like a buffer size in safe mode
+                if (!check_length<Mode>(b, len) || !Mode::check_bytes_span(bytes{b.data(), n * sizeof(T)}, len) ||
+                    !check_room<Mode>(con, b, n)) {
                     return {};
                 }
-            }
 
-            return Mode::template make_result<decode_result<R, Mode>>(std::move(con), b);
+                if constexpr (sizeof(T) == 1 && requires(const T* p) { con.insert(con.end(), p, p); }) {
+                    const auto first = reinterpret_cast<const T*>(b.data());
+                    con.insert(con.end(), first, first + n);
+                } else if (n > 0) {
+                    const auto origin_size = std::ranges::size(con);
+                    con.resize(origin_size + n);
+                    std::memcpy(std::ranges::data(con) + origin_size, b.data(), n * sizeof(T));
+                }
+
+                return Mode::template make_result<decode_to_result<Mode>>(b.subspan(len));
+            } else if constexpr (in_place_decoder<C, Mode> && requires { { con.emplace_back() } -> std::same_as<T&>; }) {
+                const auto origin_b = b;
+                while(begin_diff(b, origin_b) < len) {
+                    if (!check_room<Mode>(con, b) || !Mode::get_value_from_result(C::template decode_to<Mode>(con.emplace_back(), b), b)) {
+                        return {};
+                    }
+                }
+
+                return Mode::template make_result<decode_to_result<Mode>>(b);
+            } else {
+                const auto origin_b = b;
+                auto decode_v = make_decode_value<T>();
+                while(begin_diff(b, origin_b) < len) {
+                    if (check_room<Mode>(con, b) && Mode::get_value_from_result(C::template decode<Mode>(b), decode_v)) {
+                        std::tie(*std::inserter(con, con.end()), b) = std::move(decode_v);
+                    } else {
+                        return {};
+                    }
+                }
+
+                return Mode::template make_result<decode_to_result<Mode>>(b);
+            }
         }
     };
 
@@ -122,7 +233,7 @@ namespace pp {
             uint<8> n = 0;
             std::tie(n, b) = decode_len;
 
-            if (!Mode::check_bytes_span(b, n)) {
+            if (!check_length<Mode>(b, n)) {
                 return {};
             }
 
@@ -130,6 +241,15 @@ namespace pp {
         }
     };
 
+    template <coder C, bounded_range R> requires bounded_coder<C>
+    struct max_encoded_size_impl<array_coder<C, R>> {
+    private:
+        static constexpr std::size_t content = R::static_capacity * max_encoded_size<C>;
+
+    public:
+        static constexpr std::size_t value = skipper<varint_coder<uint<8>>>::encode_skip(content) + content;
+    };
+
     /// Type alias of @ref coder for `std::basic_string<T>`
     template <integral T>
     using basic_string_coder = array_coder<integer_coder<T>, std::basic_string<T>>;
@@ -140,6 +260,98 @@ namespace pp {
     /// Type alias of @ref coder for `std::vector<uint<1>>`
     using bytes_coder = array_coder<integer_coder<uint<1>>>;
 
+    /// Type alias of @ref coder for @ref basic_inline_string
+    template <integral T, std::size_t N>
+    using basic_inline_string_coder = array_coder<integer_coder<T>, basic_inline_string<T, N>>;
+
+    /// Type alias of @ref coder for @ref inline_string
+    template <std::size_t N>
+    using inline_string_coder = basic_inline_string_coder<char, N>;
+
+    /// @brief A @ref coder for strings which should be valid UTF-8 (as proto3 `string` fields require), i.e. `std::string`
+    ///
+    /// It is encoded as @ref string_coder, while decoded strings are validated and copied in a single pass
+    /// (vectorized if available, ref to @ref copy_utf8), and invalid ones fail to decode except in @ref unsafe_mode.
+    template <typename R = std::string>
+    struct utf8_string_coder : array_coder<integer_coder<char>, R> {
+        using value_type = R;
+
+        utf8_string_coder() = delete;
+
+        template <coder_mode Mode = safe_mode>
+        static constexpr decode_result<R, Mode> decode(bytes b) {
+            R con = make_value<R>();
+            if (!Mode::get_value_from_result(decode_append<Mode>(con, b), b)) {
+                return {};
+            }
+
+            return Mode::template make_result<decode_result<R, Mode>>(std::move(con), b);
+        }
+
+        /// @brief Decode into the existing string `con`, which is cleared but keeps its capacity, ref to @ref pp::decode_into
+        template <coder_mode Mode = safe_mode>
+        static constexpr decode_into_result<Mode> decode_into(R& con, bytes b) {
+            con.clear();
+            return decode_append<Mode>(con, b);
+        }
+
+        /// Decode into the existing string `con` as an @ref in_place_decoder, ref to `decode_into`
+        template <coder_mode Mode = safe_mode>
+        static constexpr decode_to_result<Mode> decode_to(R& con, bytes b) {
+            return decode_into<Mode>(con, b);
+        }
+
+        /// @brief Decode a string (with its length prefix) from `b`, and append it to `con` if it is valid UTF-8
+        template <coder_mode Mode = safe_mode>
+        static constexpr decode_to_result<Mode> decode_append(R& con, bytes b) {
+            decode_value<uint<8>> decode_len;
+            if (!Mode::get_value_from_result(varint_coder<uint<8>>::decode<Mode>(b), decode_len)) {
+                return {};
+            }
+
+            uint<8> len = 0;
+            std::tie(len, b) = decode_len;
+
+            if (!check_length<Mode>(b, len) || !check_room<Mode>(con, b, len)) {
+                return {};
+            }
+
+            const auto origin_size = std::ranges::size(con);
+            con.resize(origin_size + len);
+            if constexpr (std::same_as<Mode, unsafe_mode>) {
+                std::memcpy(std::ranges::data(con) + origin_size, b.data(), len);
+            } else if (!copy_utf8(std::ranges::data(con) + origin_size, b.first(len))) {
+                con.resize(origin_size);
+                report_coder_error<Mode>(coder_error_code::invalid_utf8, b.data());
+                return {};
+            }
+
+            return Mode::template make_result<decode_to_result<Mode>>(b.subspan(len));
+        }
+    };
+
+    template <typename R>
+    struct skipper<utf8_string_coder<R>> : skipper<array_coder<integer_coder<char>, R>> {
+        using coder = utf8_string_coder<R>;
+    };
+
+    namespace pmr {
+
+        /// Type alias of @ref coder for `std::pmr::basic_string<T>`
+        template <integral T>
+        using basic_string_coder = array_coder<integer_coder<T>, std::pmr::basic_string<T>>;
+
+        /// Type alias of @ref coder for `std::pmr::string`
+        using string_coder = basic_string_coder<std::pmr::string::value_type>;
+
+        /// Type alias of @ref coder for `std::pmr::vector<uint<1>>`
+        using bytes_coder = array_coder<integer_coder<uint<1>>, std::pmr::vector<uint<1>>>;
+
+        /// Type alias of @ref utf8_string_coder for `std::pmr::string`
+        using utf8_string_coder = pp::utf8_string_coder<std::pmr::string>;
+
+    }
+
 }
 
 #endif //PROTOPUF_ARRAY_H
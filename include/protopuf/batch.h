@@ -0,0 +1,104 @@
+//   Copyright 2020-2021 PragmaTwice
+//
+//   Licensed under the Apache License, Version 2.0 (the "License");
+//   you may not use this file except in compliance with the License.
+//   You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the License is distributed on an "AS IS" BASIS,
+//   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//   See the License for the specific language governing permissions and
+//   limitations under the License.
+
+#ifndef PROTOPUF_BATCH_H
+#define PROTOPUF_BATCH_H
+
+#include "message.h"
+#include "thread_pool.h"
+
+#include <span>
+
+namespace pp {
+
+    /// @brief Decode many independent messages, i.e. `outputs[i]` is decoded from `inputs[i]`, by the @ref executor `exec`
+    ///
+    /// Messages are distributed to threads in chunks, so small messages do not pay the scheduling cost one by one.
+    /// Outputs are decoded in place via `message_coder::decode_into`, so reusing the outputs across batches avoids reallocation.
+    /// Inside a @ref memory_resource_scope, messages are decoded in the calling thread instead, since the resource may not be thread-safe.
+    /// So are they if `Mode` tracks nesting of fields (ref to @ref is_nesting_observed).
+    /// @returns `false` if any of the inputs fails to decode (only in safe mode), and the corresponding output is unspecified,
+    /// where the first failure found is stored into @ref last_coder_error (ref to @ref shared_coder_error)
+    template <message_c T, coder_mode Mode = safe_mode, executor E>
+    bool decode_batch(std::span<const bytes> inputs, std::span<T> outputs, E& exec) {
+        const std::size_t n = std::min(inputs.size(), outputs.size());
+        clear_coder_error<Mode>();
+        shared_coder_error error;
+
+        auto decode_chunk = [&](std::size_t begin, std::size_t end) {
+            for (std::size_t i = begin; i < end; ++i) {
+                bytes rest;
+                if (!Mode::get_value_from_result(message_coder<T>::template decode_into<Mode>(outputs[i], inputs[i]), rest)) {
+                    error.fail();
+                }
+            }
+        };
+
+        if (is_nesting_observed<Mode> || memory_resource_scope::active()) {
+            decode_chunk(0, n);
+        } else {
+            exec.parallel_for(n, decode_chunk);
+        }
+
+        return !error.restore();
+    }
+
+    /// Decode many independent messages by @ref default_thread_pool
+    template <message_c T, coder_mode Mode = safe_mode>
+    bool decode_batch(std::span<const bytes> inputs, std::span<T> outputs) {
+        return decode_batch<T, Mode>(inputs, outputs, default_thread_pool());
+    }
+
+    /// @brief Encode many independent messages, i.e. `msgs[i]` is encoded into `outputs[i]`, by the @ref executor `exec`
+    ///
+    /// Every output is shrunk to the encoded bytes after encoding.
+    /// If `Mode` tracks nesting of fields (ref to @ref is_nesting_observed), messages are encoded in the calling thread.
+    /// @returns `false` if any of the outputs has no enough space (only in safe mode), and the corresponding output is unspecified,
+    /// where the first failure found is stored into @ref last_coder_error (ref to @ref shared_coder_error)
+    template <message_c T, coder_mode Mode = safe_mode, executor E>
+    bool encode_batch(std::span<const T> msgs, std::span<bytes> outputs, E& exec) {
+        const std::size_t n = std::min(msgs.size(), outputs.size());
+        clear_coder_error<Mode>();
+        shared_coder_error error;
+
+        auto encode_chunk = [&](std::size_t begin, std::size_t end) {
+            for (std::size_t i = begin; i < end; ++i) {
+                bytes rest;
+                if (!Mode::get_value_from_result(message_coder<T>::template encode<Mode>(msgs[i], outputs[i]), rest)) {
+                    error.fail();
+                    continue;
+                }
+
+                outputs[i] = outputs[i].first(begin_diff(rest, outputs[i]));
+            }
+        };
+
+        if (is_nesting_observed<Mode>) {
+            encode_chunk(0, n);
+        } else {
+            exec.parallel_for(n, encode_chunk);
+        }
+
+        return !error.restore();
+    }
+
+    /// Encode many independent messages by @ref default_thread_pool
+    template <message_c T, coder_mode Mode = safe_mode>
+    bool encode_batch(std::span<const T> msgs, std::span<bytes> outputs) {
+        return encode_batch<T, Mode>(msgs, outputs, default_thread_pool());
+    }
+
+}
+
+#endif //PROTOPUF_BATCH_H
@@ -36,6 +36,14 @@ namespace pp {
         static constexpr decode_result<bool, Mode> decode(bytes b) {
             return integer_coder<uint<1>>::decode<Mode>(b);
         }
+
+        template <coder_mode Mode = safe_mode>
+        static constexpr decode_to_result<Mode> decode_to(bool& out, bytes b) {
+            uint<1> u{};
+            auto result = integer_coder<uint<1>>::decode_to<Mode>(u, b);
+            out = static_cast<bool>(u);
+            return result;
+        }
     };
 
 }
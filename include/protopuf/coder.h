@@ -18,6 +18,7 @@
 #include <utility>
 #include "byte.h"
 #include "coder_mode.h"
+#include "memory_resource.h"
 
 namespace pp {
 
@@ -32,12 +33,40 @@ namespace pp {
     template<typename T>
     using decode_value = std::pair<T, bytes>;
 
+    /// Make an empty @ref decode_value to receive a decoding result, where the object is constructed by @ref make_value
+    template<typename T>
+    constexpr decode_value<T> make_decode_value() {
+        return decode_value<T>{make_value<T>(), bytes{}};
+    }
+
     /// @brief A type which `decoder`'s `decode` returns.
     /// @param T the type of decoded object
     /// @param Mode the decoding mode
     template<typename T, coder_mode Mode>
     using decode_result = typename Mode::template result_type<decode_value<T>>;
 
+    /// @brief A type which `decode_into` returns, containing the `bytes` which remains not decoded.
+    /// @param Mode the decoding mode
+    template<coder_mode Mode>
+    using decode_into_result = typename Mode::template result_type<bytes>;
+
+    /// @brief A type which `decode_to` returns, containing the `bytes` which remains not decoded.
+    /// @param Mode the decoding mode
+    template<coder_mode Mode>
+    using decode_to_result = typename Mode::template result_type<bytes>;
+
+    /// @brief Check whether a length-delimited value of `len` bytes fits in the bytes `b` following its length prefix,
+    /// where a failure is reported as @ref coder_error_code::length_overflow (ref to @ref report_coder_error)
+    template<coder_mode Mode>
+    constexpr bool check_length(bytes b, std::size_t len) {
+        if (Mode::check_bytes_span(b, len)) {
+            return true;
+        }
+
+        report_coder_error<Mode>(coder_error_code::length_overflow, b.data());
+        return false;
+    }
+
     /// @brief Describes a type with static member function `encode`, which serializes an object to `bytes` (no ownership).
     ///
     /// Encoding can be performed in different modes.
@@ -77,6 +106,43 @@ namespace pp {
     template<typename T>
     concept coder = encoder<T> && decoder<T>;
 
+    /// @brief Describes a @ref coder with static member function `decode_to`, which decodes bytes into an existing object in place.
+    ///
+    /// All built-in coders provide it, so that decoding writes values directly into their destination
+    /// instead of returning them in a @ref decode_value pair to be moved out.
+    ///
+    /// Static member function `decode_to`:
+    /// @param v the object to be decoded into, which is overwritten by the decoded object
+    /// @param s the bytes which the object is decoded from (source bytes).
+    /// @returns the @ref decode_to_result, containing the bytes which remains not decoded.
+    template<typename C, typename Mode>
+    concept in_place_decoder = coder<C> && coder_mode<Mode> && requires(typename C::value_type& v, bytes s) {
+        { C::template decode_to<Mode>(v, s) } -> std::same_as<decode_to_result<Mode>>;
+    };
+
+    /// @brief Decode an object from bytes into the existing object `v` via the @ref coder `C`,
+    /// where resources owned by `v` (i.e. allocated capacity) are reused if possible.
+    ///
+    /// It calls `C::decode_into` if the coder provides one, otherwise `C::decode_to` if it is an @ref in_place_decoder,
+    /// otherwise it assigns the result of `C::decode` to `v`.
+    /// `v` holds the decoded object if decoding succeeds, or is left in a valid but unspecified state otherwise.
+    template<coder C, coder_mode Mode = safe_mode>
+    constexpr decode_into_result<Mode> decode_into(typename C::value_type& v, bytes b) {
+        if constexpr (requires { C::template decode_into<Mode>(v, b); }) {
+            return C::template decode_into<Mode>(v, b);
+        } else if constexpr (in_place_decoder<C, Mode>) {
+            return C::template decode_to<Mode>(v, b);
+        } else {
+            auto decode_v = make_decode_value<typename C::value_type>();
+            if (!Mode::get_value_from_result(C::template decode<Mode>(b), decode_v)) {
+                return {};
+            }
+
+            v = std::move(decode_v.first);
+            return Mode::template make_result<decode_into_result<Mode>>(decode_v.second);
+        }
+    }
+
 }
 
 #endif //PROTOPUF_CODER_H
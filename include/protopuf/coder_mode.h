@@ -15,7 +15,12 @@
 #ifndef PROTOPUF_CODER_MODE_H
 #define PROTOPUF_CODER_MODE_H
 
+#include <atomic>
+#include <cstdint>
+#include <memory>
 #include <optional>
+#include <type_traits>
+#include <variant>
 #include "byte.h"
 
 namespace pp {
@@ -106,7 +111,7 @@ namespace pp {
         template<typename T>
         static constexpr bool get_value_from_result(T&& result, auto& value) {
             if (result.has_value()) {
-                value = std::forward<decltype(*result)>(*result);
+                value = *std::forward<T>(result);
             } else {
                 return false;
             }
@@ -122,6 +127,219 @@ namespace pp {
         }
     };
 
+    /// @brief Safe @ref coder_mode for decoding bytes which are followed by at least `slop_size` readable bytes
+    ///
+    /// Like `EpsCopyInputStream` of protobuf, the caller guarantees that `slop_size` bytes past the end of the decoded bytes
+    /// can be read (e.g. the bytes are a part of a larger buffer, or the buffer is padded), while these bytes are never
+    /// decoded into values. Varints are then read without checking every byte, and checked only once after the whole varint,
+    /// so that there is a single check per field key and per value, as for fixed-width values.
+    ///
+    /// Encoding never touches the slop, and is checked as @ref safe_mode does.
+    struct slop_mode : safe_mode {
+        static constexpr std::size_t slop_size = 16;
+    };
+
+    /// The number of bytes past the end of the coded bytes which can be read in the @ref coder_mode `Mode`, ref to @ref slop_mode
+    template <typename Mode>
+    inline constexpr std::size_t readable_slop = 0;
+
+    template <typename Mode> requires requires { Mode::slop_size; }
+    inline constexpr std::size_t readable_slop<Mode> = Mode::slop_size;
+
+    /// The reason of a coding failure, ref to @ref error_mode
+    enum class coder_error_code : std::uint8_t {
+        /// no failure is reported
+        none,
+        /// the bytes end in the middle of a value, or the buffer is too small to encode into
+        truncated,
+        /// a varint is longer than 10 bytes
+        overlong_varint,
+        /// a field key has an unsupported wire type (i.e. groups), so the value cannot be skipped
+        bad_wire_type,
+        /// the length prefix of a length-delimited value exceeds the rest of the bytes
+        length_overflow,
+        /// a bounded container is full, ref to @ref bounded_range
+        capacity_exceeded,
+        /// a string is not valid UTF-8
+        invalid_utf8
+    };
+
+    /// A coding failure, i.e. the reason and the position in the bytes where it is found
+    struct coder_error {
+        coder_error_code code = coder_error_code::none;
+
+        /// the position of the failure, i.e. the beginning of the value which cannot be coded
+        const std::byte* position = nullptr;
+
+        /// the offset of the failure in the whole `input`, which the coded bytes are a part of
+        constexpr std::size_t offset(std::span<const std::byte> input) const {
+            return position - input.data();
+        }
+
+        constexpr bool operator==(const coder_error&) const = default;
+    };
+
+    /// The failure reported last in the current thread, which is captured by failed results of @ref error_mode,
+    /// ref to @ref clear_coder_error
+    inline thread_local coder_error last_coder_error;
+
+    /// @brief The first failure of concurrent tasks of a coding (i.e. elements coded by an @ref executor),
+    /// which is moved from the thread of the failing task into @ref last_coder_error of the calling thread
+    class shared_coder_error {
+    public:
+        /// mark the coding as failed, and keep the failure reported last in the current thread if no task failed before
+        void fail() noexcept {
+            if (!failed.exchange(true, std::memory_order_relaxed)) {
+                error = last_coder_error;
+            }
+        }
+
+        /// @brief Check whether any task failed, and store the kept failure into @ref last_coder_error of the current thread if so
+        ///
+        /// It should be called after all tasks are joined.
+        bool restore() const noexcept {
+            if (!failed.load(std::memory_order_relaxed)) {
+                return false;
+            }
+
+            last_coder_error = error;
+            return true;
+        }
+
+    private:
+        std::atomic<bool> failed = false;
+        coder_error error;
+    };
+
+    /// Report a failure in the @ref coder_mode `Mode` if it records failures (i.e. @ref error_mode), or do nothing otherwise
+    template <typename Mode>
+    constexpr void report_coder_error(coder_error_code code, const std::byte* position) {
+        if constexpr (requires { Mode::report_error(code, position); }) {
+            Mode::report_error(code, position);
+        }
+    }
+
+    /// @brief Clear @ref last_coder_error if the @ref coder_mode `Mode` records failures (i.e. @ref error_mode), or do nothing otherwise
+    ///
+    /// It is called once by entry points of coding messages (i.e. `message_coder::decode` and @ref decode_batch),
+    /// so that a failure without a report is not attributed to an earlier coding, while successful coders never touch the record.
+    template <typename Mode>
+    constexpr void clear_coder_error() {
+        if constexpr (requires { Mode::report_error(coder_error_code::none, nullptr); }) {
+            if (!std::is_constant_evaluated()) {
+                last_coder_error = {};
+            }
+        }
+    }
+
+    /// @brief The coding result of @ref error_mode, which holds either a value of type `T` or the @ref coder_error failing it
+    ///
+    /// A default-constructed result (i.e. `return {}` in coders) is a failure, which captures the failure reported last.
+    template <typename T>
+    class error_result {
+    public:
+        using value_type = T;
+
+        constexpr error_result() : v(std::in_place_index<1>, last_coder_error) {}
+
+        template <typename... Args>
+        constexpr explicit error_result(std::in_place_t, Args&&... args) : v(std::in_place_index<0>, std::forward<Args>(args)...) {}
+
+        template <typename U = T> requires std::constructible_from<T, U&&> && (!std::same_as<std::remove_cvref_t<U>, error_result>)
+        constexpr error_result(U&& u) : v(std::in_place_index<0>, std::forward<U>(u)) {}
+
+        constexpr error_result(coder_error e) : v(std::in_place_index<1>, e) {}
+
+        /// convert from a result holding a value of another type, as `std::optional` does
+        template <typename U> requires (!std::same_as<U, T>) && std::constructible_from<T, const U&>
+        constexpr error_result(const error_result<U>& other) : v(std::in_place_index<1>, other.error()) {
+            if (other.has_value()) {
+                v.template emplace<0>(*other);
+            }
+        }
+
+        template <typename U> requires (!std::same_as<U, T>) && std::constructible_from<T, U&&>
+        constexpr error_result(error_result<U>&& other) : v(std::in_place_index<1>, other.error()) {
+            if (other.has_value()) {
+                v.template emplace<0>(*std::move(other));
+            }
+        }
+
+        constexpr bool has_value() const noexcept {
+            return v.index() == 0;
+        }
+
+        constexpr explicit operator bool() const noexcept {
+            return has_value();
+        }
+
+        constexpr T& operator*() & { return *std::get_if<0>(&v); }
+        constexpr const T& operator*() const & { return *std::get_if<0>(&v); }
+        constexpr T&& operator*() && { return std::move(*std::get_if<0>(&v)); }
+
+        constexpr T* operator->() { return std::get_if<0>(&v); }
+        constexpr const T* operator->() const { return std::get_if<0>(&v); }
+
+        constexpr T& value() & { return std::get<0>(v); }
+        constexpr const T& value() const & { return std::get<0>(v); }
+
+        /// the failure, or a failure with @ref coder_error_code::none if it holds a value
+        constexpr coder_error error() const {
+            if (const auto* e = std::get_if<1>(&v)) {
+                return *e;
+            }
+            return {};
+        }
+
+    private:
+        std::variant<T, coder_error> v;
+    };
+
+    /// @brief Safe @ref coder_mode which reports why and where coding fails (the coding result is wrapped into @ref error_result)
+    ///
+    /// Bytes are checked as @ref safe_mode does, while a failed check records a @ref coder_error (into @ref last_coder_error),
+    /// which is carried by the failed result to the caller. The record is only written on failures,
+    /// and cleared once per coding by its entry point (ref to @ref clear_coder_error), so successes cost as in @ref safe_mode.
+    struct error_mode {
+        template<typename T>
+        using result_type = error_result<std::remove_reference_t<T>>;
+
+        template<typename R, typename... Args>
+        static constexpr R make_result(Args&&... args) {
+            return R{std::in_place, std::forward<Args>(args)...};
+        }
+
+        template<typename T>
+        static constexpr bool get_value_from_result(T&& result, auto& value) {
+            if (result.has_value()) {
+                value = *std::forward<T>(result);
+            } else {
+                return false;
+            }
+            return true;
+        }
+
+        static void report_error(coder_error_code code, const std::byte* position) {
+            last_coder_error = {code, position};
+        }
+
+        static constexpr bool check_iterator(bytes::iterator iter, bytes::iterator end) {
+            if (iter != end) {
+                return true;
+            }
+            report_error(coder_error_code::truncated, std::to_address(iter));
+            return false;
+        }
+
+        static constexpr bool check_bytes_span(bytes b, std::size_t offset) {
+            if (b.size() >= offset) {
+                return true;
+            }
+            report_error(coder_error_code::truncated, b.data());
+            return false;
+        }
+    };
+
 }
 
 #endif //PROTOPUF_CODER_MODE_H
\ No newline at end of file
@@ -0,0 +1,638 @@
+//   Copyright 2020-2021 PragmaTwice
+//
+//   Licensed under the Apache License, Version 2.0 (the "License");
+//   you may not use this file except in compliance with the License.
+//   You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the License is distributed on an "AS IS" BASIS,
+//   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//   See the License for the specific language governing permissions and
+//   limitations under the License.
+
+#ifndef PROTOPUF_COLUMNAR_H
+#define PROTOPUF_COLUMNAR_H
+
+#include "path.h"
+
+#include <bit>
+#include <cstdint>
+#include <memory>
+#include <tuple>
+#include <vector>
+
+// The Arrow C data interface, ref to https://arrow.apache.org/docs/format/CDataInterface.html
+// It is guarded by the same macro as in Arrow, so that it can be used together with Arrow headers.
+#ifndef ARROW_C_DATA_INTERFACE
+#define ARROW_C_DATA_INTERFACE
+
+#define ARROW_FLAG_DICTIONARY_ORDERED 1
+#define ARROW_FLAG_NULLABLE 2
+#define ARROW_FLAG_MAP_KEYS_SORTED 4
+
+struct ArrowSchema {
+    // Array type description
+    const char* format;
+    const char* name;
+    const char* metadata;
+    int64_t flags;
+    int64_t n_children;
+    struct ArrowSchema** children;
+    struct ArrowSchema* dictionary;
+
+    // Release callback
+    void (*release)(struct ArrowSchema*);
+    // Opaque producer-specific data
+    void* private_data;
+};
+
+struct ArrowArray {
+    // Array data description
+    int64_t length;
+    int64_t null_count;
+    int64_t offset;
+    int64_t n_buffers;
+    int64_t n_children;
+    const void** buffers;
+    struct ArrowArray** children;
+    struct ArrowArray* dictionary;
+
+    // Release callback
+    void (*release)(struct ArrowArray*);
+    // Opaque producer-specific data
+    void* private_data;
+};
+
+#endif // ARROW_C_DATA_INTERFACE
+
+namespace pp {
+
+    /// A bitmap in the layout of Arrow, i.e. the `i`-th bit is the `i % 8`-th least significant bit of the `i / 8`-th byte
+    class arrow_bitmap {
+    public:
+        std::size_t size() const noexcept { return n; }
+
+        bool operator[](std::size_t i) const {
+            return (bits[i / 8] >> (i % 8)) & 1u;
+        }
+
+        /// the number of set bits
+        std::size_t count() const noexcept {
+            std::size_t c = 0;
+            for (auto b : bits) {
+                c += std::popcount(b);
+            }
+            return c;
+        }
+
+        const uint<1>* data() const noexcept { return bits.data(); }
+
+        void push_back(bool v) {
+            if (n % 8 == 0) {
+                bits.push_back(0);
+            }
+            set(n++, v);
+        }
+
+        void set(std::size_t i, bool v) {
+            if (v) {
+                bits[i / 8] |= uint<1>(1u << (i % 8));
+            } else {
+                bits[i / 8] &= uint<1>(~(1u << (i % 8)));
+            }
+        }
+
+        // bits after the last one are kept cleared
+        void truncate(std::size_t m) {
+            while (n > m) {
+                set(--n, false);
+            }
+            bits.resize((n + 7) / 8);
+        }
+
+        void reserve(std::size_t m) { bits.reserve((m + 7) / 8); }
+        void clear() noexcept { bits.clear(); n = 0; }
+
+    private:
+        std::vector<uint<1>> bits;
+        std::size_t n = 0;
+    };
+
+    /// @brief The fixed-width type storing values of type `T` in an Arrow column, with its format string
+    ///
+    /// It is defined for integers (including Zigzag encoded ones), enumerations and floating points.
+    template <typename T>
+    struct arrow_primitive {};
+
+    template <typename T> requires (std::integral<T> && !std::same_as<T, bool>) || std::floating_point<T>
+    struct arrow_primitive<T> {
+        using type = T;
+
+        static constexpr type get(T v) { return v; }
+
+        static constexpr const char* format = [] {
+            if constexpr (std::floating_point<T>) {
+                return sizeof(T) == 4 ? "f" : "g";
+            } else if constexpr (std::signed_integral<T>) {
+                return sizeof(T) == 1 ? "c" : sizeof(T) == 2 ? "s" : sizeof(T) == 4 ? "i" : "l";
+            } else {
+                return sizeof(T) == 1 ? "C" : sizeof(T) == 2 ? "S" : sizeof(T) == 4 ? "I" : "L";
+            }
+        }();
+    };
+
+    template <enum_c T>
+    struct arrow_primitive<T> : arrow_primitive<std::underlying_type_t<T>> {
+        static constexpr std::underlying_type_t<T> get(T v) { return static_cast<std::underlying_type_t<T>>(v); }
+    };
+
+    template <std::size_t N>
+    struct arrow_primitive<sint_zigzag<N>> : arrow_primitive<sint<N>> {
+        static constexpr sint<N> get(sint_zigzag<N> v) { return v.get(); }
+    };
+
+    /// @brief Values of an Arrow column (without the validity bitmap) decoded by the @ref coder `C`
+    ///
+    /// - integers, enumerations and floating points are stored in a fixed-width buffer (ref to @ref arrow_primitive),
+    /// - booleans are stored in a bitmap,
+    /// - strings and bytes are stored in a buffer of `int64` offsets and a data buffer (`large_utf8` and `large_binary` in Arrow).
+    /// It is not defined for other coders, i.e. embedded messages.
+    template <coder C>
+    struct arrow_values {};
+
+    template <coder C> requires requires { typename arrow_primitive<typename C::value_type>::type; }
+    struct arrow_values<C> {
+        using primitive = arrow_primitive<typename C::value_type>;
+
+        static constexpr const char* format = primitive::format;
+
+        std::vector<typename primitive::type> values;
+
+        std::size_t size() const noexcept { return values.size(); }
+
+        void append(typename C::value_type v) { values.push_back(primitive::get(v)); }
+        void replace_back(typename C::value_type v) { values.back() = primitive::get(v); }
+        void append_default() { values.emplace_back(); }
+
+        void truncate(std::size_t n) { values.resize(n); }
+        void reserve(std::size_t n) { values.reserve(n); }
+        void clear() noexcept { values.clear(); }
+
+        std::vector<const void*> buffers() const { return {values.data()}; }
+    };
+
+    template <coder C> requires std::same_as<typename C::value_type, bool>
+    struct arrow_values<C> {
+        static constexpr const char* format = "b";
+
+        arrow_bitmap values;
+
+        std::size_t size() const noexcept { return values.size(); }
+
+        void append(bool v) { values.push_back(v); }
+        void replace_back(bool v) { values.set(values.size() - 1, v); }
+        void append_default() { values.push_back(false); }
+
+        void truncate(std::size_t n) { values.truncate(n); }
+        void reserve(std::size_t n) { values.reserve(n); }
+        void clear() noexcept { values.clear(); }
+
+        std::vector<const void*> buffers() const { return {values.data()}; }
+    };
+
+    template <typename T, typename R> requires (sizeof(T) == 1)
+    struct arrow_values<array_coder<integer_coder<T>, R>> {
+        static constexpr const char* format = std::same_as<T, char> || std::same_as<T, char8_t> ? "U" : "Z";
+
+        std::vector<int64_t> offsets{0};
+        std::vector<uint<1>> data;
+
+        std::size_t size() const noexcept { return offsets.size() - 1; }
+
+        template <std::ranges::contiguous_range V>
+        void append(const V& v) {
+            const auto* p = reinterpret_cast<const uint<1>*>(std::ranges::data(v));
+            data.insert(data.end(), p, p + std::ranges::size(v));
+            offsets.push_back(static_cast<int64_t>(data.size()));
+        }
+
+        template <std::ranges::contiguous_range V>
+        void replace_back(const V& v) {
+            offsets.pop_back();
+            data.resize(offsets.back());
+            append(v);
+        }
+
+        void append_default() { offsets.push_back(offsets.back()); }
+
+        void truncate(std::size_t n) {
+            offsets.resize(n + 1);
+            data.resize(offsets.back());
+        }
+
+        void reserve(std::size_t n) { offsets.reserve(n + 1); }
+
+        void clear() noexcept {
+            offsets.resize(1);
+            data.clear();
+        }
+
+        std::vector<const void*> buffers() const { return {offsets.data(), data.data()}; }
+    };
+
+    template <typename R>
+    struct arrow_values<utf8_string_coder<R>> : arrow_values<array_coder<integer_coder<char>, R>> {};
+
+    /// Checks whether values of the @ref coder `C` can be stored in an Arrow column, ref to @ref arrow_values
+    template <typename C>
+    concept arrow_value_coder = coder<C> && requires { arrow_values<C>::format; };
+
+    /// The private data of exported Arrow arrays, which shares the ownership of the exported buffers
+    struct arrow_array_private {
+        std::shared_ptr<const void> owner;
+        std::vector<const void*> buffers;
+        std::vector<ArrowArray> children;
+        std::vector<ArrowArray*> child_pointers;
+    };
+
+    /// The private data of exported Arrow schemas
+    struct arrow_schema_private {
+        std::vector<ArrowSchema> children;
+        std::vector<ArrowSchema*> child_pointers;
+    };
+
+    inline void release_arrow_array(ArrowArray* array) {
+        auto* p = static_cast<arrow_array_private*>(array->private_data);
+        for (auto* child : p->child_pointers) {
+            // children moved out by the consumer are marked released
+            if (child->release) {
+                child->release(child);
+            }
+        }
+
+        delete p;
+        array->release = nullptr;
+    }
+
+    inline void release_arrow_schema(ArrowSchema* schema) {
+        auto* p = static_cast<arrow_schema_private*>(schema->private_data);
+        for (auto* child : p->child_pointers) {
+            if (child->release) {
+                child->release(child);
+            }
+        }
+
+        delete p;
+        schema->release = nullptr;
+    }
+
+    /// Fill `out` with an Arrow array with `n_children` children, where the children are left to be filled by the caller
+    inline arrow_array_private& make_arrow_array(ArrowArray* out, std::shared_ptr<const void> owner, std::size_t length,
+        std::size_t null_count, std::vector<const void*> buffers, std::size_t n_children = 0) {
+        auto* p = new arrow_array_private{std::move(owner), std::move(buffers), std::vector<ArrowArray>(n_children), {}};
+        for (auto& child : p->children) {
+            p->child_pointers.push_back(&child);
+        }
+
+        *out = ArrowArray{
+            static_cast<int64_t>(length), static_cast<int64_t>(null_count), 0,
+            static_cast<int64_t>(p->buffers.size()), static_cast<int64_t>(n_children),
+            p->buffers.data(), p->child_pointers.data(), nullptr, release_arrow_array, p
+        };
+        return *p;
+    }
+
+    /// Fill `out` with an Arrow schema with `n_children` children, where `format` and `name` should have static storage duration
+    inline arrow_schema_private& make_arrow_schema(ArrowSchema* out, const char* format, const char* name, int64_t flags, std::size_t n_children = 0) {
+        auto* p = new arrow_schema_private{std::vector<ArrowSchema>(n_children), {}};
+        for (auto& child : p->children) {
+            p->child_pointers.push_back(&child);
+        }
+
+        *out = ArrowSchema{
+            format, name, nullptr, flags, static_cast<int64_t>(n_children),
+            p->child_pointers.data(), nullptr, release_arrow_schema, p
+        };
+        return *p;
+    }
+
+    /// @brief The Arrow column of the field `F` in a @ref columnar_batch
+    ///
+    /// It is empty for fields whose values cannot be stored in Arrow columns (ref to @ref arrow_value_coder),
+    /// and values of these fields are skipped in decoding.
+    template <field_c F>
+    struct arrow_column {
+        static constexpr bool exported = false;
+
+        void finish_row() {}
+        void truncate(std::size_t) {}
+        void reserve(std::size_t) {}
+        void clear() noexcept {}
+    };
+
+    /// @brief The column of a @ref singular or @ref implicit field, where every row has a value
+    ///
+    /// Rows without a @ref singular field are null, and rows without an @ref implicit field have the default value.
+    /// If a field appears many times in a row, the last value wins (as @ref message_coder does).
+    template <field_c F> requires (is_singular(F::attr) && F::attr != oneof && arrow_value_coder<typename F::coder>)
+    struct arrow_column<F> {
+        static constexpr bool exported = true;
+
+        arrow_values<typename F::coder> values;
+        arrow_bitmap validity;
+
+        std::size_t size() const noexcept { return validity.size(); }
+
+        std::size_t null_count() const noexcept { return validity.size() - validity.count(); }
+
+        bool is_null(std::size_t i) const { return !validity[i]; }
+
+        template <coder_mode Mode>
+        decode_to_result<Mode> decode(bytes b) {
+            using decoder = view_decoder<typename F::coder>;
+
+            decode_value<typename decoder::value_type> decode_v;
+            if (!Mode::get_value_from_result(decoder::template decode<Mode>(b), decode_v)) {
+                return {};
+            }
+
+            if (values.size() > size()) {
+                values.replace_back(decode_v.first);
+            } else {
+                values.append(decode_v.first);
+            }
+            return Mode::template make_result<decode_to_result<Mode>>(decode_v.second);
+        }
+
+        void finish_row() {
+            if (values.size() > size()) {
+                validity.push_back(true);
+            } else {
+                values.append_default();
+                validity.push_back(F::attr == implicit);
+            }
+        }
+
+        void truncate(std::size_t n) {
+            values.truncate(n);
+            validity.truncate(n);
+        }
+
+        void reserve(std::size_t n) {
+            values.reserve(n);
+            validity.reserve(n);
+        }
+
+        void clear() noexcept {
+            values.clear();
+            validity.clear();
+        }
+
+        void export_to(ArrowArray* array, ArrowSchema* schema, const std::shared_ptr<const void>& owner) const {
+            const auto nulls = null_count();
+
+            auto buffers = values.buffers();
+            buffers.insert(buffers.begin(), nulls > 0 ? validity.data() : nullptr);
+            make_arrow_array(array, owner, size(), nulls, std::move(buffers));
+            make_arrow_schema(schema, values.format, F::name.data, F::attr == singular ? ARROW_FLAG_NULLABLE : 0);
+        }
+    };
+
+    /// The column of a @ref repeated (or @ref packed) field, which is a list column with `int64` offsets (`large_list` in Arrow)
+    template <field_c F> requires (!is_singular(F::attr) && arrow_value_coder<typename F::coder>)
+    struct arrow_column<F> {
+        static constexpr bool exported = true;
+
+        std::vector<int64_t> offsets{0};
+        arrow_values<typename F::coder> values;
+
+        std::size_t size() const noexcept { return offsets.size() - 1; }
+
+        template <coder_mode Mode>
+        decode_to_result<Mode> decode(bytes b) {
+            using decoder = view_decoder<typename F::coder>;
+
+            decode_value<typename decoder::value_type> decode_v;
+            if (!Mode::get_value_from_result(decoder::template decode<Mode>(b), decode_v)) {
+                return {};
+            }
+
+            values.append(decode_v.first);
+            return Mode::template make_result<decode_to_result<Mode>>(decode_v.second);
+        }
+
+        /// decode packed values (with the length prefix), ref to @ref packed
+        template <coder_mode Mode>
+        decode_to_result<Mode> decode_packed(bytes b) {
+            decode_value<uint<8>> decode_len;
+            if (!Mode::get_value_from_result(varint_coder<uint<8>>::decode<Mode>(b), decode_len)) {
+                return {};
+            }
+
+            const auto& [len, rest] = decode_len;
+            if (!check_length<Mode>(rest, len)) {
+                return {};
+            }
+
+            bytes elements = rest.subspan(0, len);
+            while(elements.end() > elements.begin()) {
+                if (!Mode::get_value_from_result(decode<Mode>(elements), elements)) {
+                    return {};
+                }
+            }
+
+            return Mode::template make_result<decode_to_result<Mode>>(rest.subspan(len));
+        }
+
+        void finish_row() {
+            offsets.push_back(static_cast<int64_t>(values.size()));
+        }
+
+        void truncate(std::size_t n) {
+            offsets.resize(n + 1);
+            values.truncate(offsets.back());
+        }
+
+        void reserve(std::size_t n) {
+            offsets.reserve(n + 1);
+        }
+
+        void clear() noexcept {
+            offsets.resize(1);
+            values.clear();
+        }
+
+        void export_to(ArrowArray* array, ArrowSchema* schema, const std::shared_ptr<const void>& owner) const {
+            auto& p = make_arrow_array(array, owner, size(), 0, {nullptr, offsets.data()}, 1);
+            auto buffers = values.buffers();
+            buffers.insert(buffers.begin(), nullptr);
+            make_arrow_array(&p.children[0], owner, values.size(), 0, std::move(buffers));
+
+            auto& s = make_arrow_schema(schema, "+L", F::name.data, 0, 1);
+            make_arrow_schema(&s.children[0], values.format, "item", 0);
+        }
+    };
+
+    template <coder_mode, typename>
+    struct columnar_decode_map;
+
+    template <typename>
+    class columnar_batch;
+
+    /// @brief A batch of messages decoded into Arrow columns, without materializing messages
+    ///
+    /// Every field has a column (ref to @ref arrow_column), where column types are derived from the coders of fields
+    /// (ref to @ref arrow_values), except that fields of other types (i.e. embedded messages) are skipped.
+    /// The batch can be exported as an Arrow struct array via the Arrow C data interface, ref to `export_to`.
+    template <field_c... F>
+    class columnar_batch<message<F...>> {
+        template <std::size_t I>
+        using field_at = std::tuple_element_t<I, std::tuple<F...>>;
+
+    public:
+        using value_type = message<F...>;
+
+        /// the number of rows (i.e. messages)
+        std::size_t size() const noexcept { return rows; }
+        bool empty() const noexcept { return rows == 0; }
+
+        /// get the column of a field by the field number
+        template <uint<4> N>
+        const auto& column() const {
+            return std::get<field_number_index<N, F...>>(columns);
+        }
+
+        /// get the column of a field by the field name
+        template <basic_fixed_string S>
+        const auto& column() const {
+            return std::get<field_name_index<S, F...>>(columns);
+        }
+
+        void reserve(std::size_t n) {
+            std::apply([n](auto&... c) { (c.reserve(n), ...); }, columns);
+        }
+
+        void clear() noexcept {
+            std::apply([](auto&... c) { (c.clear(), ...); }, columns);
+            rows = 0;
+        }
+
+        /// @brief Decode a message (without the length prefix) from `b` into a new row
+        /// @returns the bytes which remains not decoded (as @ref message_coder does), and the batch is unchanged on failure
+        template <coder_mode Mode = safe_mode>
+        decode_to_result<Mode> append(bytes b) {
+            while(b.end() > b.begin()) {
+                std::pair<bytes, bool> bytes_with_next;
+                if (!Mode::get_value_from_result(decode_map<Mode>().decode(*this, b), bytes_with_next)) {
+                    truncate(rows);
+                    return {};
+                }
+
+                bool next = true;
+                std::tie(b, next) = bytes_with_next;
+
+                if(!next) break;
+            }
+
+            std::apply([](auto&... c) { (c.finish_row(), ...); }, columns);
+            ++rows;
+            return Mode::template make_result<decode_to_result<Mode>>(b);
+        }
+
+        /// @brief Decode a stream of length-delimited messages from `b` into new rows
+        /// @returns the bytes which remains not decoded, and the batch is unchanged on failure
+        template <coder_mode Mode = safe_mode>
+        decode_to_result<Mode> append_delimited(bytes b) {
+            const auto origin_rows = rows;
+            while(b.end() > b.begin()) {
+                decode_value<uint<8>> decode_len;
+                bytes rest;
+                if (!Mode::get_value_from_result(varint_coder<uint<8>>::decode<Mode>(b), decode_len) ||
+                    !check_length<Mode>(decode_len.second, decode_len.first) ||
+                    !Mode::get_value_from_result(append<Mode>(decode_len.second.subspan(0, decode_len.first)), rest)) {
+                    truncate(origin_rows);
+                    return {};
+                }
+
+                b = decode_len.second.subspan(decode_len.first);
+            }
+
+            return Mode::template make_result<decode_to_result<Mode>>(b);
+        }
+
+        /// @brief Export the batch as an Arrow struct array with a child for every column, and its schema
+        ///
+        /// Buffers of columns are moved into the exported array without copying,
+        /// and they are released after the array and all its children are released.
+        void export_to(ArrowArray* array, ArrowSchema* schema) && {
+            const auto owner = std::make_shared<const columnar_batch>(std::move(*this));
+            clear();
+
+            constexpr std::size_t n = (std::size_t(arrow_column<F>::exported) + ... + 0);
+            auto& a = make_arrow_array(array, owner, owner->rows, 0, {nullptr}, n);
+            auto& s = make_arrow_schema(schema, "+s", "", 0, n);
+
+            [&]<std::size_t... I>(std::index_sequence<I...>) {
+                std::size_t k = 0;
+                ([&] {
+                    if constexpr (arrow_column<field_at<I>>::exported) {
+                        std::get<I>(owner->columns).export_to(&a.children[k], &s.children[k], owner);
+                        ++k;
+                    }
+                }(), ...);
+            }(std::index_sequence_for<F...>{});
+        }
+
+    private:
+        template <coder_mode, typename> friend struct columnar_decode_map;
+
+        template <coder_mode Mode>
+        static const columnar_decode_map<Mode, columnar_batch>& decode_map() {
+            static const columnar_decode_map<Mode, columnar_batch> map;
+            return map;
+        }
+
+        void truncate(std::size_t n) {
+            std::apply([n](auto&... c) { (c.truncate(n), ...); }, columns);
+            rows = n;
+        }
+
+        std::tuple<arrow_column<F>...> columns;
+        std::size_t rows = 0;
+    };
+
+    /// A decode map which decodes field values into the current row of a @ref columnar_batch, ref to @ref message_decode_map
+    template <coder_mode Mode, field_c... F>
+    struct columnar_decode_map<Mode, columnar_batch<message<F...>>> : message_decode_map_base<Mode, columnar_batch<message<F...>>> {
+    private:
+        using T = columnar_batch<message<F...>>;
+
+        template <std::size_t I, field_c G>
+        void insert_field_at() {
+            if constexpr (arrow_column<G>::exported) {
+                this->emplace(G::element_key, [](T& v, bytes b) {
+                    return std::get<I>(v.columns).template decode<Mode>(b);
+                });
+
+                if constexpr (G::packable) {
+                    this->emplace(G::packed_key, [](T& v, bytes b) {
+                        return std::get<I>(v.columns).template decode_packed<Mode>(b);
+                    });
+                }
+            }
+        }
+
+        template <std::size_t... I>
+        explicit columnar_decode_map(std::index_sequence<I...>) {
+            (insert_field_at<I, F>(), ...);
+        }
+
+    public:
+        columnar_decode_map() : columnar_decode_map(std::index_sequence_for<F...>{}) {}
+    };
+
+}
+
+#endif //PROTOPUF_COLUMNAR_H
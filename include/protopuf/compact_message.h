@@ -0,0 +1,694 @@
+//   Copyright 2020-2021 PragmaTwice
+//
+//   Licensed under the Apache License, Version 2.0 (the "License");
+//   you may not use this file except in compliance with the License.
+//   You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the License is distributed on an "AS IS" BASIS,
+//   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//   See the License for the specific language governing permissions and
+//   limitations under the License.
+
+#ifndef PROTOPUF_COMPACT_MESSAGE_H
+#define PROTOPUF_COMPACT_MESSAGE_H
+
+#include "message.h"
+
+#include <array>
+#include <bit>
+#include <climits>
+#include <optional>
+#include <tuple>
+
+namespace pp {
+
+    template <typename... T>
+    struct compact_storage {};
+
+    /// @brief Values of types `T...` laid out one after another, used as the storage of @ref compact_message
+    ///
+    /// No padding is inserted between the values while they are ordered by decreasing alignment.
+    template <typename T, typename... Ts>
+    struct compact_storage<T, Ts...> {
+        T head = make_value<T>();
+        [[no_unique_address]] compact_storage<Ts...> tail;
+    };
+
+    /// Get the `I`-th value of a @ref compact_storage
+    template <std::size_t I, typename S>
+    constexpr auto& compact_storage_get(S& s) {
+        if constexpr (I == 0) {
+            return s.head;
+        } else {
+            return compact_storage_get<I - 1>(s.tail);
+        }
+    }
+
+    /// The smallest unsigned integer type holding `N` has-bits, or `uint<8>` if `N` is larger than 64
+    template <std::size_t N>
+    using has_bits_word = std::conditional_t<N <= 8, uint<1>,
+        std::conditional_t<N <= 16, uint<2>, std::conditional_t<N <= 32, uint<4>, uint<8>>>>;
+
+    /// The type storing the field `F` in a @ref compact_message, i.e. the unwrapped value for a @ref singular field, or the field itself
+    template <field_c F>
+    struct compact_stored_type {
+        using type = F;
+    };
+
+    template <field_c F> requires (F::attr == singular)
+    struct compact_stored_type<F> {
+        using type = typename F::coder::value_type;
+    };
+
+    /// @brief The storage layout of a @ref compact_message with fields `T...`
+    ///
+    /// Every @ref singular field is stored as its unwrapped value with a has-bit, and other fields are stored as they are.
+    /// The stored values and the has-bits are sorted by decreasing alignment (stably) to eliminate padding between them.
+    template <field_c... T>
+    struct compact_layout {
+        /// the number of has-bits, i.e. the number of @ref singular fields
+        static constexpr std::size_t has_bits_size = ((T::attr == singular) + ... + 0);
+
+        using word_type = has_bits_word<has_bits_size>;
+
+        static constexpr std::size_t word_bits = sizeof(word_type) * CHAR_BIT;
+
+        using has_bits_type = std::array<word_type, (has_bits_size + word_bits - 1) / word_bits>;
+
+        template <field_c F>
+        using stored_type = typename compact_stored_type<F>::type;
+
+        /// stored types of all fields, followed by the has-bits
+        using stored_types = std::tuple<stored_type<T>..., has_bits_type>;
+
+        static constexpr std::size_t stored_size = sizeof...(T) + 1;
+
+        /// the index of the stored type at every position of the storage
+        static constexpr std::array<std::size_t, stored_size> order = [] {
+            constexpr std::array<std::size_t, stored_size> aligns{alignof(stored_type<T>)..., alignof(has_bits_type)};
+
+            std::array<std::size_t, stored_size> res{};
+            for (std::size_t i = 0; i < stored_size; ++i) {
+                std::size_t j = i;
+                for (; j > 0 && aligns[res[j - 1]] < aligns[i]; --j) {
+                    res[j] = res[j - 1];
+                }
+                res[j] = i;
+            }
+            return res;
+        }();
+
+        /// the position in the storage of every stored type, i.e. the inverse of @ref order
+        static constexpr std::array<std::size_t, stored_size> position = [] {
+            std::array<std::size_t, stored_size> res{};
+            for (std::size_t i = 0; i < stored_size; ++i) {
+                res[order[i]] = i;
+            }
+            return res;
+        }();
+
+        /// the has-bit index of every field, which is meaningful only for @ref singular fields
+        static constexpr std::array<std::size_t, sizeof...(T)> has_bit_index = [] {
+            constexpr std::array<bool, sizeof...(T)> has_bit{(T::attr == singular)...};
+
+            std::array<std::size_t, sizeof...(T)> res{};
+            for (std::size_t i = 0, n = 0; i < sizeof...(T); ++i) {
+                res[i] = has_bit[i] ? n++ : n;
+            }
+            return res;
+        }();
+
+        /// the field index of every has-bit
+        static constexpr std::array<std::size_t, has_bits_size> singular_fields = [] {
+            constexpr std::array<bool, sizeof...(T)> has_bit{(T::attr == singular)...};
+
+            std::array<std::size_t, has_bits_size> res{};
+            for (std::size_t i = 0; i < sizeof...(T); ++i) {
+                if (has_bit[i]) {
+                    res[has_bit_index[i]] = i;
+                }
+            }
+            return res;
+        }();
+
+        using storage_type = typename decltype([]<std::size_t... I>(std::index_sequence<I...>) {
+            return std::type_identity<compact_storage<std::tuple_element_t<order[I], stored_types>...>>{};
+        }(std::make_index_sequence<stored_size>{}))::type;
+    };
+
+    template <typename T, typename W>
+    class compact_field_ref;
+
+    template <typename>
+    constexpr inline bool is_compact_field_ref = false;
+
+    template <typename T, typename W>
+    constexpr inline bool is_compact_field_ref<compact_field_ref<T, W>> = true;
+
+    /// @brief A reference to a @ref singular field of a @ref compact_message, with an interface of `std::optional<T>`
+    ///
+    /// It refers to the unwrapped value and the has-bits word `W` holding its has-bit, which are const in a const message.
+    /// The value is kept in place after `reset()`, so that its resources (i.e. allocated capacity) can be reused in decoding.
+    template <typename T, typename W>
+    class compact_field_ref {
+    public:
+        using value_type = std::remove_const_t<T>;
+
+        constexpr compact_field_ref(T& v, W& word, std::remove_const_t<W> mask) : v(&v), word(&word), mask(mask) {}
+
+        constexpr compact_field_ref(const compact_field_ref&) = default;
+
+        /// assign the value (or the absence) of another field, i.e. `msg1.get<1>() = msg2.get<1>()`
+        constexpr compact_field_ref& operator=(const compact_field_ref& other) requires (!std::is_const_v<T>) {
+            return assign_from(other);
+        }
+
+        template <typename U, typename X>
+        constexpr compact_field_ref& operator=(const compact_field_ref<U, X>& other) requires (!std::is_const_v<T>) {
+            return assign_from(other);
+        }
+
+        template <typename U> requires (!std::is_const_v<T>)
+        constexpr compact_field_ref& operator=(const std::optional<U>& other) {
+            return assign_from(other);
+        }
+
+        template <typename U = value_type> requires (!std::is_const_v<T>) && std::assignable_from<value_type&, U&&> &&
+            (!std::same_as<std::remove_cvref_t<U>, std::nullopt_t>) && (!is_compact_field_ref<std::remove_cvref_t<U>>)
+        constexpr compact_field_ref& operator=(U&& u) {
+            *v = std::forward<U>(u);
+            *word |= mask;
+            return *this;
+        }
+
+        constexpr compact_field_ref& operator=(std::nullopt_t) requires (!std::is_const_v<T>) {
+            reset();
+            return *this;
+        }
+
+        constexpr bool has_value() const {
+            return (*word & mask) != 0;
+        }
+
+        constexpr explicit operator bool() const {
+            return has_value();
+        }
+
+        constexpr T& value() const {
+            if (!has_value()) {
+                throw std::bad_optional_access();
+            }
+            return *v;
+        }
+
+        constexpr T& operator*() const { return *v; }
+
+        constexpr T* operator->() const { return v; }
+
+        template <typename U>
+        constexpr value_type value_or(U&& u) const {
+            return has_value() ? *v : static_cast<value_type>(std::forward<U>(u));
+        }
+
+        template <typename... Args> requires (!std::is_const_v<T>)
+        constexpr T& emplace(Args&&... args) {
+            if constexpr (sizeof...(Args) == 0) {
+                *v = make_value<T>();
+            } else {
+                *v = T(std::forward<Args>(args)...);
+            }
+            *word |= mask;
+            return *v;
+        }
+
+        /// clear the has-bit, where the value is kept in place
+        constexpr void reset() requires (!std::is_const_v<T>) {
+            *word &= ~mask;
+        }
+
+        constexpr operator std::optional<value_type>() const {
+            return has_value() ? std::optional<value_type>(*v) : std::nullopt;
+        }
+
+        friend constexpr bool operator==(const compact_field_ref& l, std::nullopt_t) {
+            return !l.has_value();
+        }
+
+        template <typename U, typename X>
+        friend constexpr bool operator==(const compact_field_ref& l, const compact_field_ref<U, X>& r) {
+            return l.has_value() == r.has_value() && (!l.has_value() || *l == *r);
+        }
+
+        template <typename U> requires (!is_compact_field_ref<U>) && (!std::same_as<U, std::nullopt_t>) &&
+            std::convertible_to<const U&, value_type>
+        friend constexpr bool operator==(const compact_field_ref& l, const U& r) {
+            return l.has_value() && *l == static_cast<value_type>(r);
+        }
+
+    private:
+        template <typename O>
+        constexpr compact_field_ref& assign_from(const O& other) {
+            if (other.has_value()) {
+                *v = *other;
+                *word |= mask;
+            } else {
+                reset();
+            }
+            return *this;
+        }
+
+        T* v;
+        W* word;
+        std::remove_const_t<W> mask;
+    };
+
+    /// @brief A message type with a compact storage, as an alternative to @ref message
+    ///
+    /// Presence of all @ref singular fields is recorded in a single has-bits word (or words if there are more than 64 of them),
+    /// and their values are stored unwrapped (i.e. `T` instead of `std::optional<T>`), while other fields are stored as they are
+    /// in @ref message. All values are laid out in order of decreasing alignment, ref to @ref compact_layout.
+    ///
+    /// Fields are accessed by `get<N>()` and `get<"name">()` as in @ref message, where singular fields are returned as @ref compact_field_ref.
+    /// While encoding, present singular fields are visited by iterating the set has-bits, instead of checking every field;
+    /// then other fields follow in order of declaration.
+    template <field_c... T> requires are_same<typename T::name_type::value_type...>
+    class compact_message {
+        using layout = compact_layout<T...>;
+
+        template <std::size_t I>
+        using field_at = std::tuple_element_t<I, std::tuple<T...>>;
+
+        template <uint<4> N>
+        static constexpr std::size_t index_by_number = field_number_index<N, T...>;
+
+        template <basic_fixed_string S>
+        static constexpr std::size_t index_by_name = field_name_index<S, T...>;
+
+    public:
+        constexpr compact_message() = default;
+
+        constexpr explicit compact_message(T&& ...v) {
+            assign(std::index_sequence_for<T...>{}, std::move(v)...);
+        }
+
+        constexpr explicit compact_message(const T& ...v) {
+            assign(std::index_sequence_for<T...>{}, v...);
+        }
+
+        template <typename... U>
+            requires (sizeof...(T) == sizeof...(U) && !are_same<compact_message, std::remove_cvref_t<U>...>)
+        constexpr explicit compact_message(U&& ...v) {
+            assign(std::index_sequence_for<T...>{}, std::forward<U>(v)...);
+        }
+
+        /// the number of fields
+        static constexpr uint<4> size = sizeof...(T);
+
+        /// get the field type by the specific field number
+        template <uint<4> N>
+        using get_type_by_number = field_number_selector<N, T...>;
+
+        /// get the field type by the specific field name
+        template <basic_fixed_string S>
+        using get_type_by_name = field_name_selector<S, T...>;
+
+        /// get a field by the field number, where a @ref singular field is returned as @ref compact_field_ref
+        template <uint<4> N>
+        constexpr decltype(auto) get() const {
+            static_assert(index_by_number<N> < size, "field not found");
+            return get_by_index<index_by_number<N>>();
+        }
+
+        /// get a field by the field name, where a @ref singular field is returned as @ref compact_field_ref
+        template <basic_fixed_string S>
+        constexpr decltype(auto) get() const {
+            static_assert(index_by_name<S> < size, "field not found");
+            return get_by_index<index_by_name<S>>();
+        }
+
+        /// get a field by the field number, where a @ref singular field is returned as @ref compact_field_ref
+        template <uint<4> N>
+        constexpr decltype(auto) get() {
+            static_assert(index_by_number<N> < size, "field not found");
+            return get_by_index<index_by_number<N>>();
+        }
+
+        /// get a field by the field name, where a @ref singular field is returned as @ref compact_field_ref
+        template <basic_fixed_string S>
+        constexpr decltype(auto) get() {
+            static_assert(index_by_name<S> < size, "field not found");
+            return get_by_index<index_by_name<S>>();
+        }
+
+        /// get a field by the field number, i.e. `msg[233_i]`
+        template <uint<4> F>
+        constexpr decltype(auto) operator[](std::integral_constant<uint<4>, F>) const {
+            return get<F>();
+        }
+
+        /// get a field by the field name, i.e. `msg["a"_f]`
+        template <basic_fixed_string F>
+        constexpr decltype(auto) operator[](constant<F>) const {
+            return get<F>();
+        }
+
+        /// get a field by the field number, i.e. `msg[233_i]`
+        template <uint<4> F>
+        constexpr decltype(auto) operator[](std::integral_constant<uint<4>, F>) {
+            return get<F>();
+        }
+
+        /// get a field by the field name, i.e. `msg["a"_f]
+        template <basic_fixed_string F>
+        constexpr decltype(auto) operator[](constant<F>) {
+            return get<F>();
+        }
+
+        /// the number of present @ref singular fields
+        constexpr std::size_t present_count() const {
+            std::size_t n = 0;
+            for (auto w : has_bits()) {
+                n += std::popcount(w);
+            }
+            return n;
+        }
+
+        /// @brief Clear all fields
+        ///
+        /// Only has-bits of @ref singular fields are cleared, where their values are kept in place to be reused in decoding.
+        constexpr void clear() {
+            has_bits() = {};
+            [this]<std::size_t... I>(std::index_sequence<I...>) {
+                ([this] {
+                    if constexpr (T::attr == implicit || T::attr == oneof) {
+                        stored<I>().reset();
+                    } else if constexpr (T::attr != singular) {
+                        stored<I>().clear();
+                    }
+                }(), ...);
+            }(std::index_sequence_for<T...>{});
+        }
+
+        constexpr bool operator==(const compact_message& other) const {
+            return [this, &other]<std::size_t... I>(std::index_sequence<I...>) {
+                return ([this, &other] {
+                    if constexpr (T::attr == singular) {
+                        return get_by_index<I>() == other.get_by_index<I>();
+                    } else {
+                        return stored<I>().cast_to_base() == other.stored<I>().cast_to_base();
+                    }
+                }() && ...);
+            }(std::index_sequence_for<T...>{});
+        }
+
+        constexpr bool operator!=(const compact_message& other) const {
+            return !(*this == other);
+        }
+
+    private:
+        template <message_c> friend struct message_coder;
+        template <coder_mode, message_c> friend struct message_decode_map;
+        template <coder> friend struct skipper;
+
+        template <std::size_t I>
+        constexpr auto& stored() {
+            return compact_storage_get<layout::position[I]>(storage);
+        }
+
+        template <std::size_t I>
+        constexpr auto& stored() const {
+            return compact_storage_get<layout::position[I]>(storage);
+        }
+
+        constexpr auto& has_bits() {
+            return stored<sizeof...(T)>();
+        }
+
+        constexpr auto& has_bits() const {
+            return stored<sizeof...(T)>();
+        }
+
+        template <std::size_t I>
+        constexpr decltype(auto) get_by_index() {
+            if constexpr (field_at<I>::attr == singular) {
+                return make_field_ref<I>(stored<I>(), has_bits());
+            } else {
+                return stored<I>();
+            }
+        }
+
+        template <std::size_t I>
+        constexpr decltype(auto) get_by_index() const {
+            if constexpr (field_at<I>::attr == singular) {
+                return make_field_ref<I>(stored<I>(), has_bits());
+            } else {
+                return stored<I>();
+            }
+        }
+
+        template <std::size_t I, typename V, typename B>
+        static constexpr auto make_field_ref(V& v, B& bits) {
+            constexpr std::size_t bit = layout::has_bit_index[I];
+            using word_type = typename layout::word_type;
+
+            return compact_field_ref<V, std::remove_reference_t<decltype(bits[0])>>(
+                v, bits[bit / layout::word_bits], static_cast<word_type>(word_type(1) << (bit % layout::word_bits)));
+        }
+
+        /// set the has-bit of the @ref singular field at index `I`
+        template <std::size_t I>
+        constexpr void set_present() {
+            constexpr std::size_t bit = layout::has_bit_index[I];
+            has_bits()[bit / layout::word_bits] |= typename layout::word_type(1) << (bit % layout::word_bits);
+        }
+
+        /// @brief Invoke `fn` with `std::integral_constant<std::size_t, I>` for the index `I` of every present @ref singular field,
+        /// by iterating the set has-bits, until `fn` returns false
+        /// @returns false if the iteration is stopped by `fn`
+        template <typename Fn>
+        constexpr bool visit_present(Fn&& fn) const {
+            using visitor = bool(*)(Fn&);
+            constexpr auto visitors = []<std::size_t... J>(std::index_sequence<J...>) {
+                return std::array<visitor, sizeof...(J)>{[](Fn& f) {
+                    return f(std::integral_constant<std::size_t, layout::singular_fields[J]>{});
+                }...};
+            }(std::make_index_sequence<layout::has_bits_size>{});
+
+            const auto& bits = has_bits();
+            for (std::size_t i = 0; i < bits.size(); ++i) {
+                for (auto w = bits[i]; w != 0; w &= w - 1) {
+                    if (!visitors[i * layout::word_bits + std::countr_zero(w)](fn)) {
+                        return false;
+                    }
+                }
+            }
+
+            return true;
+        }
+
+        template <std::size_t... I, typename... U>
+        constexpr void assign(std::index_sequence<I...>, U&& ...v) {
+            ((get_by_index<I>() = std::forward<U>(v)), ...);
+        }
+
+        typename layout::storage_type storage;
+    };
+
+    template <field_c... T>
+    constexpr inline bool is_message<compact_message<T...>> = true;
+
+    /// A @ref coder for @ref compact_message type, ref to @ref message_coder
+    template <field_c... F>
+    struct message_coder<compact_message<F...>> {
+        using value_type = compact_message<F...>;
+
+        message_coder() = delete;
+
+    private:
+        using T = value_type;
+
+        using plain_coder = message_coder<message<F...>>;
+
+        template <std::size_t I>
+        using field_at = std::tuple_element_t<I, std::tuple<F...>>;
+
+        template <coder_mode Mode>
+        static constexpr decode_to_result<Mode> decode_fields(T& v, bytes b) {
+            while(b.end() > b.begin()) {
+                std::pair<bytes, bool> bytes_with_next;
+                if (!Mode::get_value_from_result(decode_map<Mode, T>.decode(v, b), bytes_with_next)) {
+                    return {};
+                }
+
+                bool next = true;
+                std::tie(b, next) = bytes_with_next;
+
+                if(!next) break;
+            }
+
+            return Mode::template make_result<decode_to_result<Mode>>(b);
+        }
+
+    public:
+        /// @brief Encode a compact message, where present singular fields are encoded by iterating the set has-bits
+        ///
+        /// Fields are observed as fields of the compact message, ref to @ref observed_mode.
+        template <coder_mode Mode = safe_mode>
+        static constexpr encode_result<Mode> encode(const T& msg, bytes b) {
+            clear_coder_error<Mode>();
+
+            const bool encoded = msg.visit_present([&msg, &b]<std::size_t I>(std::integral_constant<std::size_t, I>) {
+                using G = field_at<I>;
+                const bytes origin = b;
+                const field_observation<Mode, T> observation(coder_direction::encode);
+                if (!Mode::get_value_from_result(varint_coder<uint<4>>::encode<Mode>(G::key, b), b) ||
+                    !Mode::get_value_from_result(G::coder::template encode<Mode>(msg.template stored<I>(), b), b)) {
+                    return false;
+                }
+
+                observation.finish(G::key, begin_diff(b, origin));
+                return true;
+            });
+
+            if (!encoded) {
+                return {};
+            }
+
+            encode_result<Mode> result{b};
+            [&msg, &result]<std::size_t... I>(std::index_sequence<I...>) {
+                ([&msg, &result] {
+                    if constexpr (F::attr != singular) {
+                        bytes safe_b;
+                        if (Mode::get_value_from_result(result, safe_b)) {
+                            result = plain_coder::template encode_field<Mode, F, T>(msg.template stored<I>(), safe_b);
+                        }
+                    }
+                }(), ...);
+            }(std::index_sequence_for<F...>{});
+
+            return result;
+        }
+
+        template <coder_mode Mode = safe_mode>
+        static constexpr decode_result<T, Mode> decode(bytes b) {
+            clear_coder_error<Mode>();
+
+            T v;
+
+            if (!Mode::get_value_from_result(decode_fields<Mode>(v, b), b)) {
+                return {};
+            }
+
+            return Mode::template make_result<decode_result<T, Mode>>(std::move(v), b);
+        }
+
+        /// @brief Decode a compact message into the existing message `v`
+        ///
+        /// All fields of `v` are cleared before decoding, where values of singular fields are kept in place,
+        /// so that they are decoded into by `decode_to` and their resources (i.e. allocated capacity) are reused.
+        template <coder_mode Mode = safe_mode>
+        static constexpr decode_into_result<Mode> decode_into(T& v, bytes b) {
+            clear_coder_error<Mode>();
+
+            v.clear();
+            return decode_fields<Mode>(v, b);
+        }
+
+        /// Decode a compact message into the existing message `v` as an @ref in_place_decoder, ref to `decode_into`
+        template <coder_mode Mode = safe_mode>
+        static constexpr decode_to_result<Mode> decode_to(T& v, bytes b) {
+            return decode_into<Mode>(v, b);
+        }
+    };
+
+    template <coder_mode Mode, field_c... F>
+    struct message_decode_map<Mode, compact_message<F...>> : message_decode_map_base<Mode, compact_message<F...>> {
+    private:
+        using T = compact_message<F...>;
+        using function_result = message_decode_map_function_result<Mode>;
+
+        // Values of singular fields are decoded in place by `decode_to`, and then their has-bits are set
+        template <std::size_t I, field_c G>
+        static constexpr function_result decode_singular_field(T& m, bytes b) {
+            using C = typename G::coder;
+
+            if constexpr (in_place_decoder<C, Mode>) {
+                if (!Mode::get_value_from_result(C::template decode_to<Mode>(m.template stored<I>(), b), b)) {
+                    return {};
+                }
+            } else {
+                auto decode_v = make_decode_value<typename C::value_type>();
+                if (!Mode::get_value_from_result(C::template decode<Mode>(b), decode_v)) {
+                    return {};
+                }
+
+                m.template stored<I>() = std::move(decode_v.first);
+                b = decode_v.second;
+            }
+
+            m.template set_present<I>();
+            return function_result{b};
+        }
+
+        template <std::size_t I, field_c G>
+        void insert_field_at() {
+            if constexpr (G::attr == singular) {
+                this->emplace(G::element_key, [](T& m, bytes b) {
+                    return decode_singular_field<I, G>(m, b);
+                });
+            } else {
+                this->template insert_field<G>([](T& m) -> G& {
+                    return m.template stored<I>();
+                });
+            }
+        }
+
+        template <std::size_t... I>
+        explicit message_decode_map(std::index_sequence<I...>) {
+            (insert_field_at<I, F>(), ...);
+        }
+
+    public:
+        message_decode_map() : message_decode_map(std::index_sequence_for<F...>{}) {}
+    };
+
+    template <field_c... F>
+    struct skipper<message_coder<compact_message<F...>>> {
+        using coder = message_coder<compact_message<F...>>;
+        using value_type = compact_message<F...>;
+
+    private:
+        using plain_skipper = skipper<message_coder<message<F...>>>;
+
+    public:
+        static constexpr std::size_t encode_skip(const value_type& msg) {
+            std::size_t n = 0;
+            msg.visit_present([&msg, &n]<std::size_t I>(std::integral_constant<std::size_t, I>) {
+                using G = std::tuple_element_t<I, std::tuple<F...>>;
+                n += skipper<varint_coder<uint<4>>>::encode_skip(G::key);
+                n += skipper<typename G::coder>::encode_skip(msg.template stored<I>());
+                return true;
+            });
+
+            [&msg, &n]<std::size_t... I>(std::index_sequence<I...>) {
+                ([&msg, &n] {
+                    if constexpr (F::attr != singular) {
+                        n += plain_skipper::encode_skip_field(msg.template stored<I>());
+                    }
+                }(), ...);
+            }(std::index_sequence_for<F...>{});
+
+            return n;
+        }
+    };
+
+    template <field_c... F> requires (requires { field_max_encoded_size<F>::value; } && ...)
+    struct max_encoded_size_impl<message_coder<compact_message<F...>>> :
+        max_encoded_size_impl<message_coder<message<F...>>> {};
+
+}
+
+#endif //PROTOPUF_COMPACT_MESSAGE_H
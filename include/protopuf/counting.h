@@ -0,0 +1,120 @@
+//   Copyright 2020-2021 PragmaTwice
+//
+//   Licensed under the Apache License, Version 2.0 (the "License");
+//   you may not use this file except in compliance with the License.
+//   You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the License is distributed on an "AS IS" BASIS,
+//   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//   See the License for the specific language governing permissions and
+//   limitations under the License.
+
+#ifndef PROTOPUF_COUNTING_H
+#define PROTOPUF_COUNTING_H
+
+#include <algorithm>
+#include <array>
+#include <vector>
+
+#include "message.h"
+#include "observer.h"
+
+namespace pp {
+
+    /// Counters of coding in @ref counting_mode in a thread
+    struct coding_counts {
+        /// the number of bytes encoded by @ref encoded_size
+        std::size_t encoded_bytes = 0;
+
+        /// the number of bytes of decoded fields of outermost messages
+        std::size_t decoded_bytes = 0;
+
+        /// the number of decoded fields, including fields of embedded messages
+        std::size_t decoded_fields = 0;
+
+        /// the maximum nesting depth of decoded fields, where fields of outermost messages are at depth 1
+        std::size_t max_depth = 0;
+
+        /// @brief the number of decoded bytes per wire type, where the bytes of a field exclude those of its nested fields
+        ///
+        /// i.e. the key and length of an embedded message are counted in wire type 2, while its fields are counted by their own types,
+        /// so that the sum of them is `decoded_bytes`.
+        std::array<std::size_t, 8> wire_bytes{};
+
+        constexpr bool operator==(const coding_counts&) const = default;
+    };
+
+    /// The @ref coder_observer of @ref counting_mode, which tracks nesting of decoded fields into the counters of the current thread
+    struct coding_counter {
+        static void enter(coder_direction direction) {
+            if (direction == coder_direction::decode) {
+                nested_bytes.push_back(0);
+                counts.max_depth = std::max(counts.max_depth, nested_bytes.size());
+            }
+        }
+
+        static void leave(coder_direction direction) {
+            if (direction == coder_direction::decode) {
+                nested_bytes.pop_back();
+            }
+        }
+
+        template <typename T>
+        static void on_field(const field_event& e) {
+            if (e.direction != coder_direction::decode) {
+                return;
+            }
+
+            ++counts.decoded_fields;
+            counts.wire_bytes[e.wire_type] += e.size - nested_bytes.back();
+
+            if (nested_bytes.size() > 1) {
+                nested_bytes[nested_bytes.size() - 2] += e.size;
+            } else {
+                counts.decoded_bytes += e.size;
+            }
+        }
+
+        static inline thread_local coding_counts counts;
+
+    private:
+        // the bytes of nested fields of every field being decoded, from the outermost one
+        static inline thread_local std::vector<std::size_t> nested_bytes;
+    };
+
+    /// @brief Safe @ref coder_mode which counts bytes of coding in the current thread, ref to @ref coding_counts
+    ///
+    /// Decoding tracks the nesting depth of fields and the bytes per wire type. Encoding writes bytes as @ref safe_mode does,
+    /// while @ref encoded_size measures encoded sizes without writing any byte.
+    /// Since the counters are thread-local, decoding by an @ref executor in this mode runs in the calling thread only.
+    struct counting_mode : observed_mode<coding_counter, safe_mode> {
+        /// the counters of the current thread
+        static coding_counts& counts() {
+            return coding_counter::counts;
+        }
+
+        /// reset the counters of the current thread to zero
+        static void reset() {
+            coding_counter::counts = {};
+        }
+    };
+
+    /// @brief Get the number of bytes which the value `v` is encoded into by the @ref coder `C`,
+    /// and add it to `encoded_bytes` of @ref counting_mode
+    ///
+    /// The size is computed by the @ref skipper of `C` without writing any byte,
+    /// so a user-defined coder needs a @ref skipper specialization (with `encode_skip`) to be measured,
+    /// since coders write into their bytes directly and cannot encode into a sink which only counts.
+    template <coder C> requires encode_skipper<skipper<C>>
+    std::size_t encoded_size(const typename C::value_type& v) {
+        const std::size_t size = skipper<C>::encode_skip(v);
+        counting_mode::counts().encoded_bytes += size;
+        return size;
+    }
+
+}
+
+#endif //PROTOPUF_COUNTING_H
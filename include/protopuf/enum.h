@@ -46,6 +46,14 @@ namespace pp {
 
             return {};
         }
+
+        template<coder_mode Mode>
+        static constexpr decode_to_result<Mode> decode_to(T& out, bytes b) {
+            std::underlying_type_t<T> u{};
+            auto result = varint_coder<std::underlying_type_t<T>>::template decode_to<Mode>(u, b);
+            out = static_cast<T>(u);
+            return result;
+        }
     };
 
 }
@@ -0,0 +1,46 @@
+//   Copyright 2020-2021 PragmaTwice
+//
+//   Licensed under the Apache License, Version 2.0 (the "License");
+//   you may not use this file except in compliance with the License.
+//   You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the License is distributed on an "AS IS" BASIS,
+//   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//   See the License for the specific language governing permissions and
+//   limitations under the License.
+
+#ifndef PROTOPUF_EXECUTOR_H
+#define PROTOPUF_EXECUTOR_H
+
+#include <cstddef>
+#include <utility>
+
+namespace pp {
+
+    /// @brief Describes a type with member function `parallel_for`, which runs a loop body over index chunks (maybe concurrently).
+    ///
+    /// Member function `parallel_for`:
+    /// @param n the number of indices, i.e. the loop is over `[0, n)`
+    /// @param f the loop body, invoked as `f(begin, end)` for disjoint chunks `[begin, end)` which cover `[0, n)`
+    /// It returns after all chunks are finished.
+    template <typename E>
+    concept executor = requires(E& e, std::size_t n, void (*f)(std::size_t, std::size_t)) {
+        e.parallel_for(n, f);
+    };
+
+    /// An @ref executor which runs the whole loop in the calling thread
+    struct sequential_executor {
+        template <typename F>
+        constexpr void parallel_for(std::size_t n, F&& f) const {
+            if (n > 0) {
+                std::forward<F>(f)(0, n);
+            }
+        }
+    };
+
+}
+
+#endif //PROTOPUF_EXECUTOR_H
@@ -22,7 +22,13 @@
 #include "varint.h"
 #include "bool.h"
 #include "fixed_string.h"
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <concepts>
 #include <optional>
+#include <tuple>
+#include <variant>
 
 namespace pp {
 
@@ -41,6 +47,9 @@ namespace pp {
     template <typename T, typename C>
     struct wire_type_impl<array_coder<T, C>> : std::integral_constant<uint<1>, 2> {};
 
+    template <typename R>
+    struct wire_type_impl<utf8_string_coder<R>> : std::integral_constant<uint<1>, 2> {};
+
     template <integral32 T>
     struct wire_type_impl<integer_coder<T>> : std::integral_constant<uint<1>, 5> {};
 
@@ -66,7 +75,116 @@ namespace pp {
         /// Represents a singular field, which can appear zero times or once in a message
         singular,
         /// Represents a repeated field, which can appear zero times, once or many times in a message
-        repeated
+        repeated,
+        /// @brief Represents a repeated field of scalars (i.e. integers, floating points, booleans and enumerations),
+        /// whose elements are encoded together into a single length-delimited value, as proto3 does by default
+        ///
+        /// Both packed and unpacked encodings are accepted while decoding @ref packed and @ref repeated scalar fields.
+        packed,
+        /// @brief Represents a singular field without explicit presence (i.e. proto3 fields without `optional`),
+        /// which is stored as a plain value in @ref implicit_value, and is not encoded while it equals the default value
+        implicit,
+        /// Represents a group of singular fields where at most one of them is set at the same time, ref to @ref oneof_field
+        oneof,
+        /// Represents raw bytes of fields which are not declared in the message, ref to @ref unknown_fields_field
+        unknown
+    };
+
+    /// Checks whether a field with the attribute `a` holds at most one value, i.e. @ref singular, @ref implicit or @ref oneof
+    constexpr bool is_singular(attribute a) {
+        return a == singular || a == implicit || a == oneof;
+    }
+
+    /// @brief A plain value of type `T` with an interface of `std::optional<T>`, used as the container of @ref implicit fields
+    ///
+    /// The value is always present, while `has_value()` is false if it equals the default value of `T`
+    /// (i.e. zero or an empty string), so that the default value is never encoded.
+    template <typename T>
+    class implicit_value {
+    public:
+        using value_type = T;
+
+        constexpr implicit_value() = default;
+
+        constexpr implicit_value(std::nullopt_t) {}
+
+        template <typename U = T> requires std::constructible_from<T, U&&> && (!std::same_as<std::remove_cvref_t<U>, implicit_value>) &&
+            (!std::same_as<std::remove_cvref_t<U>, std::nullopt_t>)
+        constexpr implicit_value(U&& u) : v(std::forward<U>(u)) {}
+
+        template <typename U = T> requires std::assignable_from<T&, U&&> && (!std::derived_from<std::remove_cvref_t<U>, implicit_value>)
+        constexpr implicit_value& operator=(U&& u) {
+            v = std::forward<U>(u);
+            return *this;
+        }
+
+        constexpr implicit_value& operator=(std::nullopt_t) {
+            reset();
+            return *this;
+        }
+
+        /// whether the value does not equal the default value
+        constexpr bool has_value() const {
+            if constexpr (std::floating_point<T>) {
+                // as protobuf does, negative zero is different from the default value
+                return std::bit_cast<uint<sizeof(T)>>(v) != 0;
+            } else if constexpr (requires { v.empty(); }) {
+                return !v.empty();
+            } else {
+                return v != T();
+            }
+        }
+
+        constexpr explicit operator bool() const {
+            return has_value();
+        }
+
+        constexpr T& value() & { return v; }
+        constexpr const T& value() const & { return v; }
+        constexpr T&& value() && { return std::move(v); }
+
+        constexpr T& operator*() & { return v; }
+        constexpr const T& operator*() const & { return v; }
+        constexpr T&& operator*() && { return std::move(v); }
+
+        constexpr T* operator->() { return &v; }
+        constexpr const T* operator->() const { return &v; }
+
+        template <typename U>
+        constexpr T value_or(U&& u) const {
+            return has_value() ? v : static_cast<T>(std::forward<U>(u));
+        }
+
+        template <typename... Args>
+        constexpr T& emplace(Args&&... args) {
+            v = T(std::forward<Args>(args)...);
+            return v;
+        }
+
+        /// reset to the default value, where the capacity of a container is kept
+        constexpr void reset() {
+            if constexpr (requires { v.clear(); }) {
+                v.clear();
+            } else {
+                v = T();
+            }
+        }
+
+        friend constexpr bool operator==(const implicit_value& l, const implicit_value& r) {
+            return l.v == r.v;
+        }
+
+        friend constexpr bool operator==(const implicit_value& l, std::nullopt_t) {
+            return !l.has_value();
+        }
+
+        template <typename U> requires (!std::derived_from<U, implicit_value>) && std::convertible_to<const U&, T>
+        friend constexpr bool operator==(const implicit_value& l, const U& r) {
+            return l.v == r;
+        }
+
+    private:
+        T v = make_value<T>();
     };
 
     template <attribute, typename T, typename>
@@ -74,16 +192,26 @@ namespace pp {
         using type = std::optional<T>;
     };
 
+    template <typename T, typename C>
+    struct field_container_impl<implicit, T, C> {
+        using type = implicit_value<T>;
+    };
+
     template <typename T, typename C>
     struct field_container_impl<repeated, T, C> {
         using type = C;
     };
 
+    template <typename T, typename C>
+    struct field_container_impl<packed, T, C> {
+        using type = C;
+    };
+
     /// @brief The underlying container type of a field
     /// @param A the @ref attribute of the field
     /// @param T the underlying object type (to store data) of the field
     /// @param Container the underlying container to store repeated objects, 
-    /// it will be used while the attribute `A` is @ref repeated
+    /// it will be used while the attribute `A` is @ref repeated or @ref packed
     template <attribute A, typename T, std::ranges::sized_range Container = std::vector<T>>
     using field_container = typename field_container_impl<A, T, Container>::type;
 
@@ -92,9 +220,11 @@ namespace pp {
     /// @param N the field number, ref to https://developers.google.com/protocol-buffers/docs/encoding#structure
     /// @param C the @ref coder of the field
     /// @param A the @ref attribute of the field
-    /// @param Container the container used in @ref field_container, enabled while `A` is @ref repeated.
+    /// @param Container the container used in @ref field_container, enabled while `A` is @ref repeated or @ref packed.
     template <basic_fixed_string S, uint<4> N, coder C, attribute A = singular, std::ranges::sized_range Container = std::vector<typename C::value_type>>
     struct field : field_container<A, typename C::value_type, Container>{
+        static_assert(A != packed || wire_type<C> != 2, "only fields of scalars can be packed");
+
         /// name of the field
         static constexpr basic_fixed_string name = S;
 
@@ -105,7 +235,16 @@ namespace pp {
         static constexpr uint<4> number = N;
 
         /// key of the field, ref to https://developers.google.com/protocol-buffers/docs/encoding#structure
-        static constexpr uint<4> key = (N << 3u) | wire_type<C>;
+        static constexpr uint<4> key = (N << 3u) | (A == packed ? 2 : wire_type<C>);
+
+        /// key of every single value of the field which is encoded one by one (i.e. not packed)
+        static constexpr uint<4> element_key = (N << 3u) | wire_type<C>;
+
+        /// key of the values of the field which are packed into a length-delimited value
+        static constexpr uint<4> packed_key = (N << 3u) | 2;
+
+        /// whether values of the field can be decoded from both packed and unpacked encodings, ref to @ref packed
+        static constexpr bool packable = !is_singular(A) && wire_type<C> != 2;
 
         /// @ref coder of the field 
         using coder = C;
@@ -118,6 +257,9 @@ namespace pp {
 
         using base_type::base_type;
 
+        /// construct an empty field, where an allocator-aware container is constructed with @ref current_memory_resource
+        constexpr field() : base_type(make_value<base_type>()) {}
+
         field(const base_type& base) : base_type(base) {}
         field(base_type&& base) : base_type(std::move(base)) {}
 
@@ -210,6 +352,14 @@ namespace pp {
     template <basic_fixed_string S, uint<4> N, attribute A = singular, typename Container = std::vector<std::string>>
     using string_field = field<S, N, string_coder, A, Container>;
 
+    /// Type alias for string fields which should be valid UTF-8, ref to @ref utf8_string_coder
+    template <basic_fixed_string S, uint<4> N, attribute A = singular, typename Container = std::vector<std::string>>
+    using utf8_string_field = field<S, N, utf8_string_coder<>, A, Container>;
+
+    /// Type alias for @ref inline_string fields, whose values have at most `L` characters
+    template <basic_fixed_string S, uint<4> N, std::size_t L, attribute A = singular, typename Container = std::vector<inline_string<L>>>
+    using inline_string_field = field<S, N, inline_string_coder<L>, A, Container>;
+
     /// Type alias for bytes fields
     template <basic_fixed_string S, uint<4> N, attribute A = singular, typename Container = std::vector<std::vector<uint<1>>>>
     using bytes_field = field<S, N, bytes_coder, A, Container>;
@@ -222,6 +372,26 @@ namespace pp {
     template <basic_fixed_string S, uint<4> N, typename T, attribute A = singular, typename Container = std::vector<T>>
     using enum_field = field<S, N, enum_coder<T>, A, Container>;
 
+    namespace pmr {
+
+        /// Type alias for fields using `std::pmr::vector` as the container of repeated values, ref to @ref pp::field
+        template <basic_fixed_string S, uint<4> N, coder C, attribute A = singular>
+        using field = pp::field<S, N, C, A, std::pmr::vector<typename C::value_type>>;
+
+        /// Type alias for `std::pmr::string` fields
+        template <basic_fixed_string S, uint<4> N, attribute A = singular>
+        using string_field = field<S, N, string_coder, A>;
+
+        /// Type alias for `std::pmr::string` fields which should be valid UTF-8
+        template <basic_fixed_string S, uint<4> N, attribute A = singular>
+        using utf8_string_field = field<S, N, utf8_string_coder, A>;
+
+        /// Type alias for `std::pmr::vector<uint<1>>` fields
+        template <basic_fixed_string S, uint<4> N, attribute A = singular>
+        using bytes_field = field<S, N, bytes_coder, A>;
+
+    }
+
     /// Checks whether the type is a field type.
     template <typename>
     constexpr inline bool is_field = false;
@@ -233,6 +403,340 @@ namespace pp {
     template <typename T>
     concept field_c = is_field<T>;
 
+    /// Checks whether the field `F` has the field number `N`, where a @ref oneof_field has field numbers of all its members
+    template <field_c F, uint<4> N>
+    constexpr inline bool has_field_number = F::number == N;
+
+    /// The index of the first field in `C...` which has the field number `I` (ref to @ref has_field_number), or `sizeof...(C)` if not found
+    template <uint<4> I, field_c... C>
+    constexpr inline std::size_t field_number_index = [] {
+        constexpr std::array<bool, sizeof...(C)> found{has_field_number<C, I>...};
+        return std::ranges::find(found, true) - found.begin();
+    }();
+
+    /// The index of the first field in `C...` whose field name is `S`, or `sizeof...(C)` if not found
+    template <basic_fixed_string S, field_c... C>
+    constexpr inline std::size_t field_name_index = [] {
+        constexpr std::array<bool, sizeof...(C)> found{(S == C::name)...};
+        return std::ranges::find(found, true) - found.begin();
+    }();
+
+    /// @brief A oneof field, i.e. a group of @ref singular fields `F...` where at most one of them is set at the same time
+    /// @param S the name of the oneof field
+    /// @param F the member fields, which are accessed by their own field numbers or names
+    ///
+    /// Values of the members are stored in a single `std::variant` (where `std::monostate` represents that no member is set),
+    /// so that it occupies as much memory as the largest member. While decoding, values of all members are decoded into
+    /// the variant where the last one wins; while encoding, only the set member is encoded.
+    /// Ref to https://developers.google.com/protocol-buffers/docs/proto3#oneof
+    template <basic_fixed_string S, field_c... F>
+    struct oneof_field : std::variant<std::monostate, typename F::coder::value_type...> {
+        static_assert(sizeof...(F) > 0, "a oneof field should have at least one member");
+        static_assert(((F::attr == singular) && ...), "members of a oneof field should be singular fields");
+
+        /// name of the field
+        static constexpr basic_fixed_string name = S;
+
+        /// type of name of the field
+        using name_type = decltype(name);
+
+        /// attribute of the field
+        static constexpr attribute attr = oneof;
+
+        /// the underlying type (to store data of the field), which the field is derived from
+        using base_type = std::variant<std::monostate, typename F::coder::value_type...>;
+
+        /// the `I`-th member field, whose value is stored as the `I + 1`-th alternative of @ref base_type
+        template <std::size_t I>
+        using member = std::tuple_element_t<I, std::tuple<F...>>;
+
+        /// the number of member fields
+        static constexpr std::size_t size = sizeof...(F);
+
+    private:
+        template <uint<4> N>
+        static constexpr std::size_t index_by_number = field_number_index<N, F...> + 1;
+
+        template <basic_fixed_string N>
+        static constexpr std::size_t index_by_name = field_name_index<N, F...> + 1;
+
+    public:
+        using base_type::base_type;
+        using base_type::operator=;
+
+        constexpr oneof_field() = default;
+
+        /// whether a member is set
+        constexpr bool has_value() const {
+            return this->index() != 0;
+        }
+
+        /// unset the member
+        constexpr void reset() {
+            cast_to_base().template emplace<0>();
+        }
+
+        /// the field number of the set member, or 0 if no member is set
+        constexpr uint<4> active_number() const {
+            constexpr std::array<uint<4>, sizeof...(F) + 1> numbers{0, F::number...};
+            return numbers[this->index()];
+        }
+
+        /// whether the member with field number `N` is set
+        template <uint<4> N>
+        constexpr bool holds() const {
+            static_assert(index_by_number<N> <= size, "member not found");
+            return this->index() == index_by_number<N>;
+        }
+
+        /// whether the member with field name `N` is set
+        template <basic_fixed_string N>
+        constexpr bool holds() const {
+            static_assert(index_by_name<N> <= size, "member not found");
+            return this->index() == index_by_name<N>;
+        }
+
+        /// get a pointer to the value of the member with field number `N`, or `nullptr` if the member is not set
+        template <uint<4> N>
+        constexpr auto get_if() {
+            return std::get_if<index_by_number<N>>(&cast_to_base());
+        }
+
+        /// get a pointer to the value of the member with field number `N`, or `nullptr` if the member is not set
+        template <uint<4> N>
+        constexpr auto get_if() const {
+            return std::get_if<index_by_number<N>>(&cast_to_base());
+        }
+
+        /// get a pointer to the value of the member with field name `N`, or `nullptr` if the member is not set
+        template <basic_fixed_string N>
+        constexpr auto get_if() {
+            return std::get_if<index_by_name<N>>(&cast_to_base());
+        }
+
+        /// get a pointer to the value of the member with field name `N`, or `nullptr` if the member is not set
+        template <basic_fixed_string N>
+        constexpr auto get_if() const {
+            return std::get_if<index_by_name<N>>(&cast_to_base());
+        }
+
+        /// set the member with field number `N` to a value constructed from `args`
+        template <uint<4> N, typename... Args>
+        constexpr decltype(auto) emplace(Args&&... args) {
+            return cast_to_base().template emplace<index_by_number<N>>(std::forward<Args>(args)...);
+        }
+
+        /// set the member with field name `N` to a value constructed from `args`
+        template <basic_fixed_string N, typename... Args>
+        constexpr decltype(auto) emplace(Args&&... args) {
+            return cast_to_base().template emplace<index_by_name<N>>(std::forward<Args>(args)...);
+        }
+
+        /// cast the field to @ref base_type
+        constexpr decltype(auto) cast_to_base() {
+            return static_cast<base_type&>(*this);
+        }
+
+        /// cast the const field to const @ref base_type
+        constexpr decltype(auto) cast_to_base() const {
+            return static_cast<const base_type&>(*this);
+        }
+    };
+
+    template <basic_fixed_string S, field_c... F>
+    constexpr inline bool is_field <oneof_field<S, F...>> = true;
+
+    /// How an @ref unknown_field_set keeps bytes of unknown fields
+    enum class unknown_storage {
+        /// bytes are copied into a single contiguous buffer owned by the set
+        owned,
+        /// @brief bytes are referred to in the decoded bytes without copying (zero-copy),
+        /// so the decoded bytes should outlive the set and everything it is copied to
+        view
+    };
+
+    /// @brief Raw bytes of unknown fields (with their keys) recorded while decoding a message, in the order they appear
+    ///
+    /// Fields adjacent in the decoded bytes are kept as a single run, so that they are encoded by a single copy.
+    /// With @ref unknown_storage::owned, all fields are copied into one buffer, which is encoded as a single run.
+    template <unknown_storage St = unknown_storage::owned>
+    class unknown_field_set {
+    public:
+        constexpr unknown_field_set() = default;
+
+        /// the number of bytes of all recorded fields
+        constexpr std::size_t size() const noexcept {
+            if constexpr (St == unknown_storage::owned) {
+                return buffer.size();
+            } else {
+                return total;
+            }
+        }
+
+        constexpr bool empty() const noexcept {
+            return size() == 0;
+        }
+
+        /// the number of runs, i.e. copies needed to encode the recorded fields
+        constexpr std::size_t run_count() const noexcept {
+            if constexpr (St == unknown_storage::owned) {
+                return !buffer.empty();
+            } else {
+                return runs.size();
+            }
+        }
+
+        /// record the bytes `b` of one or more fields (with their keys)
+        constexpr void append(std::span<const std::byte> b) {
+            if (b.empty()) {
+                return;
+            }
+
+            if constexpr (St == unknown_storage::owned) {
+                buffer.insert(buffer.end(), b.begin(), b.end());
+            } else {
+                if (!runs.empty() && runs.back().data() + runs.back().size() == b.data()) {
+                    runs.back() = {runs.back().data(), runs.back().size() + b.size()};
+                } else {
+                    runs.push_back(b);
+                }
+                total += b.size();
+            }
+        }
+
+        /// remove all recorded fields, where the capacity is kept
+        constexpr void clear() noexcept {
+            if constexpr (St == unknown_storage::owned) {
+                buffer.clear();
+            } else {
+                runs.clear();
+                total = 0;
+            }
+        }
+
+        /// invoke `f` with every run of the recorded fields in order, as a `std::span<const std::byte>`
+        template <typename F>
+        constexpr void for_each_run(F&& f) const {
+            if constexpr (St == unknown_storage::owned) {
+                if (!buffer.empty()) {
+                    f(std::span<const std::byte>(buffer));
+                }
+            } else {
+                for (const auto& run : runs) {
+                    f(run);
+                }
+            }
+        }
+
+        /// append all fields recorded in `other`
+        template <unknown_storage U>
+        constexpr void merge(const unknown_field_set<U>& other) {
+            other.for_each_run([this](std::span<const std::byte> run) {
+                append(run);
+            });
+        }
+
+        /// whether the recorded bytes are equal, no matter how they are split into runs
+        template <unknown_storage U>
+        friend constexpr bool operator==(const unknown_field_set& l, const unknown_field_set<U>& r) {
+            if (l.size() != r.size()) {
+                return false;
+            }
+
+            if constexpr (St == unknown_storage::owned && U == unknown_storage::owned) {
+                return l.buffer == r.buffer;
+            }
+
+            std::vector<std::span<const std::byte>> rs;
+            r.for_each_run([&rs](std::span<const std::byte> run) { rs.push_back(run); });
+
+            bool equal = true;
+            auto it = rs.begin();
+            std::size_t offset = 0;
+            l.for_each_run([&](std::span<const std::byte> run) {
+                while (equal && !run.empty()) {
+                    const auto n = std::min(run.size(), it->size() - offset);
+                    equal = std::equal(run.begin(), run.begin() + n, it->begin() + offset);
+                    run = run.subspan(n);
+                    if ((offset += n) == it->size()) {
+                        ++it;
+                        offset = 0;
+                    }
+                }
+            });
+            return equal;
+        }
+
+    private:
+        template <unknown_storage>
+        friend class unknown_field_set;
+
+        struct none {};
+
+        template <typename T>
+        using owned_only = std::conditional_t<St == unknown_storage::owned, T, none>;
+
+        template <typename T>
+        using view_only = std::conditional_t<St == unknown_storage::view, T, none>;
+
+        [[no_unique_address]] owned_only<std::vector<std::byte>> buffer;
+        [[no_unique_address]] view_only<std::vector<std::span<const std::byte>>> runs;
+        [[no_unique_address]] view_only<std::size_t> total{};
+    };
+
+    /// @brief A field keeping raw bytes of the fields which are not declared in the message, so that they survive decoding and re-encoding
+    /// (i.e. in a proxy which modifies some fields and forwards the message)
+    /// @param S the name of the field
+    /// @param St how the bytes are kept, ref to @ref unknown_storage
+    ///
+    /// While decoding, unknown fields are recorded instead of being skipped. While encoding, they are encoded as they are
+    /// after the fields declared before this field, so it is usually declared as the last field. A message has at most one such field.
+    template <basic_fixed_string S, unknown_storage St = unknown_storage::owned>
+    struct unknown_fields_field : unknown_field_set<St> {
+        /// name of the field
+        static constexpr basic_fixed_string name = S;
+
+        /// type of name of the field
+        using name_type = decltype(name);
+
+        /// the field number, where 0 is never a number of a declared field
+        static constexpr uint<4> number = 0;
+
+        /// attribute of the field
+        static constexpr attribute attr = unknown;
+
+        /// how the bytes are kept
+        static constexpr unknown_storage storage = St;
+
+        /// the underlying type (to store data of the field), which the field is derived from
+        using base_type = unknown_field_set<St>;
+
+        constexpr unknown_fields_field() = default;
+
+        /// cast the field to @ref base_type
+        constexpr decltype(auto) cast_to_base() {
+            return static_cast<base_type&>(*this);
+        }
+
+        /// cast the const field to const @ref base_type
+        constexpr decltype(auto) cast_to_base() const {
+            return static_cast<const base_type&>(*this);
+        }
+    };
+
+    template <basic_fixed_string S, unknown_storage St>
+    constexpr inline bool is_field <unknown_fields_field<S, St>> = true;
+
+    template <basic_fixed_string S, field_c... F, uint<4> N>
+    constexpr inline bool has_field_number<oneof_field<S, F...>, N> = ((F::number == N) || ...);
+
+    /// A field number by which the field `F` is found in a message, i.e. the field number of the first member of a @ref oneof_field
+    template <field_c F>
+    constexpr inline uint<4> field_lookup_number = F::number;
+
+    template <basic_fixed_string S, field_c... F>
+    constexpr inline uint<4> field_lookup_number<oneof_field<S, F...>> = oneof_field<S, F...>::template member<0>::number;
+
     /// Represents the specific field is not found, used in @ref field_number_selector and @ref field_name_selector
     struct field_not_found;
 
@@ -241,7 +745,7 @@ namespace pp {
 
     template <uint<4> I, field_c C, field_c... D>
     struct field_number_selector_impl<I, C, D...> {
-        using type = std::conditional_t<I == C::number, C, typename field_number_selector_impl<I, D...>::type>;
+        using type = std::conditional_t<has_field_number<C, I>, C, typename field_number_selector_impl<I, D...>::type>;
     };
 
     template <uint<4> I>
@@ -249,7 +753,7 @@ namespace pp {
         using type = field_not_found;
     };
 
-    /// Find the first field in `C...` whose field number is `I`
+    /// Find the first field in `C...` whose field number is `I`, or the @ref oneof_field containing the member whose field number is `I`
     template <uint<4> I, field_c... C>
     using field_number_selector = typename field_number_selector_impl<I, C...>::type;
 
@@ -273,7 +777,7 @@ namespace pp {
     /// Checks whether a field is empty
     template <field_c T>
     constexpr bool empty_field(const T& v) {
-        if constexpr (T::attr == singular) {
+        if constexpr (is_singular(T::attr)) {
             return !v.has_value();
         } else {
             return v.empty();
@@ -283,7 +787,7 @@ namespace pp {
     /// Push a value into a field: overwrite if it is singular, insert to end otherwise
     template <field_c F, typename T>
     constexpr void push_field(F& f, T&& v) {
-        if constexpr (F::attr == singular) {
+        if constexpr (is_singular(F::attr)) {
             f = std::forward<T>(v);
         } else {
             *std::inserter(f, f.end()) = std::forward<T>(v);
@@ -307,7 +811,7 @@ namespace pp {
     /// Merge a field into another field: overwrite if it is singular and non-empty, merge to end otherwise
     template <merge_mode mode = merge_mode{}, field_c D, typename S> requires field_c<std::remove_cvref_t<S>>
     constexpr void merge_field(D& f, S&& v) {
-        if constexpr (D::attr == singular) {
+        if constexpr (is_singular(D::attr)) {
             if constexpr (mode.singular_mode == merge_mode::singular::override) {
                 if (!empty_field(v)) {
                     f = std::forward<S>(v);
@@ -317,6 +821,8 @@ namespace pp {
                     f = std::forward<S>(v);
                 }
             }
+        } else if constexpr (D::attr == unknown) {
+            f.merge(v);
         } else {
             auto inserter = std::inserter(f, f.end());
 
@@ -0,0 +1,223 @@
+//   Copyright 2020-2021 PragmaTwice
+//
+//   Licensed under the Apache License, Version 2.0 (the "License");
+//   you may not use this file except in compliance with the License.
+//   You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the License is distributed on an "AS IS" BASIS,
+//   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//   See the License for the specific language governing permissions and
+//   limitations under the License.
+
+#ifndef PROTOPUF_FIELD_STATS_H
+#define PROTOPUF_FIELD_STATS_H
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <tuple>
+
+#include "compact_message.h"
+#include "message.h"
+
+namespace pp {
+
+    /// Counters of a field in a direction, ref to @ref field_stats
+    struct field_totals {
+        std::uint64_t count = 0;
+        std::uint64_t bytes = 0;
+        std::uint64_t nanoseconds = 0;
+
+        constexpr bool operator==(const field_totals&) const = default;
+    };
+
+    namespace field_stats_impl {
+        /// The kind (i.e. `message`) and the fields of a message type `T` observed by @ref field_stats
+        template <typename T>
+        struct observed_message {};
+
+        template <field_c... F>
+        struct observed_message<message<F...>> {
+            static constexpr std::string_view kind = "message";
+            using fields = std::tuple<F...>;
+        };
+
+        template <field_c... F>
+        struct observed_message<compact_message<F...>> {
+            static constexpr std::string_view kind = "compact_message";
+            using fields = std::tuple<F...>;
+        };
+
+        /// Get the name of the field `F` if it has the number `number`, where members of a @ref oneof_field have their own names
+        template <field_c F>
+        constexpr std::string_view field_name_by_number(uint<4> number) {
+            if constexpr (F::attr == oneof) {
+                return [number]<std::size_t... I>(std::index_sequence<I...>) {
+                    std::string_view name;
+                    (void)(((F::template member<I>::number == number) && (name = std::string_view(F::template member<I>::name), true)) || ...);
+                    return name;
+                }(std::make_index_sequence<F::size>{});
+            } else if constexpr (F::attr == unknown) {
+                return {};
+            } else {
+                return F::number == number ? std::string_view(F::name) : std::string_view{};
+            }
+        }
+    }
+
+    /// Get the name of the field with the number `number` in the message `T`, or an empty string if it is not found
+    template <typename T>
+    constexpr std::string_view observed_field_name(uint<4> number) {
+        if constexpr (requires { typename field_stats_impl::observed_message<T>::fields; }) {
+            return [number]<field_c... F>(std::type_identity<std::tuple<F...>>) {
+                std::string_view name;
+                (void)((!(name = field_stats_impl::field_name_by_number<F>(number)).empty()) || ...);
+                return name;
+            }(std::type_identity<typename field_stats_impl::observed_message<T>::fields>{});
+        } else {
+            return {};
+        }
+    }
+
+    /// @brief A @ref coder_observer which counts occurrences, bytes (and time, if `Timed`) of every field per message type
+    /// in relaxed atomic counters, so that it can be shared by threads coding concurrently
+    ///
+    /// Fields with numbers larger than `MaxNumber` are counted together. Counters are static,
+    /// where different `Tag` types have distinct counters.
+    template <typename Tag = void, bool Timed = false, std::size_t MaxNumber = 63>
+    struct field_stats {
+        static constexpr bool timed = Timed;
+
+        template <typename T>
+        static void on_field(const field_event& e) {
+            auto& c = counters_of<T>().fields[index_of(e.number)][std::size_t(e.direction)];
+            c.count.fetch_add(1, std::memory_order_relaxed);
+            c.bytes.fetch_add(e.size, std::memory_order_relaxed);
+            if constexpr (Timed) {
+                c.nanoseconds.fetch_add(e.duration.count(), std::memory_order_relaxed);
+            }
+        }
+
+        /// Get the counters of the field with the number `number` of the message `T`
+        template <typename T>
+        static field_totals totals(coder_direction direction, uint<4> number) {
+            const auto& c = counters_of<T>().fields[index_of(number)][std::size_t(direction)];
+            return {c.count.load(std::memory_order_relaxed), c.bytes.load(std::memory_order_relaxed),
+                    c.nanoseconds.load(std::memory_order_relaxed)};
+        }
+
+        /// Reset all counters to zero
+        static void reset() {
+            for (auto* m = head.load(std::memory_order_acquire); m; m = m->next) {
+                for (auto& directions : m->fields) {
+                    for (auto& c : directions) {
+                        c.count.store(0, std::memory_order_relaxed);
+                        c.bytes.store(0, std::memory_order_relaxed);
+                        c.nanoseconds.store(0, std::memory_order_relaxed);
+                    }
+                }
+            }
+        }
+
+        /// @brief Write a text report of all fields which are coded at least once, grouped by message types
+        ///
+        /// Every line of a field has its number, name (if known), and the counters of encoding and decoding.
+        static void dump(std::ostream& os) {
+            for (auto* m = head.load(std::memory_order_acquire); m; m = m->next) {
+                os << m->type_name << '\n';
+                for (std::size_t i = 0; i < m->fields.size(); ++i) {
+                    const auto& [encode, decode] = m->fields[i];
+                    if (encode.count.load(std::memory_order_relaxed) == 0 && decode.count.load(std::memory_order_relaxed) == 0) {
+                        continue;
+                    }
+
+                    os << "  ";
+                    if (i == 0) {
+                        os << "unknown fields";
+                    } else if (i > MaxNumber) {
+                        os << "fields > " << MaxNumber;
+                    } else {
+                        os << i;
+                        if (const auto name = m->name_of(uint<4>(i)); !name.empty()) {
+                            os << ' ' << name;
+                        }
+                    }
+                    os << ":";
+                    dump_counter(os, "encode", encode);
+                    dump_counter(os, "decode", decode);
+                    os << '\n';
+                }
+            }
+        }
+
+    private:
+        struct counter {
+            std::atomic<std::uint64_t> count{0};
+            std::atomic<std::uint64_t> bytes{0};
+            std::atomic<std::uint64_t> nanoseconds{0};
+        };
+
+        struct message_counters {
+            std::string type_name;
+            std::string_view (*name_of)(uint<4>);
+            std::array<std::array<counter, 2>, MaxNumber + 2> fields{};
+            message_counters* next = nullptr;
+        };
+
+        // Counters of every message type are linked into a list when the type is observed at first
+        static inline std::atomic<message_counters*> head = nullptr;
+
+        static constexpr std::size_t index_of(uint<4> number) {
+            return number > MaxNumber ? MaxNumber + 1 : number;
+        }
+
+        template <typename T>
+        static message_counters& counters_of() {
+            static message_counters& m = [] () -> message_counters& {
+                static message_counters counters{type_name_of<T>(), observed_field_name<T>};
+                counters.next = head.load(std::memory_order_relaxed);
+                while (!head.compare_exchange_weak(counters.next, &counters, std::memory_order_release, std::memory_order_relaxed)) {}
+                return counters;
+            }();
+            return m;
+        }
+
+        // Messages are named by the names of their fields, i.e. `message<id, name>` and `compact_message<id, name>`
+        template <typename T>
+        static std::string type_name_of() {
+            using observed = field_stats_impl::observed_message<T>;
+
+            if constexpr (requires { typename observed::fields; }) {
+                return []<field_c... F>(std::type_identity<std::tuple<F...>>) {
+                    std::string name = std::string(observed::kind) + "<";
+                    bool first = true;
+                    ((F::attr != unknown ? (name += first ? "" : ", ", name += std::string_view(F::name), first = false) : false), ...);
+                    return name + ">";
+                }(std::type_identity<typename observed::fields>{});
+            } else {
+                return "fields";
+            }
+        }
+
+        static void dump_counter(std::ostream& os, std::string_view direction, const counter& c) {
+            const auto count = c.count.load(std::memory_order_relaxed);
+            if (count == 0) {
+                return;
+            }
+
+            os << ' ' << direction << ' ' << count << " times " << c.bytes.load(std::memory_order_relaxed) << " bytes";
+            if constexpr (Timed) {
+                os << ' ' << c.nanoseconds.load(std::memory_order_relaxed) << " ns";
+            }
+        }
+    };
+
+}
+
+#endif //PROTOPUF_FIELD_STATS_H
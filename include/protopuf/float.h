@@ -68,6 +68,14 @@ namespace pp {
             
             return {};
         }
+
+        template<coder_mode Mode>
+        static constexpr decode_to_result<Mode> decode_to(T& out, bytes b) {
+            underlying_type u{};
+            auto result = integer_coder<underlying_type>::template decode_to<Mode>(u, b);
+            out = value_cast(u);
+            return result;
+        }
     };
 
     template <std::size_t N>
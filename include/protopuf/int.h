@@ -215,6 +215,16 @@ namespace pp {
 
             return Mode::template make_result<decode_result<T, Mode>>(bytes_to_int<N>(b.subspan<0, N>()), b.subspan<N>());
         }
+
+        template <coder_mode Mode = safe_mode>
+        static constexpr decode_to_result<Mode> decode_to(T& out, bytes b) {
+            if (!Mode::check_bytes_span(b, N)) {
+                return {};
+            }
+
+            out = bytes_to_int<N>(b.subspan<0, N>());
+            return Mode::template make_result<decode_to_result<Mode>>(b.subspan<N>());
+        }
     };
 
     template <std::signed_integral T>
@@ -233,6 +243,14 @@ namespace pp {
         static constexpr decode_result<T, Mode> decode(bytes b) {
             return integer_coder<std::make_unsigned_t<T>>::template decode<Mode>(b);
         }
+
+        template <coder_mode Mode = safe_mode>
+        static constexpr decode_to_result<Mode> decode_to(T& out, bytes b) {
+            std::make_unsigned_t<T> u{};
+            auto result = integer_coder<std::make_unsigned_t<T>>::template decode_to<Mode>(u, b);
+            out = static_cast<T>(u);
+            return result;
+        }
     };
 
 }
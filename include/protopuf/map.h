@@ -16,6 +16,7 @@
 #define PROTOPUF_MAP_H
 
 #include <map>
+#include <tuple>
 #include "message.h"
 
 namespace pp {
@@ -47,11 +48,17 @@ namespace pp {
         using base_type_ = base_type;
         using base_type_::base_type_;
 
-        operator pair_type() const {
+        operator pair_type() const & {
             return pair_type { 
                 this->template get<1>(), this->template get<2>() 
             };
         }
+
+        operator pair_type() && {
+            return pair_type {
+                std::move(this->template get<1>()), std::move(this->template get<2>())
+            };
+        }
     };
 
     template <typename T1, typename T2>
@@ -60,6 +67,26 @@ namespace pp {
     template <coder_mode Mode, typename T1, typename T2>
     struct message_decode_map<Mode, map_element<T1, T2>> : message_decode_map<Mode, typename map_element<T1, T2>::base_type> {};
 
+    template <coder_mode Mode, typename T1, typename T2>
+    struct message_decode_into_map<Mode, map_element<T1, T2>> : message_decode_into_map<Mode, typename map_element<T1, T2>::base_type> {};
+
+    /// @brief Push a map element into a map field, ref to @ref push_field
+    ///
+    /// The key and the value are moved into the new node of the map directly, instead of being copied via @ref map_element::pair_type,
+    /// so that they keep their allocators (i.e. the memory resource of decoding).
+    template <field_c F, coder K, coder V> requires (F::attr == repeated)
+    constexpr void push_field(F& f, map_element<K, V>&& v) {
+        using element = map_element<K, V>;
+
+        if constexpr (requires { f.emplace_hint(f.end(), std::piecewise_construct, std::tuple<>{}, std::tuple<>{}); }) {
+            f.emplace_hint(f.end(), std::piecewise_construct,
+                std::forward_as_tuple(static_cast<typename element::first_type&&>(v.template get<1>())),
+                std::forward_as_tuple(static_cast<typename element::second_type&&>(v.template get<2>())));
+        } else {
+            *std::inserter(f, f.end()) = std::move(v);
+        }
+    }
+
     /// Type alias for map fields
     template<basic_fixed_string S, uint<4> N, coder key_coder, coder value_coder,
         typename Container = std::map<
@@ -69,6 +96,17 @@ namespace pp {
     >
     using map_field = message_field<S, N, map_element<key_coder, value_coder>, repeated, Container>;
 
+    namespace pmr {
+
+        /// Type alias for map fields using `std::pmr::map` as the container
+        template<basic_fixed_string S, uint<4> N, coder key_coder, coder value_coder>
+        using map_field = pp::map_field<S, N, key_coder, value_coder, std::pmr::map<
+            typename map_element<key_coder, value_coder>::first_type,
+            typename map_element<key_coder, value_coder>::second_type
+        >>;
+
+    }
+
 }
 
 #endif //PROTOPUF_MAP_H
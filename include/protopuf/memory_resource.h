@@ -0,0 +1,81 @@
+//   Copyright 2020-2021 PragmaTwice
+//
+//   Licensed under the Apache License, Version 2.0 (the "License");
+//   you may not use this file except in compliance with the License.
+//   You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the License is distributed on an "AS IS" BASIS,
+//   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//   See the License for the specific language governing permissions and
+//   limitations under the License.
+
+#ifndef PROTOPUF_MEMORY_RESOURCE_H
+#define PROTOPUF_MEMORY_RESOURCE_H
+
+#include <concepts>
+#include <memory_resource>
+
+namespace pp {
+
+    /// @brief A scope where @ref make_value constructs allocator-aware containers with the memory resource `resource`
+    ///
+    /// Scopes are thread-local and can be nested, the innermost scope takes effect.
+    /// Since memory resources are not thread-safe in general (i.e. `std::pmr::monotonic_buffer_resource`),
+    /// decoding by an @ref executor inside a scope runs in the calling thread only, ref to `active`.
+    class memory_resource_scope {
+    public:
+        explicit memory_resource_scope(std::pmr::memory_resource* resource) : previous(current) {
+            current = resource;
+        }
+
+        memory_resource_scope(const memory_resource_scope&) = delete;
+        memory_resource_scope& operator=(const memory_resource_scope&) = delete;
+
+        ~memory_resource_scope() {
+            current = previous;
+        }
+
+        /// whether this thread is inside any scope
+        static bool active() {
+            return current != nullptr;
+        }
+
+        /// the memory resource of the innermost scope in this thread, or `std::pmr::get_default_resource()` if out of any scope
+        static std::pmr::memory_resource* resource() {
+            return current ? current : std::pmr::get_default_resource();
+        }
+
+    private:
+        static inline thread_local std::pmr::memory_resource* current = nullptr;
+
+        std::pmr::memory_resource* previous;
+    };
+
+    /// Get the memory resource of the innermost @ref memory_resource_scope in this thread
+    inline std::pmr::memory_resource* current_memory_resource() {
+        return memory_resource_scope::resource();
+    }
+
+    /// @brief A type whose allocator can be constructed from a memory resource, i.e. `std::pmr::vector<T>` and `std::pmr::string`
+    template <typename T>
+    concept memory_resource_aware = requires { typename T::allocator_type; } &&
+        std::constructible_from<typename T::allocator_type, std::pmr::memory_resource*> &&
+        std::constructible_from<T, const typename T::allocator_type&>;
+
+    /// @brief Default-construct a value of type `T` in decoding,
+    /// where a @ref memory_resource_aware type is constructed with @ref current_memory_resource
+    template <typename T>
+    constexpr T make_value() {
+        if constexpr (memory_resource_aware<T>) {
+            return T(typename T::allocator_type(current_memory_resource()));
+        } else {
+            return T();
+        }
+    }
+
+}
+
+#endif //PROTOPUF_MEMORY_RESOURCE_H
@@ -20,7 +20,11 @@
 #include "float.h"
 #include "byte.h"
 #include "coder_mode.h"
+#include "executor.h"
+#include "observer.h"
 
+#include <algorithm>
+#include <array>
 #include <unordered_map>
 #include <functional>
 
@@ -306,37 +310,323 @@ namespace pp {
     template <coder_mode Mode = safe_mode>
     inline const message_skip_map<Mode> skip_map;
 
+    /// @brief Skip a value with the wire type `wire` from the bytes `b`, ref to @ref wire_skip
+    /// @returns the bytes after the skipped value, or an empty result if the wire type is unknown
+    template <coder_mode Mode = safe_mode>
+    constexpr decode_skip_result<Mode> decode_skip_by_wire(uint<1> wire, bytes b) {
+        switch (wire) {
+            case 0: return wire_skip<0>::template decode_skip<Mode>(b);
+            case 1: return wire_skip<1>::template decode_skip<Mode>(b);
+            case 2: return wire_skip<2>::template decode_skip<Mode>(b);
+            case 5: return wire_skip<5>::template decode_skip<Mode>(b);
+            default:
+                report_coder_error<Mode>(coder_error_code::bad_wire_type, b.data());
+                return {};
+        }
+    }
+
     template <coder_mode Mode = safe_mode>
     using message_decode_map_result = typename Mode::template result_type<std::pair<bytes, bool>>;
 
     template <coder_mode Mode = safe_mode>
     using message_decode_map_function_result = typename Mode::template result_type<bytes>;
 
+    /// @brief Checks whether the container `R` of a repeated field decodes a new element from bytes encoded by the @ref coder `C` by itself
+    /// (i.e. into its columns for @ref soa_vector), which is preferred to decoding the element separately in decoding
+    template <typename R, typename C, typename Mode>
+    concept self_decoding_container = coder<C> && coder_mode<Mode> && requires(R& con, bytes b) {
+        { con.template decode_back<C, Mode>(b) } -> std::same_as<decode_to_result<Mode>>;
+    };
+
+    /// @brief A map from field keys to functions decoding a field value into an object of type `T`, ref to @ref message_decode_map
+    ///
+    /// `T` is usually a message type, or another type storing fields (i.e. @ref soa_vector, where a field value is decoded into the last row).
+    template <coder_mode Mode, typename T>
+    struct message_decode_map_base :
+        std::unordered_map<uint<4>, std::function<message_decode_map_function_result<Mode>(T&, bytes)>> {
+    private:
+        using function_result = message_decode_map_function_result<Mode>;
+
+    public:
+        /// @brief Decode a key and the field value following it into `v`, where values of unknown fields are skipped,
+        /// or recorded if `T` has an @ref unknown_fields_field
+        constexpr message_decode_map_result<Mode> decode(T& v, bytes b) const {
+            const bytes origin = b;
+            const field_observation<Mode, T> observation(coder_direction::decode);
+
+            decode_value<uint<4>> decode_v;
+            if (!Mode::get_value_from_result(varint_coder<uint<4>>::decode<Mode>(b), decode_v)) {
+                return {};
+            }
+
+            const auto &[n, nb] = decode_v;
+
+            if(to_field_number(n) == 0) {
+                return Mode::template make_result<message_decode_map_result<Mode>>(b, false);
+            }
+
+            const auto iter = this->find(n);
+            if (iter != this->end()) {
+                if (!Mode::get_value_from_result(iter->second(v, nb), b)) {
+                    return {};
+                }
+            } else {
+                if (!Mode::get_value_from_result(decode_skip_by_wire<Mode>(to_wire_key(n), nb), b)) {
+                    return {};
+                }
+
+                if (record_unknown) {
+                    record_unknown(v, origin.first(begin_diff(b, origin)));
+                }
+            }
+
+            observation.finish(n, begin_diff(b, origin));
+            return Mode::template make_result<message_decode_map_result<Mode>>(b, true);
+        }
+
+        /// @brief Decode a value of the field `f` from `b`
+        ///
+        /// Values are decoded by `decode_to` directly into the optional storage or a new element emplaced at the back
+        /// of the container, instead of being moved from a temporary value; other coders fall back to `decode`.
+        template <field_c G>
+        static constexpr function_result decode_field(G& f, bytes b) {
+            using C = typename G::coder;
+
+            if constexpr (!is_singular(G::attr)) {
+                if (!check_room<Mode>(f.cast_to_base(), b)) {
+                    return {};
+                }
+            }
+
+            if constexpr (!is_singular(G::attr) && self_decoding_container<typename G::base_type, C, Mode>) {
+                return f.template decode_back<C, Mode>(b);
+            } else if constexpr (G::attr == implicit && in_place_decoder<C, Mode>) {
+                return C::template decode_to<Mode>(*f, b);
+            } else if constexpr (is_singular(G::attr) && in_place_decoder<C, Mode>) {
+                return C::template decode_to<Mode>(f.emplace(make_value<typename C::value_type>()), b);
+            } else if constexpr (!is_singular(G::attr) && in_place_decoder<C, Mode> &&
+                requires { { f.emplace_back() } -> std::same_as<typename C::value_type&>; }) {
+                return C::template decode_to<Mode>(f.emplace_back(), b);
+            } else {
+                auto decode_v = make_decode_value<typename C::value_type>();
+                if (Mode::get_value_from_result(C::template decode<Mode>(b), decode_v)) {
+                    push_field(f, std::move(decode_v.first));
+
+                    return function_result{decode_v.second};
+                }
+                return {};
+            }
+        }
+
+        /// Decode packed values of the field `f` from `b`, which are appended to the container in a run, ref to @ref packed
+        template <field_c G>
+        static constexpr function_result decode_packed_field(G& f, bytes b) {
+            return array_coder<typename G::coder, typename G::base_type>::template decode_append<Mode>(f.cast_to_base(), b);
+        }
+
+        /// Decode a value of the `I`-th member of the @ref oneof_field `f` from `b`, which replaces the member set before
+        template <std::size_t I, field_c G>
+        static constexpr function_result decode_oneof_member(G& f, bytes b) {
+            using C = typename G::template member<I>::coder;
+
+            if constexpr (in_place_decoder<C, Mode>) {
+                return C::template decode_to<Mode>(f.cast_to_base().template emplace<I + 1>(make_value<typename C::value_type>()), b);
+            } else {
+                auto decode_v = make_decode_value<typename C::value_type>();
+                if (Mode::get_value_from_result(C::template decode<Mode>(b), decode_v)) {
+                    f.cast_to_base().template emplace<I + 1>(std::move(decode_v.first));
+
+                    return function_result{decode_v.second};
+                }
+                return {};
+            }
+        }
+
+    protected:
+        /// the function recording an unknown field (with its key) into `T`, or null if unknown fields are skipped
+        void (*record_unknown)(T&, bytes) = nullptr;
+
+        /// Insert functions decoding values of the field `G` with all its keys, where the field is accessed from a message by `Get`
+        template <field_c G, typename Get>
+        void insert_field(Get) {
+            if constexpr (G::attr == unknown) {
+                record_unknown = [](T& m, bytes b) {
+                    Get{}(m).append(b);
+                };
+            } else if constexpr (G::attr == oneof) {
+                [this]<std::size_t... I>(std::index_sequence<I...>) {
+                    (this->emplace(G::template member<I>::key, [](T& m, bytes b) {
+                        return decode_oneof_member<I>(Get{}(m), b);
+                    }), ...);
+                }(std::make_index_sequence<G::size>{});
+            } else {
+                this->emplace(G::element_key, [](T& m, bytes b) {
+                    return decode_field(Get{}(m), b);
+                });
+
+                if constexpr (G::packable) {
+                    this->emplace(G::packed_key, [](T& m, bytes b) {
+                        return decode_packed_field(Get{}(m), b);
+                    });
+                }
+            }
+        }
+    };
+
     template <coder_mode, message_c>
     struct message_decode_map;
 
     template <coder_mode Mode, field_c... F>
-    struct message_decode_map<Mode, message<F...>> :
-        std::unordered_map<uint<4>, std::function<message_decode_map_function_result<Mode>(message<F...>&, bytes)>> {
+    struct message_decode_map<Mode, message<F...>> : message_decode_map_base<Mode, message<F...>> {
+        message_decode_map() {
+            (this->template insert_field<F>([](message<F...>& m) -> F& {
+                return m.template get<field_lookup_number<F>>();
+            }), ...);
+        }
+    };
+
+    template <coder_mode Mode, message_c T>
+    inline const message_decode_map<Mode, T> decode_map;
+
+    /// Checks whether a repeated field stores its elements in a sequence where elements can be decoded into in place
+    template <field_c F>
+    constexpr inline bool has_reusable_elements = !is_singular(F::attr) &&
+        requires(typename F::base_type con, std::size_t i) {
+            { con[i] } -> std::same_as<typename F::coder::value_type&>;
+            con.emplace_back();
+            con.erase(con.begin() + i, con.end());
+        };
+
+    template <coder_mode, message_c>
+    struct message_decode_into_map;
+
+    /// @brief A decode map used by `message_coder::decode_into`, which decodes fields into the existing fields of a message
+    ///
+    /// The number of occurrences of every field in the bytes (indexed by the field position) is recorded into `counts`,
+    /// so that singular values and leading elements of repeated fields are reused, and the rest is dropped by `finish`.
+    template <coder_mode Mode, field_c... F>
+    struct message_decode_into_map<Mode, message<F...>> :
+        std::unordered_map<uint<4>, std::function<message_decode_map_function_result<Mode>(message<F...>&, bytes, std::size_t*)>> {
     private:
         using T = message<F...>;
         using function_result = message_decode_map_function_result<Mode>;
+        using base_type = std::unordered_map<uint<4>, std::function<function_result(T&, bytes, std::size_t*)>>;
+
+        // Packed values are appended after the values decoded before, where the rest of reused elements are dropped
+        template <field_c G>
+        static constexpr function_result decode_packed_field(G& f, bytes b, std::size_t& count) {
+            if constexpr (has_reusable_elements<G>) {
+                f.erase(f.begin() + count, f.end());
+            } else if (count++ == 0) {
+                f.clear();
+            }
 
-    public:
-        message_decode_map() : std::unordered_map<uint<4>, std::function<function_result(T&, bytes)>> {
-                {F::key, [](T& m, bytes b){
-                    decode_value<typename F::coder::value_type> decode_v;
-                    if (Mode::get_value_from_result(F::coder::template decode<Mode>(b), decode_v)) {
-                        auto &f = m.template get<F::number>();
-                        push_field(f, std::move(decode_v.first));
-
-                        return function_result{decode_v.second};
+            function_result result = array_coder<typename G::coder, typename G::base_type>::template decode_append<Mode>(f.cast_to_base(), b);
+            if constexpr (has_reusable_elements<G>) {
+                count = f.size();
+            }
+            return result;
+        }
+
+        template <field_c G>
+        static constexpr function_result decode_field(G& f, bytes b, std::size_t& count) {
+            if constexpr (is_singular(G::attr)) {
+                if (G::attr == singular && !f.has_value()) {
+                    f.emplace(make_value<typename G::coder::value_type>());
+                }
+
+                ++count;
+                return decode_into<typename G::coder, Mode>(*f, b);
+            } else if constexpr (has_reusable_elements<G>) {
+                if (count == f.size()) {
+                    if (!check_room<Mode>(f.cast_to_base(), b)) {
+                        return {};
                     }
-                    return function_result{};
-                }}...
-        } {}
+                    f.emplace_back();
+                }
+
+                return decode_into<typename G::coder, Mode>(f[count++], b);
+            } else {
+                if (count++ == 0) {
+                    f.clear();
+                }
+
+                if (!check_room<Mode>(f.cast_to_base(), b)) {
+                    return {};
+                }
+
+                if constexpr (self_decoding_container<typename G::base_type, typename G::coder, Mode>) {
+                    return f.template decode_back<typename G::coder, Mode>(b);
+                } else {
+                    auto decode_v = make_decode_value<typename G::coder::value_type>();
+                    if (!Mode::get_value_from_result(G::coder::template decode<Mode>(b), decode_v)) {
+                        return {};
+                    }
+
+                    push_field(f, std::move(decode_v.first));
+                    return function_result{decode_v.second};
+                }
+            }
+        }
+
+        // The value of the member is reused if the member is set already, otherwise it replaces the member set before
+        template <std::size_t J, field_c G>
+        static constexpr function_result decode_oneof_member(G& f, bytes b, std::size_t& count) {
+            using C = typename G::template member<J>::coder;
+
+            ++count;
+            if (f.index() != J + 1) {
+                f.cast_to_base().template emplace<J + 1>(make_value<typename C::value_type>());
+            }
+
+            return decode_into<C, Mode>(std::get<J + 1>(f.cast_to_base()), b);
+        }
+
+        // the function recording an unknown field (with its key), or null if unknown fields are skipped
+        void (*record_unknown)(T&, bytes, std::size_t*) = nullptr;
+
+        template <std::size_t I, field_c G>
+        void insert_field() {
+            if constexpr (G::attr == unknown) {
+                // fields recorded before are dropped when the first unknown field is found
+                record_unknown = [](T& m, bytes b, std::size_t* counts) {
+                    auto& f = m.template get<G::number>();
+                    if (counts[I]++ == 0) {
+                        f.clear();
+                    }
+                    f.append(b);
+                };
+            } else if constexpr (G::attr == oneof) {
+                [this]<std::size_t... J>(std::index_sequence<J...>) {
+                    (this->emplace(G::template member<J>::key, [](T& m, bytes b, std::size_t* counts) {
+                        return decode_oneof_member<J>(m.template get<field_lookup_number<G>>(), b, counts[I]);
+                    }), ...);
+                }(std::make_index_sequence<G::size>{});
+            } else {
+                this->emplace(G::element_key, [](T& m, bytes b, std::size_t* counts) {
+                    return decode_field(m.template get<G::number>(), b, counts[I]);
+                });
+
+                if constexpr (G::packable) {
+                    this->emplace(G::packed_key, [](T& m, bytes b, std::size_t* counts) {
+                        return decode_packed_field(m.template get<G::number>(), b, counts[I]);
+                    });
+                }
+            }
+        }
+
+        template <std::size_t... I>
+        explicit message_decode_into_map(std::index_sequence<I...>) {
+            (insert_field<I, F>(), ...);
+        }
+
+    public:
+        message_decode_into_map() : message_decode_into_map(std::index_sequence_for<F...>{}) {}
+
+        constexpr message_decode_map_result<Mode> decode(T& v, bytes b, std::size_t* counts) const {
+            const bytes origin = b;
+            const field_observation<Mode, T> observation(coder_direction::decode);
 
-        constexpr message_decode_map_result<Mode> decode(T& v, bytes b) const {
             decode_value<uint<4>> decode_v;
             if (!Mode::get_value_from_result(varint_coder<uint<4>>::decode<Mode>(b), decode_v)) {
                 return {};
@@ -350,22 +640,142 @@ namespace pp {
 
             const auto iter = this->find(n);
             if (iter != this->end()) {
-                if (!Mode::get_value_from_result(iter->second(v, nb), b)) {
+                if (!Mode::get_value_from_result(iter->second(v, nb, counts), b)) {
                     return {};
                 }
             } else {
-                if (!Mode::get_value_from_result(
-                        skip_map<Mode>.at(to_wire_key(n))(nb), b)) {
+                if (!Mode::get_value_from_result(decode_skip_by_wire<Mode>(to_wire_key(n), nb), b)) {
                     return {};
                 }
+
+                if (record_unknown) {
+                    record_unknown(v, origin.first(begin_diff(b, origin)), counts);
+                }
             }
 
+            observation.finish(n, begin_diff(b, origin));
             return Mode::template make_result<message_decode_map_result<Mode>>(b, true);
         }
+
+        /// Clear fields which do not appear in the bytes, and drop elements which are not reused in repeated fields
+        static constexpr void finish(T& v, const std::size_t* counts) {
+            [&v, counts]<std::size_t... I>(std::index_sequence<I...>) {
+                ([&f = v.template get<field_lookup_number<F>>(), count = counts[I]] {
+                    if constexpr (is_singular(F::attr)) {
+                        if (count == 0) {
+                            f.reset();
+                        }
+                    } else if constexpr (has_reusable_elements<F>) {
+                        f.erase(f.begin() + count, f.end());
+                    } else if (count == 0) {
+                        f.clear();
+                    }
+                }(), ...);
+            }(std::index_sequence_for<F...>{});
+        }
     };
 
     template <coder_mode Mode, message_c T>
-    inline const message_decode_map<Mode, T> decode_map;
+    inline const message_decode_into_map<Mode, T> decode_into_map;
+
+    template <message_c>
+    struct message_repeated_reserver;
+
+    /// @brief Reserves containers of repeated fields of a message before decoding, used by `message_coder::reserve`
+    ///
+    /// Occurrences of every repeated field are counted in a pre-pass over the bytes, where only tags and lengths are touched,
+    /// except that values in packed ranges of a @ref countable_coder are counted by @ref encoded_count.
+    template <field_c... F>
+    struct message_repeated_reserver<message<F...>> {
+    private:
+        // the number of values in the packed range (with its length prefix) in `b`, which is checked later by skipping the range
+        template <countable_coder C>
+        static constexpr std::size_t packed_count(bytes b) {
+            decode_value<uint<8>> decode_len;
+            if (!safe_mode::get_value_from_result(varint_coder<uint<8>>::decode<safe_mode>(b), decode_len)) {
+                return 0;
+            }
+
+            const auto& [len, rest] = decode_len;
+            return encoded_count<C>(rest.first(std::min<std::size_t>(len, rest.size())));
+        }
+
+    public:
+        template <coder_mode Mode = safe_mode>
+        static constexpr decode_skip_result<Mode> reserve(message<F...>& v, bytes b) {
+            std::array<std::size_t, sizeof...(F)> counts{};
+
+            while(b.end() > b.begin()) {
+                decode_value<uint<4>> decode_key;
+                if (!Mode::get_value_from_result(varint_coder<uint<4>>::decode<Mode>(b), decode_key)) {
+                    return {};
+                }
+
+                const auto& [key, nb] = decode_key;
+                if (to_field_number(key) == 0) {
+                    break;
+                }
+
+                [&counts, key, nb]<std::size_t... I>(std::index_sequence<I...>) {
+                    (void)(([&counts, key, nb] {
+                        if constexpr (F::attr == repeated || F::attr == packed) {
+                            if (key == F::element_key) {
+                                ++counts[I];
+                                return true;
+                            }
+
+                            if constexpr (F::packable && countable_coder<typename F::coder>) {
+                                if (key == F::packed_key) {
+                                    counts[I] += packed_count<typename F::coder>(nb);
+                                    return true;
+                                }
+                            }
+                        }
+                        return false;
+                    }()) || ...);
+                }(std::index_sequence_for<F...>{});
+
+                if (!Mode::get_value_from_result(decode_skip_by_wire<Mode>(to_wire_key(key), nb), b)) {
+                    return {};
+                }
+            }
+
+            [&v, &counts]<std::size_t... I>(std::index_sequence<I...>) {
+                ([&f = v.template get<field_lookup_number<F>>(), count = counts[I]] {
+                    if constexpr (F::attr == repeated || F::attr == packed) {
+                        if (count > 0) {
+                            reserve_at_least(f.cast_to_base(), count);
+                        }
+                    }
+                }(), ...);
+            }(std::index_sequence_for<F...>{});
+
+            return Mode::template make_result<decode_skip_result<Mode>>(b);
+        }
+    };
+
+    /// @brief A tag to request a pre-pass which reserves containers of repeated fields exactly before decoding,
+    /// ref to `message_coder::reserve`
+    struct reserve_repeated_t {
+        explicit reserve_repeated_t() = default;
+    };
+
+    /// A value of @ref reserve_repeated_t, i.e. `message_coder<T>::decode(b, reserve_repeated)`
+    inline constexpr reserve_repeated_t reserve_repeated{};
+
+    template <coder_mode, message_c>
+    struct message_parallel_decoder;
+
+    /// Checks whether a field is a repeated length-delimited field whose elements can be encoded concurrently
+    template <field_c F>
+    constexpr inline bool is_parallel_encodable = false;
+
+    template <field_c F> requires (F::attr == repeated)
+    constexpr inline bool is_parallel_encodable<F> = wire_type<typename F::coder> == 2 &&
+        std::ranges::random_access_range<typename F::base_type>;
+
+    /// The minimum number of elements of a repeated field encoded by an @ref executor, where smaller fields are encoded sequentially
+    inline constexpr std::size_t min_parallel_encode_elements = 64;
 
     /// A @ref coder for @ref message type
     template <message_c T>
@@ -374,49 +784,264 @@ namespace pp {
 
         message_coder() = delete;
 
+        /// @brief Encode a field (with its key) of the message, an empty field is encoded into nothing
+        ///
+        /// The field is observed as a field of `Observed`, i.e. of another message type storing the same fields (ref to @ref observed_mode).
+        template <coder_mode Mode = safe_mode, field_c F, typename Observed = T>
+        static constexpr encode_result<Mode> encode_field(const F& f, bytes b) {
+            encode_result<Mode> result{b};
+            if(empty_field(f)) {
+                return result;
+            }
+
+            [[maybe_unused]] const bytes origin = b;
+            if constexpr (F::attr == oneof) {
+                result = encode_oneof_member<Mode, Observed>(f, b, std::make_index_sequence<F::size>{});
+            } else if constexpr (F::attr == unknown) {
+                const field_observation<Mode, Observed> observation(coder_direction::encode);
+                result = encode_unknown_fields<Mode>(f, b);
+                observation.finish(0, origin, result);
+            } else if constexpr (is_singular(F::attr)) {
+                const field_observation<Mode, Observed> observation(coder_direction::encode);
+                result = varint_coder<uint<4>>::encode<Mode>(F::key, b);
+                if (Mode::get_value_from_result(result, b)) {
+                    result = F::coder::template encode<Mode>(f.value(), b);
+                }
+                observation.finish(F::key, origin, result);
+            } else if constexpr (F::attr == packed) {
+                const field_observation<Mode, Observed> observation(coder_direction::encode);
+                result = varint_coder<uint<4>>::encode<Mode>(F::key, b);
+                if (Mode::get_value_from_result(result, b)) {
+                    result = array_coder<typename F::coder, typename F::base_type>::template encode<Mode>(f.cast_to_base(), b);
+                }
+                observation.finish(F::key, origin, result);
+            } else {
+                // every element is observed as a field, as it is decoded
+                for(const auto &i : f) {
+                    const bytes element = b;
+                    const field_observation<Mode, Observed> element_observation(coder_direction::encode);
+                    result = varint_coder<uint<4>>::encode<Mode>(F::key, b);
+                    if (Mode::get_value_from_result(result, b)) {
+                        result = F::coder::template encode<Mode>(i, b);
+                        if (!Mode::get_value_from_result(result, b)) {
+                            break;
+                        }
+                        element_observation.finish(F::key, begin_diff(b, element));
+                    } else {
+                        break;
+                    }
+                }
+            }
+
+            return result;
+        }
+
+    private:
+        // Recorded unknown fields are encoded as they are, by a single copy per run
+        template <coder_mode Mode, field_c F>
+        static constexpr encode_result<Mode> encode_unknown_fields(const F& f, bytes b) {
+            bool fit = true;
+            f.for_each_run([&fit, &b](std::span<const std::byte> run) {
+                if (fit && (fit = Mode::check_bytes_span(b, run.size()))) {
+                    std::memcpy(b.data(), run.data(), run.size());
+                    b = b.subspan(run.size());
+                }
+            });
+
+            if (!fit) {
+                return {};
+            }
+            return encode_result<Mode>{b};
+        }
+
+        // Only the member which is set (ref to `oneof_field::index`) is encoded
+        template <coder_mode Mode, typename Observed, field_c F, std::size_t... I>
+        static constexpr encode_result<Mode> encode_oneof_member(const F& f, bytes b, std::index_sequence<I...>) {
+            encode_result<Mode> result{b};
+            (void)((f.index() == I + 1 && ([&result, &f, b]() mutable {
+                using G = typename F::template member<I>;
+                const bytes origin = b;
+                const field_observation<Mode, Observed> observation(coder_direction::encode);
+                result = varint_coder<uint<4>>::encode<Mode>(G::key, b);
+                if (Mode::get_value_from_result(result, b)) {
+                    result = G::coder::template encode<Mode>(std::get<I + 1>(f.cast_to_base()), b);
+                }
+                observation.finish(G::key, origin, result);
+            }(), true)) || ...);
+
+            return result;
+        }
+
+    public:
+        /// @brief Encode a repeated field (with its keys) of the message, where elements are encoded by the @ref executor `exec`
+        ///
+        /// Encoded sizes of the elements are computed concurrently and prefix-summed into output offsets,
+        /// then every chunk of elements is encoded into its own disjoint slice of `b` concurrently.
+        /// Fields with fewer than `min_parallel_encode_elements` elements are encoded sequentially instead,
+        /// as are all fields if `Mode` tracks nesting of fields (ref to @ref is_nesting_observed).
+        template <coder_mode Mode = safe_mode, field_c F>
+        static encode_result<Mode> encode_field(const F& f, bytes b, executor auto& exec) {
+            constexpr std::size_t key_size = skipper<varint_coder<uint<4>>>::encode_skip(F::key);
+            const std::size_t n = std::ranges::size(f);
+            if (is_nesting_observed<Mode> || n < min_parallel_encode_elements) {
+                return encode_field<Mode>(f, b);
+            }
+
+            std::vector<std::size_t> offsets(n + 1);
+            exec.parallel_for(n, [&f, &offsets](std::size_t begin, std::size_t end) {
+                for (std::size_t i = begin; i < end; ++i) {
+                    offsets[i + 1] = key_size + skipper<typename F::coder>::encode_skip(f[i]);
+                }
+            });
+
+            for (std::size_t i = 0; i < n; ++i) {
+                offsets[i + 1] += offsets[i];
+            }
+
+            if (!Mode::check_bytes_span(b, offsets[n])) {
+                return {};
+            }
+
+            shared_coder_error error;
+            exec.parallel_for(n, [&f, &offsets, &error, b](std::size_t begin, std::size_t end) {
+                bytes slice = b.subspan(offsets[begin], offsets[end] - offsets[begin]);
+                for (std::size_t i = begin; i < end; ++i) {
+                    const field_observation<Mode, T> observation(coder_direction::encode);
+                    if (!Mode::get_value_from_result(varint_coder<uint<4>>::encode<Mode>(F::key, slice), slice) ||
+                        !Mode::get_value_from_result(F::coder::template encode<Mode>(f[i], slice), slice)) {
+                        error.fail();
+                        return;
+                    }
+                    observation.finish(F::key, offsets[i + 1] - offsets[i]);
+                }
+            });
+
+            if (error.restore()) {
+                return {};
+            }
+
+            return encode_result<Mode>{b.subspan(offsets[n])};
+        }
+
         template <coder_mode Mode = safe_mode>
         static constexpr encode_result<Mode> encode(const T& msg, bytes b) {
+            clear_coder_error<Mode>();
+
             encode_result<Mode> result{b};
             msg.for_each([&result]<field_c F> (const F& f) {
-                if(empty_field(f)) {
-                    return;
-                }
-
                 bytes safe_b;
-                if (!Mode::get_value_from_result(result, safe_b)) {
-                    return;
+                if (Mode::get_value_from_result(result, safe_b)) {
+                    result = encode_field<Mode>(f, safe_b);
                 }
+            });
 
-                if constexpr (F::attr == singular) {
-                    result = varint_coder<uint<4>>::encode<Mode>(F::key, safe_b);
-                    if (Mode::get_value_from_result(result, safe_b)) {
-                        result = F::coder::template encode<Mode>(f.value(), safe_b);
-                    }
-                } else {
-                    for(const auto &i : f) {
-                        result = varint_coder<uint<4>>::encode<Mode>(F::key, safe_b);
-                        if (Mode::get_value_from_result(result, safe_b)) {
-                            result = F::coder::template encode<Mode>(i, safe_b);
-                            if (!Mode::get_value_from_result(result, safe_b)) {
-                                break;
-                            }
-                        } else {
-                            break;
-                        }
+            return result;
+        }
+
+        /// @brief Encode a message, where elements of large repeated fields are encoded by the @ref executor `exec`
+        ///
+        /// It is applied to repeated fields of the outermost message, whose container is a random access range,
+        /// and whose elements are length-delimited (i.e. strings and embedded messages).
+        template <coder_mode Mode = safe_mode, executor E>
+        static encode_result<Mode> encode(const T& msg, bytes b, E& exec) {
+            clear_coder_error<Mode>();
+
+            encode_result<Mode> result{b};
+            msg.for_each([&result, &exec]<field_c F> (const F& f) {
+                bytes safe_b;
+                if (Mode::get_value_from_result(result, safe_b)) {
+                    if constexpr (is_parallel_encodable<F>) {
+                        result = encode_field<Mode>(f, safe_b, exec);
+                    } else {
+                        result = encode_field<Mode>(f, safe_b);
                     }
                 }
             });
 
             return result;
         }
-        
+
+    private:
+        template <coder_mode Mode>
+        static constexpr decode_to_result<Mode> decode_fields(T& v, bytes b) {
+            while(b.end() > b.begin()) {
+                std::pair<bytes, bool> bytes_with_next;
+                if (!Mode::get_value_from_result(decode_map<Mode, T>.decode(v, b), bytes_with_next)) {
+                    return {};
+                }
+
+                bool next = true;
+                std::tie(b, next) = bytes_with_next;
+
+                if(!next) break;
+            }
+
+            return Mode::template make_result<decode_to_result<Mode>>(b);
+        }
+
+    public:
         template <coder_mode Mode = safe_mode>
         static constexpr decode_result<T, Mode> decode(bytes b) {
+            clear_coder_error<Mode>();
+
             T v;
 
+            if (!Mode::get_value_from_result(decode_fields<Mode>(v, b), b)) {
+                return {};
+            }
+
+            return Mode::template make_result<decode_result<T, Mode>>(std::move(v), b);
+        }
+
+        /// @brief Count occurrences of repeated fields of the outermost message in the bytes `b`,
+        /// and reserve their containers in `v` to the counts, so that decoding the bytes into `v` does not reallocate them
+        ///
+        /// Only tags and lengths of fields are touched, and containers without `reserve` (or bounded ones) are left as they are.
+        template <coder_mode Mode = safe_mode>
+        static constexpr decode_skip_result<Mode> reserve(T& v, bytes b) {
+            return message_repeated_reserver<T>::template reserve<Mode>(v, b);
+        }
+
+        /// Decode a message, where containers of repeated fields are reserved by a pre-pass before decoding, ref to `reserve`
+        template <coder_mode Mode = safe_mode>
+        static constexpr decode_result<T, Mode> decode(bytes b, reserve_repeated_t) {
+            clear_coder_error<Mode>();
+
+            T v;
+
+            bytes rest;
+            if (!Mode::get_value_from_result(reserve<Mode>(v, b), rest) ||
+                !Mode::get_value_from_result(decode_fields<Mode>(v, b), b)) {
+                return {};
+            }
+
+            return Mode::template make_result<decode_result<T, Mode>>(std::move(v), b);
+        }
+
+        /// @brief Decode a message, where allocator-aware containers (i.e. in fields of @ref pmr::field) are allocated from `resource`
+        ///
+        /// The resource is propagated to every nested message, so that the decoded message can be released at once with the resource
+        /// (i.e. `std::pmr::monotonic_buffer_resource`).
+        template <coder_mode Mode = safe_mode>
+        static decode_result<T, Mode> decode(bytes b, std::pmr::memory_resource* resource) {
+            memory_resource_scope scope(resource);
+            return decode<Mode>(b);
+        }
+
+        /// @brief Decode a message into the existing message `v`, reusing its strings, containers and nested messages
+        ///
+        /// After decoding, `v` is equal to the message returned by `decode`, while capacity allocated by `v` is kept,
+        /// so that decoding messages of similar shapes into the same object repeatedly does not allocate after warm-up.
+        /// `v` is left in a valid but unspecified state if decoding fails.
+        template <coder_mode Mode = safe_mode>
+        static constexpr decode_into_result<Mode> decode_into(T& v, bytes b) {
+            clear_coder_error<Mode>();
+
+            std::array<std::size_t, T::size> counts{};
+
             while(b.end() > b.begin()) {
                 std::pair<bytes, bool> bytes_with_next;
-                if (!Mode::get_value_from_result(decode_map<Mode, T>.decode(v, b), bytes_with_next)) {
+                if (!Mode::get_value_from_result(decode_into_map<Mode, T>.decode(v, b, counts.data()), bytes_with_next)) {
                     return {};
                 }
 
@@ -426,31 +1051,118 @@ namespace pp {
                 if(!next) break;
             }
 
-            return Mode::template make_result<decode_result<T, Mode>>(std::move(v), b);
+            decode_into_map<Mode, T>.finish(v, counts.data());
+            return Mode::template make_result<decode_into_result<Mode>>(b);
+        }
+
+        /// Decode a message into the existing message `v`, where containers of repeated fields are reserved by a pre-pass, ref to `reserve`
+        template <coder_mode Mode = safe_mode>
+        static constexpr decode_into_result<Mode> decode_into(T& v, bytes b, reserve_repeated_t) {
+            clear_coder_error<Mode>();
+
+            bytes rest;
+            if (!Mode::get_value_from_result(reserve<Mode>(v, b), rest)) {
+                return {};
+            }
+
+            return decode_into<Mode>(v, b);
+        }
+
+        /// Decode a message into the existing message `v` as an @ref in_place_decoder, ref to `decode_into`
+        template <coder_mode Mode = safe_mode>
+        static constexpr decode_to_result<Mode> decode_to(T& v, bytes b) {
+            return decode_into<Mode>(v, b);
+        }
+
+        /// @brief Decode a message, where elements of repeated embedded message fields are decoded by the @ref executor `exec`
+        ///
+        /// Boundaries of the elements are located by a sequential scan (only tags and length prefixes are touched),
+        /// then the elements are decoded concurrently into a pre-sized container, preserving their order.
+        /// It is only applied to fields of the outermost message, whose container supports `resize` and `operator[]`.
+        /// Inside a @ref memory_resource_scope, the elements are decoded in the calling thread instead,
+        /// since the resource may not be thread-safe. If `Mode` tracks nesting of fields (ref to @ref is_nesting_observed),
+        /// the message is decoded sequentially, so that the elements are observed under their fields in the calling thread.
+        template <coder_mode Mode = safe_mode, executor E>
+        static decode_result<T, Mode> decode(bytes b, E& exec) {
+            if constexpr (is_nesting_observed<Mode>) {
+                return decode<Mode>(b);
+            } else {
+                clear_coder_error<Mode>();
+
+                T v;
+
+                if (!Mode::get_value_from_result(message_parallel_decoder<Mode, T>::decode(v, b, exec), b)) {
+                    return {};
+                }
+
+                return Mode::template make_result<decode_result<T, Mode>>(std::move(v), b);
+            }
         }
     };
 
+    template <field_c F>
+    struct field_max_encoded_size;
+
+    template <field_c F> requires (is_singular(F::attr)) && bounded_coder<typename F::coder>
+    struct field_max_encoded_size<F> : std::integral_constant<std::size_t,
+        skipper<varint_coder<uint<4>>>::encode_skip(F::key) + max_encoded_size<typename F::coder>> {};
+
+    template <field_c F> requires (F::attr == repeated) && bounded_coder<typename F::coder> && bounded_range<typename F::base_type>
+    struct field_max_encoded_size<F> : std::integral_constant<std::size_t, F::base_type::static_capacity * 
+        (skipper<varint_coder<uint<4>>>::encode_skip(F::key) + max_encoded_size<typename F::coder>)> {};
+
+    template <field_c F> requires (F::attr == packed) && bounded_coder<array_coder<typename F::coder, typename F::base_type>>
+    struct field_max_encoded_size<F> : std::integral_constant<std::size_t,
+        skipper<varint_coder<uint<4>>>::encode_skip(F::key) + max_encoded_size<array_coder<typename F::coder, typename F::base_type>>> {};
+
+    template <basic_fixed_string S, field_c... F> requires (requires { field_max_encoded_size<F>::value; } && ...)
+    struct field_max_encoded_size<oneof_field<S, F...>> : std::integral_constant<std::size_t,
+        std::max({field_max_encoded_size<F>::value...})> {};
+
+    template <field_c... F> requires (requires { field_max_encoded_size<F>::value; } && ...)
+    struct max_encoded_size_impl<message_coder<message<F...>>> :
+        std::integral_constant<std::size_t, (field_max_encoded_size<F>::value + ... + 0)> {};
+
     template <message_c T>
     struct skipper<message_coder<T>> {
+        using coder = message_coder<T>;
         using value_type = T;
 
-        static constexpr std::size_t encode_skip(const T& msg) {
+        /// Get the encoded size of a field (with its key) of the message, an empty field is encoded into nothing
+        template <field_c F>
+        static constexpr std::size_t encode_skip_field(const F& f) {
             std::size_t n = 0;
-            msg.for_each([&n]<field_c F> (const F& f) {
-                if(empty_field(f)) {
-                    return;
-                }
-
+            if(empty_field(f)) {
+                return n;
+            }
 
-                if constexpr (F::attr == singular) {
+            if constexpr (F::attr == unknown) {
+                n += f.size();
+            } else if constexpr (F::attr == oneof) {
+                [&n, &f]<std::size_t... I>(std::index_sequence<I...>) {
+                    (void)((f.index() == I + 1 && (n += skipper<varint_coder<uint<4>>>::encode_skip(F::template member<I>::key) +
+                        skipper<typename F::template member<I>::coder>::encode_skip(std::get<I + 1>(f.cast_to_base())), true)) || ...);
+                }(std::make_index_sequence<F::size>{});
+            } else if constexpr (is_singular(F::attr)) {
+                n += skipper<varint_coder<uint<4>>>::encode_skip(F::key);
+                n += skipper<typename F::coder>::encode_skip(f.value());
+            } else if constexpr (F::attr == packed) {
+                n += skipper<varint_coder<uint<4>>>::encode_skip(F::key);
+                n += skipper<array_coder<typename F::coder, typename F::base_type>>::encode_skip(f.cast_to_base());
+            } else {
+                for(const auto &i : f) {
                     n += skipper<varint_coder<uint<4>>>::encode_skip(F::key);
-                    n += skipper<typename F::coder>::encode_skip(f.value());
-                } else {
-                    for(const auto &i : f) {
-                        n += skipper<varint_coder<uint<4>>>::encode_skip(F::key);
-                        n += skipper<typename F::coder>::encode_skip(i);
-                    }
+                    n += skipper<typename F::coder>::encode_skip(i);
                 }
+            }
+
+            return n;
+        }
+
+        static constexpr std::size_t encode_skip(const T& msg) {
+            std::size_t n = 0;
+            msg.for_each([&n]<field_c F> (const F& f) {
+                n += encode_skip_field(f);
             });
 
             return n;
@@ -504,10 +1216,38 @@ namespace pp {
 
             return Mode::template make_result<decode_result<T, Mode>>(std::move(v), b);
         }
+
+        /// Decode an embedded message into the existing message `v`, ref to `message_coder::decode_into`
+        template <coder_mode Mode = safe_mode>
+        static constexpr decode_into_result<Mode> decode_into(T& v, bytes b) {
+            decode_value<uint<8>> decode_len;
+            if (!Mode::get_value_from_result(varint_coder<uint<8>>::decode<Mode>(b), decode_len)) {
+                return {};
+            }
+
+            const auto& [len, rest] = decode_len;
+            if (!check_length<Mode>(rest, len)) {
+                return {};
+            }
+
+            bytes inner;
+            if (!Mode::get_value_from_result(message_coder<T>::template decode_into<Mode>(v, rest.subspan(0, len)), inner)) {
+                return {};
+            }
+
+            return Mode::template make_result<decode_into_result<Mode>>(rest.subspan(len));
+        }
+
+        /// Decode an embedded message into the existing message `v` as an @ref in_place_decoder, ref to `decode_into`
+        template <coder_mode Mode = safe_mode>
+        static constexpr decode_to_result<Mode> decode_to(T& v, bytes b) {
+            return decode_into<Mode>(v, b);
+        }
     };
 
     template <typename T>
     struct skipper<embedded_message_coder<T>> {
+        using coder = embedded_message_coder<T>;
         using value_type = T;
 
         static constexpr std::size_t encode_skip(const T& v) {
@@ -528,7 +1268,7 @@ namespace pp {
             uint<8> n = 0;
             std::tie(n, b) = decode_len;
 
-            if (!Mode::check_bytes_span(b, n)) {
+            if (!check_length<Mode>(b, n)) {
                 return {};
             }
 
@@ -536,12 +1276,155 @@ namespace pp {
         }
     };
 
+    template <message_c T> requires bounded_coder<message_coder<T>>
+    struct max_encoded_size_impl<embedded_message_coder<T>> : std::integral_constant<std::size_t,
+        skipper<varint_coder<uint<8>>>::encode_skip(max_encoded_size<message_coder<T>>) + max_encoded_size<message_coder<T>>> {};
+
     template <typename T>
     struct wire_type_impl<embedded_message_coder<T>> : std::integral_constant<uint<1>, 2> {};
 
+    template <typename>
+    struct embedded_message_type_impl;
+
+    template <message_c T>
+    struct embedded_message_type_impl<embedded_message_coder<T>> {
+        using type = T;
+    };
+
+    /// Get the message type from an @ref embedded_message_coder, i.e. `T` for `embedded_message_coder<T>`
+    template <typename C>
+    using embedded_message_type = typename embedded_message_type_impl<C>::type;
+
+    /// Checks whether a field is a repeated embedded message field whose elements can be decoded concurrently
+    template <field_c F>
+    constexpr inline bool is_parallel_decodable = F::attr == repeated &&
+        requires(typename F::base_type con) {
+            { con[0] } -> std::same_as<embedded_message_type<typename F::coder>&>;
+            con.resize(con.size());
+            con[0] = std::move(con[0]);
+        };
+
+    template <coder_mode Mode, field_c... F>
+    struct message_parallel_decoder<Mode, message<F...>> {
+    private:
+        using T = message<F...>;
+        using function_result = message_decode_map_function_result<Mode>;
+
+        template <field_c G>
+        static bool decode_elements(G& con, const std::vector<bytes>& elements, executor auto& exec) {
+            using U = embedded_message_type<typename G::coder>;
+
+            const auto origin_size = con.size();
+            if (!check_room<Mode>(con.cast_to_base(), elements.front(), elements.size())) {
+                return false;
+            }
+
+            con.resize(origin_size + elements.size());
+
+            shared_coder_error error;
+            auto decode_chunk = [&](std::size_t begin, std::size_t end) {
+                for (std::size_t i = begin; i < end; ++i) {
+                    bytes rest;
+                    if (!Mode::get_value_from_result(message_coder<U>::template decode_to<Mode>(con[origin_size + i], elements[i]), rest)) {
+                        error.fail();
+                        return;
+                    }
+                }
+            };
+
+            // the resource of a scope may not be thread-safe, so it is only used by the calling thread
+            if (memory_resource_scope::active()) {
+                decode_chunk(0, elements.size());
+            } else {
+                exec.parallel_for(elements.size(), decode_chunk);
+            }
+
+            return !error.restore();
+        }
+
+    public:
+        static function_result decode(T& v, bytes b, executor auto& exec) {
+            std::array<std::vector<bytes>, sizeof...(F)> elements;
+
+            while(b.end() > b.begin()) {
+                decode_value<uint<4>> decode_key;
+                if (!Mode::get_value_from_result(varint_coder<uint<4>>::decode<Mode>(b), decode_key)) {
+                    return {};
+                }
+
+                const auto& [n, nb] = decode_key;
+                if (to_field_number(n) == 0) {
+                    break;
+                }
+
+                std::size_t index = sizeof...(F);
+                [&n, &index]<std::size_t... I>(std::index_sequence<I...>) {
+                    (([&n, &index] {
+                        if constexpr (is_parallel_decodable<F>) {
+                            return n == F::key && (index = I, true);
+                        } else {
+                            return false;
+                        }
+                    }()) || ...);
+                }(std::index_sequence_for<F...>{});
+
+                if (index < sizeof...(F)) {
+                    const field_observation<Mode, T> observation(coder_direction::decode);
+                    decode_value<uint<8>> decode_len;
+                    if (!Mode::get_value_from_result(varint_coder<uint<8>>::decode<Mode>(nb), decode_len)) {
+                        return {};
+                    }
+
+                    const auto& [len, rest] = decode_len;
+                    if (!check_length<Mode>(rest, len)) {
+                        return {};
+                    }
+
+                    elements[index].push_back(rest.subspan(0, len));
+                    observation.finish(n, begin_diff(rest.subspan(len), b));
+                    b = rest.subspan(len);
+                } else {
+                    std::pair<bytes, bool> bytes_with_next;
+                    if (!Mode::get_value_from_result(decode_map<Mode, T>.decode(v, b), bytes_with_next)) {
+                        return {};
+                    }
+
+                    bool next = true;
+                    std::tie(b, next) = bytes_with_next;
+
+                    if(!next) break;
+                }
+            }
+
+            const bool decoded = [&v, &elements, &exec]<std::size_t... I>(std::index_sequence<I...>) {
+                return ([&v, &elements, &exec] {
+                    if constexpr (is_parallel_decodable<F>) {
+                        return elements[I].empty() || decode_elements<F>(v.template get<F::number>(), elements[I], exec);
+                    } else {
+                        return true;
+                    }
+                }() && ...);
+            }(std::index_sequence_for<F...>{});
+
+            if (!decoded) {
+                return {};
+            }
+
+            return function_result{b};
+        }
+    };
+
     /// Type alias for embedded message fields
     template <basic_fixed_string S, uint<4> N, typename T, attribute A = singular, typename Container = std::vector<T>>
     using message_field = field<S, N, embedded_message_coder<T>, A, Container>;
+
+    namespace pmr {
+
+        /// Type alias for embedded message fields using `std::pmr::vector` as the container of repeated messages
+        template <basic_fixed_string S, uint<4> N, typename T, attribute A = singular>
+        using message_field = field<S, N, embedded_message_coder<T>, A>;
+
+    }
 }
 
 #endif //PROTOPUF_MESSAGE_H
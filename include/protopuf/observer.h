@@ -0,0 +1,151 @@
+//   Copyright 2020-2021 PragmaTwice
+//
+//   Licensed under the Apache License, Version 2.0 (the "License");
+//   you may not use this file except in compliance with the License.
+//   You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the License is distributed on an "AS IS" BASIS,
+//   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//   See the License for the specific language governing permissions and
+//   limitations under the License.
+
+#ifndef PROTOPUF_OBSERVER_H
+#define PROTOPUF_OBSERVER_H
+
+#include <chrono>
+#include <cstdint>
+#include <type_traits>
+
+#include "byte.h"
+#include "coder_mode.h"
+#include "int.h"
+
+namespace pp {
+
+    /// Whether a field is encoded or decoded, ref to @ref field_event
+    enum class coder_direction : std::uint8_t {
+        encode,
+        decode
+    };
+
+    /// A field (with its key) which is encoded or decoded in a message, reported to the observer of @ref observed_mode
+    struct field_event {
+        coder_direction direction;
+
+        /// the field number, or 0 for recorded unknown fields which are encoded at once (ref to @ref unknown_fields_field)
+        uint<4> number;
+
+        uint<1> wire_type;
+
+        /// the number of bytes of the key and the value
+        std::size_t size;
+
+        /// the time spent on the key and the value, which is only measured if the observer is timed
+        std::chrono::nanoseconds duration{};
+    };
+
+    /// @brief A type with static member function `on_field<T>`, which is called with a @ref field_event
+    /// after every field of the message (or another type storing fields) `T` is encoded or decoded successfully
+    ///
+    /// Durations of fields are measured if the type has a static member `timed` which is true.
+    /// If the type has static member functions `enter(coder_direction)` and `leave(coder_direction)`,
+    /// they are called before coding every field and after it (whether it succeeds or not), i.e. to track nesting.
+    template <typename T>
+    concept coder_observer = requires(const field_event& e) {
+        T::template on_field<int>(e);
+    };
+
+    /// @brief A @ref coder_mode which works as `Base` does, and reports every encoded or decoded field to the @ref coder_observer `Observer`
+    ///
+    /// The observer is a compile-time policy: coding in other modes (which have no observer) does not touch any hook.
+    /// Coding by an @ref executor reports fields from several threads, so the observer should be thread-safe,
+    /// except that an observer tracking nesting is only called by the calling thread, ref to @ref is_nesting_observed.
+    template <coder_observer Observer, coder_mode Base = safe_mode>
+    struct observed_mode : Base {
+        using observer = Observer;
+    };
+
+    /// @brief Checks whether the observer of the @ref coder_mode `Mode` tracks nesting of fields (by `enter` and `leave`),
+    /// where fields are coded in the calling thread only, since nesting cannot be tracked across threads
+    template <typename Mode>
+    constexpr inline bool is_nesting_observed = requires(coder_direction d) {
+        Mode::observer::enter(d);
+        Mode::observer::leave(d);
+    };
+
+    /// @brief An observation of a field of the message `T` being coded in the @ref coder_mode `Mode`,
+    /// which starts at construction and is reported to the observer of `Mode` by `finish`
+    ///
+    /// It is empty and does nothing if `Mode` has no observer.
+    template <coder_mode Mode, typename T>
+    class field_observation {
+        static constexpr bool observed = requires { typename Mode::observer; };
+
+        static constexpr bool nested = is_nesting_observed<Mode>;
+
+        static constexpr bool timed = [] {
+            if constexpr (observed && requires { Mode::observer::timed; }) {
+                return bool(Mode::observer::timed);
+            } else {
+                return false;
+            }
+        }();
+
+    public:
+        constexpr explicit field_observation(coder_direction direction) {
+            if constexpr (observed) {
+                this->direction = direction;
+            }
+            if constexpr (nested) {
+                Mode::observer::enter(direction);
+            }
+            if constexpr (timed) {
+                start = std::chrono::steady_clock::now();
+            }
+        }
+
+        field_observation(const field_observation&) = delete;
+        field_observation& operator=(const field_observation&) = delete;
+
+        constexpr ~field_observation() requires (!nested) = default;
+
+        constexpr ~field_observation() requires nested {
+            Mode::observer::leave(direction);
+        }
+
+        /// Report the field with the key `key` whose key and value take `size` bytes
+        constexpr void finish(uint<4> key, std::size_t size) const {
+            if constexpr (observed) {
+                field_event e{direction, uint<4>(key >> 3), uint<1>(key & 0b111), size};
+                if constexpr (timed) {
+                    e.duration = std::chrono::steady_clock::now() - start;
+                }
+                Mode::observer::template on_field<T>(e);
+            }
+        }
+
+        /// Report the field with the key `key` encoded from `origin` if `result` succeeds, where `result` is only touched if observed
+        template <typename R>
+        constexpr void finish(uint<4> key, bytes origin, const R& result) const {
+            if constexpr (observed) {
+                bytes rest;
+                if (Mode::get_value_from_result(R(result), rest)) {
+                    finish(key, begin_diff(rest, origin));
+                }
+            }
+        }
+
+    private:
+        template <std::size_t>
+        struct none {};
+
+        [[no_unique_address]] std::conditional_t<observed, coder_direction, none<0>> direction{};
+        [[no_unique_address]] std::conditional_t<timed, std::chrono::steady_clock::time_point, none<1>> start{};
+    };
+
+}
+
+#endif //PROTOPUF_OBSERVER_H
@@ -0,0 +1,250 @@
+//   Copyright 2020-2021 PragmaTwice
+//
+//   Licensed under the Apache License, Version 2.0 (the "License");
+//   you may not use this file except in compliance with the License.
+//   You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the License is distributed on an "AS IS" BASIS,
+//   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//   See the License for the specific language governing permissions and
+//   limitations under the License.
+
+#ifndef PROTOPUF_PATH_H
+#define PROTOPUF_PATH_H
+
+#include "message.h"
+
+#include <string_view>
+
+namespace pp {
+
+    /// @brief A decoder which decodes a field value without allocation if possible, used in @ref field_type_path
+    ///
+    /// By default it is the same as the @ref coder `C`, except that:
+    /// - strings of 1-byte characters are decoded into `std::basic_string_view`,
+    /// - other ranges of 1-byte integers (i.e. bytes) are decoded into `std::span<const T>`,
+    /// - embedded messages are decoded into their @ref bytes (without the length prefix).
+    /// The views refer to the input bytes, so they are valid as long as the input bytes are valid.
+    template <coder C>
+    struct view_decoder {
+        using value_type = typename C::value_type;
+
+        template <coder_mode Mode = safe_mode>
+        static constexpr decode_result<value_type, Mode> decode(bytes b) {
+            return C::template decode<Mode>(b);
+        }
+    };
+
+    template <typename T, typename R> requires (sizeof(T) == 1)
+    struct view_decoder<array_coder<integer_coder<T>, R>> {
+        using value_type = std::conditional_t<std::is_same_v<R, std::basic_string<T>>, std::basic_string_view<T>, std::span<const T>>;
+
+        template <coder_mode Mode = safe_mode>
+        static constexpr decode_result<value_type, Mode> decode(bytes b) {
+            decode_value<uint<8>> decode_len;
+            if (!Mode::get_value_from_result(varint_coder<uint<8>>::decode<Mode>(b), decode_len)) {
+                return {};
+            }
+
+            const auto& [len, rest] = decode_len;
+            if (!check_length<Mode>(rest, len)) {
+                return {};
+            }
+
+            return Mode::template make_result<decode_result<value_type, Mode>>(
+                value_type(reinterpret_cast<const T*>(rest.data()), len), rest.subspan(len));
+        }
+    };
+
+    template <typename R>
+    struct view_decoder<utf8_string_coder<R>> {
+        using value_type = std::string_view;
+
+        template <coder_mode Mode = safe_mode>
+        static constexpr decode_result<value_type, Mode> decode(bytes b) {
+            decode_value<uint<8>> decode_len;
+            if (!Mode::get_value_from_result(varint_coder<uint<8>>::decode<Mode>(b), decode_len)) {
+                return {};
+            }
+
+            const auto& [len, rest] = decode_len;
+            if (!check_length<Mode>(rest, len)) {
+                return {};
+            }
+
+            if constexpr (!std::same_as<Mode, unsafe_mode>) {
+                if (!validate_utf8(rest.first(len))) {
+                    report_coder_error<Mode>(coder_error_code::invalid_utf8, rest.data());
+                    return {};
+                }
+            }
+
+            return Mode::template make_result<decode_result<value_type, Mode>>(
+                value_type(reinterpret_cast<const char*>(rest.data()), len), rest.subspan(len));
+        }
+    };
+
+    template <message_c T>
+    struct view_decoder<embedded_message_coder<T>> {
+        using value_type = bytes;
+
+        template <coder_mode Mode = safe_mode>
+        static constexpr decode_result<value_type, Mode> decode(bytes b) {
+            decode_value<uint<8>> decode_len;
+            if (!Mode::get_value_from_result(varint_coder<uint<8>>::decode<Mode>(b), decode_len)) {
+                return {};
+            }
+
+            const auto& [len, rest] = decode_len;
+            if (!check_length<Mode>(rest, len)) {
+                return {};
+            }
+
+            return Mode::template make_result<decode_result<value_type, Mode>>(rest.subspan(0, len), rest.subspan(len));
+        }
+    };
+
+    /// @brief A path over the field types `F...`, to extract values directly from encoded bytes without decoding the enclosing messages
+    ///
+    /// Every field except the last one should be an embedded message field, which the path descends into.
+    /// Repeated fields in the path are expanded, i.e. every element of them is visited (`students[*].id`).
+    template <field_c F, field_c... Fs>
+    struct field_type_path {
+        static_assert(sizeof...(Fs) == 0 || requires { typename embedded_message_type<typename F::coder>; },
+            "only the last field in a path can be a non-message field");
+
+    private:
+        // invoke `f` with every value in the packed values `b` (with the length prefix), ref to @ref packed
+        template <coder_mode Mode, typename Fn>
+        static constexpr decode_skip_result<Mode> extract_packed(bytes b, Fn& f) {
+            if constexpr (F::packable) {
+                decode_value<uint<8>> decode_len;
+                if (!Mode::get_value_from_result(varint_coder<uint<8>>::decode<Mode>(b), decode_len)) {
+                    return {};
+                }
+
+                const auto& [len, rest] = decode_len;
+                if (!check_length<Mode>(rest, len)) {
+                    return {};
+                }
+
+                bytes values = rest.subspan(0, len);
+                while(values.end() > values.begin()) {
+                    decode_value<typename F::coder::value_type> decode_v;
+                    if (!Mode::get_value_from_result(F::coder::template decode<Mode>(values), decode_v)) {
+                        return {};
+                    }
+
+                    f(std::move(decode_v.first));
+                    values = decode_v.second;
+                }
+
+                return Mode::template make_result<decode_skip_result<Mode>>(rest.subspan(len));
+            } else {
+                return {};
+            }
+        }
+
+    public:
+        /// @brief Walk through the encoded message `b`, and invoke `f` with every value (decoded by @ref view_decoder) found in the path
+        /// @returns the bytes which remains not walked through (as @ref message_coder does)
+        template <coder_mode Mode = safe_mode, typename Fn>
+        static constexpr decode_skip_result<Mode> extract(bytes b, Fn&& f) {
+            while(b.end() > b.begin()) {
+                decode_value<uint<4>> decode_key;
+                if (!Mode::get_value_from_result(varint_coder<uint<4>>::decode<Mode>(b), decode_key)) {
+                    return {};
+                }
+
+                const auto& [key, nb] = decode_key;
+                if (to_field_number(key) == 0) {
+                    break;
+                }
+
+                if (key == F::element_key) {
+                    decode_value<typename view_decoder<typename F::coder>::value_type> decode_v;
+                    if (!Mode::get_value_from_result(view_decoder<typename F::coder>::template decode<Mode>(nb), decode_v)) {
+                        return {};
+                    }
+
+                    if constexpr (sizeof...(Fs) == 0) {
+                        f(std::move(decode_v.first));
+                    } else {
+                        bytes inner;
+                        if (!Mode::get_value_from_result(field_type_path<Fs...>::template extract<Mode>(decode_v.first, f), inner)) {
+                            return {};
+                        }
+                    }
+
+                    b = decode_v.second;
+                } else if (F::packable && key == F::packed_key) {
+                    if (!Mode::get_value_from_result(extract_packed<Mode>(nb, f), b)) {
+                        return {};
+                    }
+                } else {
+                    if (!Mode::get_value_from_result(decode_skip_by_wire<Mode>(to_wire_key(key), nb), b)) {
+                        return {};
+                    }
+                }
+            }
+
+            return Mode::template make_result<decode_skip_result<Mode>>(b);
+        }
+    };
+
+    template <field_c, typename>
+    struct field_type_path_prepend_impl;
+
+    template <field_c F, field_c... Fs>
+    struct field_type_path_prepend_impl<F, field_type_path<Fs...>> {
+        using type = field_type_path<F, Fs...>;
+    };
+
+    /// Prepend a field type `F` to a @ref field_type_path `P`
+    template <field_c F, typename P>
+    using field_type_path_prepend = typename field_type_path_prepend_impl<F, P>::type;
+
+    template <message_c T, basic_fixed_string... S>
+    struct field_name_path_impl;
+
+    template <message_c T, basic_fixed_string S>
+    struct field_name_path_impl<T, S> {
+        using type = field_type_path<typename T::template get_type_by_name<S>>;
+    };
+
+    template <message_c T, basic_fixed_string S1, basic_fixed_string S2, basic_fixed_string... Sn>
+    struct field_name_path_impl<T, S1, S2, Sn...> {
+        using head_field = typename T::template get_type_by_name<S1>;
+        using type = field_type_path_prepend<head_field, typename field_name_path_impl<embedded_message_type<typename head_field::coder>, S2, Sn...>::type>;
+    };
+
+    /// @brief A @ref field_type_path resolved by field names from the message `T`,
+    /// i.e. `field_name_path<Class, "students", "id">` as `students[*].id`
+    template <message_c T, basic_fixed_string... S>
+    using field_name_path = typename field_name_path_impl<T, S...>::type;
+
+    template <message_c T, uint<4>... N>
+    struct field_number_path_impl;
+
+    template <message_c T, uint<4> N>
+    struct field_number_path_impl<T, N> {
+        using type = field_type_path<typename T::template get_type_by_number<N>>;
+    };
+
+    template <message_c T, uint<4> N1, uint<4> N2, uint<4>... Nn>
+    struct field_number_path_impl<T, N1, N2, Nn...> {
+        using head_field = typename T::template get_type_by_number<N1>;
+        using type = field_type_path_prepend<head_field, typename field_number_path_impl<embedded_message_type<typename head_field::coder>, N2, Nn...>::type>;
+    };
+
+    /// @brief A @ref field_type_path resolved by field numbers from the message `T`,
+    /// i.e. `field_number_path<Class, 3, 1>` as `students[*].id` where `students = 3` and `id = 1`
+    template <message_c T, uint<4>... N>
+    using field_number_path = typename field_number_path_impl<T, N...>::type;
+
+}
+
+#endif //PROTOPUF_PATH_H
@@ -15,6 +15,8 @@
 #ifndef PROTOPUF_SKIP_H
 #define PROTOPUF_SKIP_H
 
+#include <algorithm>
+
 #include "coder.h"
 #include "int.h"
 #include "varint.h"
@@ -124,6 +126,16 @@ namespace pp {
 
         template <coder_mode Mode = safe_mode>
         static constexpr decode_skip_result<Mode> decode_skip(bytes b) {
+            // a varint in readable bytes is found with a single check, ref to @ref slop_mode
+            if (coder::template is_readable<Mode>(b)) {
+                T unused{};
+                const std::size_t size = coder::template decode_readable<Mode>(unused, b);
+                if (size == 0) {
+                    return {};
+                }
+                return Mode::template make_result<decode_skip_result<Mode>>(b.subspan(size));
+            }
+
             auto iter = b.begin();
             const auto end = b.end();
 
@@ -207,6 +219,93 @@ namespace pp {
         }
     };
 
+    /// @brief The implementations of @ref max_encoded_size, where `value` is the maximum encoded size of any value of the @ref coder `C`
+    ///
+    /// It is left undefined for coders whose encoded size is unbounded (i.e. `std::string`), ref to @ref bounded_coder.
+    template <coder C>
+    struct max_encoded_size_impl;
+
+    template <typename T>
+    struct max_encoded_size_impl<integer_coder<T>> : std::integral_constant<std::size_t, sizeof(T)> {};
+
+    template <typename T>
+    struct max_encoded_size_impl<float_coder<T>> : std::integral_constant<std::size_t, sizeof(T)> {};
+
+    template <std::unsigned_integral T>
+    struct max_encoded_size_impl<varint_coder<T>> : std::integral_constant<std::size_t, (sizeof(T) * 8 + 6) / 7> {};
+
+    template <std::signed_integral T>
+    struct max_encoded_size_impl<varint_coder<T>> : max_encoded_size_impl<varint_coder<std::make_unsigned_t<T>>> {};
+
+    template <std::size_t N>
+    struct max_encoded_size_impl<varint_coder<sint_zigzag<N>>> : max_encoded_size_impl<varint_coder<uint<N>>> {};
+
+    template <>
+    struct max_encoded_size_impl<bool_coder> : std::integral_constant<std::size_t, 1> {};
+
+    template <typename T>
+    struct max_encoded_size_impl<enum_coder<T>> : max_encoded_size_impl<varint_coder<std::underlying_type_t<T>>> {};
+
+    /// A concept satisfied while the encoded size of any value of the @ref coder `C` is bounded, ref to @ref max_encoded_size
+    template <typename C>
+    concept bounded_coder = coder<C> && requires {
+        { max_encoded_size_impl<C>::value } -> std::convertible_to<std::size_t>;
+    };
+
+    /// @brief The maximum encoded size of any value of the @ref bounded_coder `C`,
+    /// i.e. a buffer with this size is always enough to encode a value of `C`
+    template <bounded_coder C>
+    constexpr inline std::size_t max_encoded_size = max_encoded_size_impl<C>::value;
+
+    /// @brief The implementations of @ref encoded_count, where `count(b)` is the number of values of the @ref coder `C`
+    /// encoded back to back in the bytes `b`
+    ///
+    /// It is left undefined for coders whose values cannot be counted without decoding them (i.e. `std::string`).
+    template <coder C>
+    struct encoded_count_impl;
+
+    template <std::size_t N>
+    struct fixed_encoded_count {
+        static constexpr std::size_t count(bytes b) {
+            return b.size() / N;
+        }
+    };
+
+    struct varint_encoded_count {
+        static constexpr std::size_t count(bytes b) {
+            // every varint ends with the only byte whose most significant bit is clear
+            return static_cast<std::size_t>(std::ranges::count_if(b, [](std::byte x) { return (x >> 7) == 0_b; }));
+        }
+    };
+
+    template <typename T>
+    struct encoded_count_impl<integer_coder<T>> : fixed_encoded_count<sizeof(T)> {};
+
+    template <typename T>
+    struct encoded_count_impl<float_coder<T>> : fixed_encoded_count<sizeof(T)> {};
+
+    template <>
+    struct encoded_count_impl<bool_coder> : fixed_encoded_count<1> {};
+
+    template <typename T>
+    struct encoded_count_impl<varint_coder<T>> : varint_encoded_count {};
+
+    template <typename T>
+    struct encoded_count_impl<enum_coder<T>> : varint_encoded_count {};
+
+    /// A concept satisfied while values of the @ref coder `C` can be counted without decoding them, ref to @ref encoded_count
+    template <typename C>
+    concept countable_coder = coder<C> && requires(bytes b) {
+        { encoded_count_impl<C>::count(b) } -> std::same_as<std::size_t>;
+    };
+
+    /// @brief The number of values of the @ref countable_coder `C` encoded back to back in the bytes `b`,
+    /// which only touches the bytes (i.e. the last byte of every varint) instead of decoding the values
+    template <countable_coder C>
+    constexpr std::size_t encoded_count(bytes b) {
+        return encoded_count_impl<C>::count(b);
+    }
+
 }
 
 #endif //PROTOPUF_SKIP_H
@@ -0,0 +1,342 @@
+//   Copyright 2020-2021 PragmaTwice
+//
+//   Licensed under the Apache License, Version 2.0 (the "License");
+//   you may not use this file except in compliance with the License.
+//   You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the License is distributed on an "AS IS" BASIS,
+//   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//   See the License for the specific language governing permissions and
+//   limitations under the License.
+
+#ifndef PROTOPUF_SMALL_VECTOR_H
+#define PROTOPUF_SMALL_VECTOR_H
+
+#include <algorithm>
+#include <cstddef>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+namespace pp {
+
+    template <std::size_t N, bool Bounded>
+    struct inline_vector_capacity {};
+
+    template <std::size_t N>
+    struct inline_vector_capacity<N, true> {
+        /// the maximum number of elements, ref to @ref bounded_range
+        static constexpr std::size_t static_capacity = N;
+    };
+
+    /// @brief A contiguous container storing up to `N` elements in place
+    ///
+    /// If `Bounded` is false, elements are moved to the heap while the size grows beyond `N`;
+    /// otherwise, it throws `std::length_error` instead, and the capacity is exposed as `static_capacity`.
+    template <typename T, std::size_t N, bool Bounded>
+    class inline_vector : public inline_vector_capacity<N, Bounded> {
+        static_assert(N > 0, "the inline capacity should be positive");
+
+    public:
+        using value_type = T;
+        using size_type = std::size_t;
+        using difference_type = std::ptrdiff_t;
+        using reference = T&;
+        using const_reference = const T&;
+        using pointer = T*;
+        using const_pointer = const T*;
+        using iterator = T*;
+        using const_iterator = const T*;
+
+        inline_vector() = default;
+
+        inline_vector(std::initializer_list<T> list) {
+            assign(list.begin(), list.end());
+        }
+
+        template <std::input_iterator I, std::sentinel_for<I> S>
+        inline_vector(I first, S last) {
+            assign(first, last);
+        }
+
+        explicit inline_vector(size_type n) {
+            resize(n);
+        }
+
+        inline_vector(size_type n, const T& v) {
+            resize(n, v);
+        }
+
+        inline_vector(const inline_vector& other) {
+            assign(other.begin(), other.end());
+        }
+
+        inline_vector(inline_vector&& other) noexcept(std::is_nothrow_move_constructible_v<T>) {
+            take(std::move(other));
+        }
+
+        ~inline_vector() {
+            clear();
+            release();
+        }
+
+        inline_vector& operator=(const inline_vector& other) {
+            if (this != &other) {
+                assign(other.begin(), other.end());
+            }
+            return *this;
+        }
+
+        inline_vector& operator=(inline_vector&& other) noexcept(std::is_nothrow_move_constructible_v<T>) {
+            if (this != &other) {
+                clear();
+                release();
+                take(std::move(other));
+            }
+            return *this;
+        }
+
+        inline_vector& operator=(std::initializer_list<T> list) {
+            assign(list.begin(), list.end());
+            return *this;
+        }
+
+        template <std::input_iterator I, std::sentinel_for<I> S>
+        void assign(I first, S last) {
+            clear();
+            if constexpr (std::forward_iterator<I>) {
+                reserve(static_cast<size_type>(std::ranges::distance(first, last)));
+            }
+
+            for (; first != last; ++first) {
+                emplace_back(*first);
+            }
+        }
+
+        iterator begin() noexcept { return ptr; }
+        const_iterator begin() const noexcept { return ptr; }
+        const_iterator cbegin() const noexcept { return ptr; }
+        iterator end() noexcept { return ptr + count; }
+        const_iterator end() const noexcept { return ptr + count; }
+        const_iterator cend() const noexcept { return ptr + count; }
+
+        T* data() noexcept { return ptr; }
+        const T* data() const noexcept { return ptr; }
+
+        T& operator[](size_type i) { return ptr[i]; }
+        const T& operator[](size_type i) const { return ptr[i]; }
+
+        T& front() { return ptr[0]; }
+        const T& front() const { return ptr[0]; }
+        T& back() { return ptr[count - 1]; }
+        const T& back() const { return ptr[count - 1]; }
+
+        size_type size() const noexcept { return count; }
+        bool empty() const noexcept { return count == 0; }
+        size_type capacity() const noexcept { return cap; }
+
+        /// whether the elements are stored in place (i.e. without heap allocation)
+        bool is_inline() const noexcept { return ptr == inline_data(); }
+
+        void reserve(size_type n) {
+            if (n > cap) {
+                grow(n);
+            }
+        }
+
+        template <typename... Args>
+        T& emplace_back(Args&&... args) {
+            if (count < cap) {
+                std::construct_at(ptr + count, std::forward<Args>(args)...);
+            } else if constexpr (Bounded) {
+                grow(count + 1);
+            } else {
+                // construct the new element before moving the old ones, since `args` may refer to them
+                const size_type n = cap * 2;
+                T* p = std::allocator<T>().allocate(n);
+                std::construct_at(p + count, std::forward<Args>(args)...);
+                relocate(p, n);
+            }
+
+            return ptr[count++];
+        }
+
+        void push_back(const T& v) { emplace_back(v); }
+        void push_back(T&& v) { emplace_back(std::move(v)); }
+
+        void pop_back() {
+            std::destroy_at(ptr + --count);
+        }
+
+        iterator insert(const_iterator pos, const T& v) { return emplace(pos, v); }
+        iterator insert(const_iterator pos, T&& v) { return emplace(pos, std::move(v)); }
+
+        template <typename... Args>
+        iterator emplace(const_iterator pos, Args&&... args) {
+            const auto i = static_cast<size_type>(pos - ptr);
+            emplace_back(std::forward<Args>(args)...);
+            std::rotate(ptr + i, ptr + count - 1, ptr + count);
+            return ptr + i;
+        }
+
+        iterator erase(const_iterator first, const_iterator last) {
+            const auto i = first - cbegin(), n = last - first;
+            std::move(ptr + i + n, ptr + count, ptr + i);
+            std::destroy(ptr + count - n, ptr + count);
+            count -= n;
+            return ptr + i;
+        }
+
+        iterator erase(const_iterator pos) {
+            return erase(pos, pos + 1);
+        }
+
+        void resize(size_type n) {
+            resize_with(n, [this] { std::construct_at(ptr + count); });
+        }
+
+        void resize(size_type n, const T& v) {
+            resize_with(n, [this, &v] { std::construct_at(ptr + count, v); });
+        }
+
+        void clear() noexcept {
+            std::destroy(ptr, ptr + count);
+            count = 0;
+        }
+
+        friend bool operator==(const inline_vector& l, const inline_vector& r) {
+            return std::equal(l.begin(), l.end(), r.begin(), r.end());
+        }
+
+    private:
+        T* inline_data() noexcept { return reinterpret_cast<T*>(storage); }
+        const T* inline_data() const noexcept { return reinterpret_cast<const T*>(storage); }
+
+        void grow(size_type n) {
+            if constexpr (Bounded) {
+                if (n > N) {
+                    throw std::length_error("the capacity of pp::static_vector is exceeded");
+                }
+            } else {
+                n = std::max(n, cap * 2);
+                relocate(std::allocator<T>().allocate(n), n);
+            }
+        }
+
+        // move the elements into the heap storage `p` with capacity `n`
+        void relocate(T* p, size_type n) {
+            std::uninitialized_move(ptr, ptr + count, p);
+            std::destroy(ptr, ptr + count);
+            release();
+            ptr = p, cap = n;
+        }
+
+        void release() noexcept {
+            if (!is_inline()) {
+                std::allocator<T>().deallocate(ptr, cap);
+                ptr = inline_data(), cap = N;
+            }
+        }
+
+        // move the elements of `other` into this empty vector
+        void take(inline_vector&& other) {
+            if (other.is_inline()) {
+                std::uninitialized_move(other.begin(), other.end(), ptr);
+                count = other.count;
+                other.clear();
+            } else {
+                ptr = std::exchange(other.ptr, other.inline_data());
+                cap = std::exchange(other.cap, N);
+                count = std::exchange(other.count, 0);
+            }
+        }
+
+        template <typename F>
+        void resize_with(size_type n, F&& construct_one) {
+            if (n < count) {
+                std::destroy(ptr + n, ptr + count);
+                count = n;
+                return;
+            }
+
+            reserve(n);
+            while (count < n) {
+                construct_one();
+                ++count;
+            }
+        }
+
+        alignas(T) std::byte storage[N * sizeof(T)];
+        T* ptr = inline_data();
+        size_type count = 0;
+        size_type cap = N;
+    };
+
+    /// @brief A vector storing up to `N` elements in place, and moving them to the heap while growing beyond `N`
+    ///
+    /// It can be used as the container of @ref repeated fields which usually hold few elements, i.e.
+    /// `uint32_field<"ids", 1, repeated, small_vector<uint32, 4>>`.
+    template <typename T, std::size_t N>
+    using small_vector = inline_vector<T, N, false>;
+
+    /// @brief A vector storing at most `N` elements in place, which never allocates
+    ///
+    /// It is a @ref bounded_range, so that its encoded size can be bounded (ref to @ref max_encoded_size),
+    /// and decoding a field with more than `N` elements into it fails.
+    template <typename T, std::size_t N>
+    using static_vector = inline_vector<T, N, true>;
+
+    /// @brief A string storing at most `N` characters in place, which never allocates, ref to @ref static_vector
+    template <typename T, std::size_t N>
+    class basic_inline_string : public static_vector<T, N> {
+        using base_type = static_vector<T, N>;
+
+    public:
+        using base_type::base_type;
+
+        basic_inline_string() = default;
+
+        basic_inline_string(std::basic_string_view<T> s) : base_type(s.begin(), s.end()) {}
+
+        basic_inline_string(const T* s) : basic_inline_string(std::basic_string_view<T>(s)) {}
+
+        std::size_t length() const noexcept {
+            return this->size();
+        }
+
+        std::basic_string_view<T> view() const noexcept {
+            return {this->data(), this->size()};
+        }
+
+        operator std::basic_string_view<T>() const noexcept {
+            return view();
+        }
+
+        friend bool operator==(const basic_inline_string& l, const basic_inline_string& r) {
+            return l.view() == r.view();
+        }
+
+        friend bool operator==(const basic_inline_string& l, std::basic_string_view<T> r) {
+            return l.view() == r;
+        }
+
+        friend bool operator==(const basic_inline_string& l, const T* r) {
+            return l.view() == r;
+        }
+    };
+
+    /// Type alias for a string of `char` storing at most `N` characters in place, ref to @ref basic_inline_string
+    template <std::size_t N>
+    using inline_string = basic_inline_string<char, N>;
+
+}
+
+#endif //PROTOPUF_SMALL_VECTOR_H
@@ -0,0 +1,550 @@
+//   Copyright 2020-2021 PragmaTwice
+//
+//   Licensed under the Apache License, Version 2.0 (the "License");
+//   you may not use this file except in compliance with the License.
+//   You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the License is distributed on an "AS IS" BASIS,
+//   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//   See the License for the specific language governing permissions and
+//   limitations under the License.
+
+#ifndef PROTOPUF_SOA_VECTOR_H
+#define PROTOPUF_SOA_VECTOR_H
+
+#include "compact_message.h"
+
+#include <bit>
+#include <compare>
+#include <initializer_list>
+#include <iterator>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace pp {
+
+    /// @brief A column of the field `F` in a @ref soa_vector, which stores the field of every row contiguously
+    ///
+    /// Fields except @ref singular ones are stored as they are in @ref message.
+    template <field_c F>
+    struct soa_column {
+        using value_type = F;
+
+        /// the field in every row
+        std::vector<F> values;
+
+        void emplace_back() {
+            values.emplace_back();
+        }
+
+        void pop_back() {
+            values.pop_back();
+        }
+
+        void reserve(std::size_t n) {
+            values.reserve(n);
+        }
+
+        void clear() {
+            values.clear();
+        }
+
+        void swap_rows(std::size_t i, std::size_t j) {
+            std::swap(values[i], values[j]);
+        }
+    };
+
+    /// @brief A column of the @ref singular field `F` in a @ref soa_vector, where values are stored unwrapped with a presence bitmap
+    ///
+    /// The `i % 64`-th bit of the `i / 64`-th word in `presence` is set if the field is present in the `i`-th row,
+    /// while values in rows without the field are unspecified.
+    template <field_c F> requires (F::attr == singular)
+    struct soa_column<F> {
+        using value_type = typename F::coder::value_type;
+
+        using word_type = uint<8>;
+
+        static constexpr std::size_t word_bits = 64;
+
+        /// the value of the field in every row
+        std::vector<value_type> values;
+
+        /// the presence bitmap of the field
+        std::vector<word_type> presence;
+
+        /// whether the field is present in the `i`-th row
+        bool has_value(std::size_t i) const {
+            return (presence[i / word_bits] >> (i % word_bits)) & 1u;
+        }
+
+        /// the number of rows where the field is present
+        std::size_t present_count() const {
+            std::size_t n = 0;
+            for (auto w : presence) {
+                n += std::popcount(w);
+            }
+            return n;
+        }
+
+        void set_present(std::size_t i) {
+            presence[i / word_bits] |= mask(i);
+        }
+
+        void reset(std::size_t i) {
+            presence[i / word_bits] &= ~mask(i);
+        }
+
+        void emplace_back() {
+            if (values.size() % word_bits == 0) {
+                presence.push_back(0);
+            }
+            values.push_back(make_value<value_type>());
+        }
+
+        // bits after the last row are kept cleared, so that a new row is absent
+        void pop_back() {
+            values.pop_back();
+            reset(values.size());
+            if (values.size() % word_bits == 0) {
+                presence.pop_back();
+            }
+        }
+
+        void reserve(std::size_t n) {
+            values.reserve(n);
+            presence.reserve((n + word_bits - 1) / word_bits);
+        }
+
+        void clear() {
+            values.clear();
+            presence.clear();
+        }
+
+        void swap_rows(std::size_t i, std::size_t j) {
+            std::swap(values[i], values[j]);
+
+            const bool has_i = has_value(i), has_j = has_value(j);
+            has_j ? set_present(i) : reset(i);
+            has_i ? set_present(j) : reset(j);
+        }
+
+        static constexpr word_type mask(std::size_t i) {
+            return word_type(1) << (i % word_bits);
+        }
+    };
+
+    template <coder_mode, typename>
+    struct soa_vector_decode_map;
+
+    template <typename>
+    class soa_vector;
+
+    /// @brief A container of messages in struct-of-arrays layout, i.e. every field is stored in its own @ref soa_column
+    ///
+    /// It can be used as the container of @ref repeated embedded message fields, i.e.
+    /// `message_field<"rows", 1, Row, repeated, soa_vector<Row>>`, so that scanning a field across rows touches contiguous memory.
+    /// Embedded messages are decoded directly into the columns (ref to @ref self_decoding_container),
+    /// and rows are accessed by proxies, i.e. `rows[i]["id"_f]` (ref to `row_reference`) which are converted to messages on demand,
+    /// i.e. while encoding.
+    template <field_c... F>
+    class soa_vector<message<F...>> {
+        using columns_type = std::tuple<soa_column<F>...>;
+
+        template <std::size_t I>
+        using field_at = std::tuple_element_t<I, std::tuple<F...>>;
+
+    public:
+        using value_type = message<F...>;
+        using size_type = std::size_t;
+        using difference_type = std::ptrdiff_t;
+
+        /// @brief A reference to a row of @ref soa_vector, with the field accessors of @ref message
+        ///
+        /// A @ref singular field is returned as @ref compact_field_ref referring to the value and the presence bit in its column,
+        /// and other fields are returned as references to the fields in their columns.
+        template <bool Const>
+        class row_reference {
+            using vector_type = std::conditional_t<Const, const soa_vector, soa_vector>;
+
+        public:
+            constexpr row_reference(vector_type& v, size_type i) : v(&v), i(i) {}
+
+            constexpr row_reference(const row_reference&) = default;
+
+            /// assign the fields of another row
+            constexpr row_reference& operator=(const row_reference& other) requires (!Const) {
+                return *this = value_type(other);
+            }
+
+            /// assign the fields of a message
+            constexpr row_reference& operator=(const value_type& msg) requires (!Const) {
+                [this, &msg]<std::size_t... I>(std::index_sequence<I...>) {
+                    ([this, &msg] {
+                        const auto& f = msg.template get<field_lookup_number<F>>();
+                        if constexpr (F::attr == singular) {
+                            get_by_index<I>() = f.cast_to_base();
+                        } else {
+                            get_by_index<I>() = f;
+                        }
+                    }(), ...);
+                }(std::index_sequence_for<F...>{});
+                return *this;
+            }
+
+            /// the index of the row
+            constexpr size_type index() const {
+                return i;
+            }
+
+            /// get a field by the field number
+            template <uint<4> N>
+            constexpr decltype(auto) get() const {
+                static_assert(field_number_index<N, F...> < sizeof...(F), "field not found");
+                return get_by_index<field_number_index<N, F...>>();
+            }
+
+            /// get a field by the field name
+            template <basic_fixed_string S>
+            constexpr decltype(auto) get() const {
+                static_assert(field_name_index<S, F...> < sizeof...(F), "field not found");
+                return get_by_index<field_name_index<S, F...>>();
+            }
+
+            /// get a field by the field number, i.e. `row[233_i]`
+            template <uint<4> N>
+            constexpr decltype(auto) operator[](std::integral_constant<uint<4>, N>) const {
+                return get<N>();
+            }
+
+            /// get a field by the field name, i.e. `row["a"_f]`
+            template <basic_fixed_string S>
+            constexpr decltype(auto) operator[](constant<S>) const {
+                return get<S>();
+            }
+
+            /// copy the fields of the row into a message
+            constexpr operator value_type() const {
+                value_type msg;
+                [this, &msg]<std::size_t... I>(std::index_sequence<I...>) {
+                    ([this, &msg] {
+                        auto& f = msg.template get<field_lookup_number<F>>();
+                        if constexpr (F::attr == singular) {
+                            if (const auto r = get_by_index<I>(); r.has_value()) {
+                                f.emplace(*r);
+                            }
+                        } else {
+                            f = get_by_index<I>();
+                        }
+                    }(), ...);
+                }(std::index_sequence_for<F...>{});
+                return msg;
+            }
+
+            template <bool C>
+            friend constexpr bool operator==(const row_reference& l, const row_reference<C>& r) {
+                return [&l, &r]<std::size_t... I>(std::index_sequence<I...>) {
+                    return ([&l, &r] {
+                        if constexpr (F::attr == singular) {
+                            return l.template get_by_index<I>() == r.template get_by_index<I>();
+                        } else {
+                            return l.template get_by_index<I>().cast_to_base() == r.template get_by_index<I>().cast_to_base();
+                        }
+                    }() && ...);
+                }(std::index_sequence_for<F...>{});
+            }
+
+            friend constexpr bool operator==(const row_reference& l, const value_type& r) {
+                return value_type(l) == r;
+            }
+
+        private:
+            template <bool> friend class row_reference;
+
+            template <std::size_t I>
+            constexpr decltype(auto) get_by_index() const {
+                auto& column = std::get<I>(v->columns);
+                if constexpr (field_at<I>::attr == singular) {
+                    using column_type = std::remove_reference_t<decltype(column)>;
+                    using word_type = std::conditional_t<Const, const uint<8>, uint<8>>;
+
+                    return compact_field_ref<std::remove_reference_t<decltype(column.values[i])>, word_type>(
+                        column.values[i], column.presence[i / column_type::word_bits], column_type::mask(i));
+                } else {
+                    return column.values[i];
+                }
+            }
+
+            vector_type* v;
+            size_type i;
+        };
+
+        using reference = row_reference<false>;
+        using const_reference = row_reference<true>;
+
+        /// A random access iterator over rows of @ref soa_vector, which yields `row_reference`
+        template <bool Const>
+        class row_iterator {
+            using vector_type = std::conditional_t<Const, const soa_vector, soa_vector>;
+
+        public:
+            using value_type = soa_vector::value_type;
+            using difference_type = std::ptrdiff_t;
+            using reference = row_reference<Const>;
+            using iterator_concept = std::random_access_iterator_tag;
+
+            constexpr row_iterator() = default;
+
+            constexpr row_iterator(vector_type& v, size_type i) : v(&v), i(static_cast<difference_type>(i)) {}
+
+            template <bool C> requires (Const && !C)
+            constexpr row_iterator(const row_iterator<C>& other) : v(other.v), i(other.i) {}
+
+            constexpr reference operator*() const {
+                return reference(*v, i);
+            }
+
+            constexpr reference operator[](difference_type n) const {
+                return reference(*v, i + n);
+            }
+
+            constexpr row_iterator& operator++() { ++i; return *this; }
+            constexpr row_iterator operator++(int) { auto res = *this; ++i; return res; }
+            constexpr row_iterator& operator--() { --i; return *this; }
+            constexpr row_iterator operator--(int) { auto res = *this; --i; return res; }
+
+            constexpr row_iterator& operator+=(difference_type n) { i += n; return *this; }
+            constexpr row_iterator& operator-=(difference_type n) { i -= n; return *this; }
+
+            friend constexpr row_iterator operator+(row_iterator it, difference_type n) { return it += n; }
+            friend constexpr row_iterator operator+(difference_type n, row_iterator it) { return it += n; }
+            friend constexpr row_iterator operator-(row_iterator it, difference_type n) { return it -= n; }
+            friend constexpr difference_type operator-(const row_iterator& l, const row_iterator& r) { return l.i - r.i; }
+
+            friend constexpr bool operator==(const row_iterator& l, const row_iterator& r) { return l.i == r.i; }
+            friend constexpr auto operator<=>(const row_iterator& l, const row_iterator& r) { return l.i <=> r.i; }
+
+        private:
+            template <bool> friend class row_iterator;
+
+            vector_type* v = nullptr;
+            difference_type i = 0;
+        };
+
+        using iterator = row_iterator<false>;
+        using const_iterator = row_iterator<true>;
+
+        soa_vector() = default;
+
+        soa_vector(std::initializer_list<value_type> list) {
+            reserve(list.size());
+            for (const auto& msg : list) {
+                push_back(msg);
+            }
+        }
+
+        /// get the column of a field by the field number
+        template <uint<4> N>
+        auto& column() {
+            return std::get<field_number_index<N, F...>>(columns);
+        }
+
+        /// get the column of a field by the field number
+        template <uint<4> N>
+        const auto& column() const {
+            return std::get<field_number_index<N, F...>>(columns);
+        }
+
+        /// get the column of a field by the field name
+        template <basic_fixed_string S>
+        auto& column() {
+            return std::get<field_name_index<S, F...>>(columns);
+        }
+
+        /// get the column of a field by the field name
+        template <basic_fixed_string S>
+        const auto& column() const {
+            return std::get<field_name_index<S, F...>>(columns);
+        }
+
+        size_type size() const noexcept { return count; }
+        bool empty() const noexcept { return count == 0; }
+
+        reference operator[](size_type i) { return reference(*this, i); }
+        const_reference operator[](size_type i) const { return const_reference(*this, i); }
+
+        reference front() { return (*this)[0]; }
+        const_reference front() const { return (*this)[0]; }
+        reference back() { return (*this)[count - 1]; }
+        const_reference back() const { return (*this)[count - 1]; }
+
+        iterator begin() { return iterator(*this, 0); }
+        const_iterator begin() const { return const_iterator(*this, 0); }
+        const_iterator cbegin() const { return begin(); }
+        iterator end() { return iterator(*this, count); }
+        const_iterator end() const { return const_iterator(*this, count); }
+        const_iterator cend() const { return end(); }
+
+        void reserve(size_type n) {
+            std::apply([n](auto&... c) { (c.reserve(n), ...); }, columns);
+        }
+
+        void clear() {
+            std::apply([](auto&... c) { (c.clear(), ...); }, columns);
+            count = 0;
+        }
+
+        /// append a row where no field is present
+        reference emplace_back() {
+            std::apply([](auto&... c) { (c.emplace_back(), ...); }, columns);
+            return (*this)[count++];
+        }
+
+        void push_back(const value_type& msg) {
+            emplace_back() = msg;
+        }
+
+        void pop_back() {
+            std::apply([](auto&... c) { (c.pop_back(), ...); }, columns);
+            --count;
+        }
+
+        void resize(size_type n) {
+            while (count > n) {
+                pop_back();
+            }
+            reserve(n);
+            while (count < n) {
+                emplace_back();
+            }
+        }
+
+        iterator insert(const_iterator pos, const value_type& msg) {
+            const auto i = static_cast<size_type>(pos - cbegin());
+            push_back(msg);
+            for (size_type j = count - 1; j > i; --j) {
+                std::apply([j](auto&... c) { (c.swap_rows(j, j - 1), ...); }, columns);
+            }
+            return begin() + i;
+        }
+
+        /// @brief Decode an embedded message (with the length prefix) from `b` into a new row at the end, ref to @ref self_decoding_container
+        ///
+        /// Values of fields are decoded directly into their columns.
+        template <coder C, coder_mode Mode = safe_mode> requires std::same_as<C, embedded_message_coder<message<F...>>>
+        decode_to_result<Mode> decode_back(bytes b);
+
+        friend bool operator==(const soa_vector& l, const soa_vector& r) {
+            if (l.size() != r.size()) {
+                return false;
+            }
+
+            for (size_type i = 0; i < l.size(); ++i) {
+                if (!(l[i] == r[i])) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+    private:
+        template <coder_mode, typename> friend struct soa_vector_decode_map;
+
+        columns_type columns;
+        size_type count = 0;
+    };
+
+    /// A decode map which decodes field values into the last row of a @ref soa_vector, ref to @ref message_decode_map
+    template <coder_mode Mode, field_c... F>
+    struct soa_vector_decode_map<Mode, soa_vector<message<F...>>> : message_decode_map_base<Mode, soa_vector<message<F...>>> {
+    private:
+        using V = soa_vector<message<F...>>;
+        using function_result = message_decode_map_function_result<Mode>;
+
+        // Values of singular fields are decoded in place by `decode_to`, and then their presence bits are set
+        template <std::size_t I, field_c G>
+        static function_result decode_singular_field(V& v, bytes b) {
+            using C = typename G::coder;
+
+            auto& column = std::get<I>(v.columns);
+            const auto i = v.size() - 1;
+            if constexpr (in_place_decoder<C, Mode>) {
+                if (!Mode::get_value_from_result(C::template decode_to<Mode>(column.values[i], b), b)) {
+                    return {};
+                }
+            } else {
+                auto decode_v = make_decode_value<typename C::value_type>();
+                if (!Mode::get_value_from_result(C::template decode<Mode>(b), decode_v)) {
+                    return {};
+                }
+
+                column.values[i] = std::move(decode_v.first);
+                b = decode_v.second;
+            }
+
+            column.set_present(i);
+            return function_result{b};
+        }
+
+        template <std::size_t I, field_c G>
+        void insert_field_at() {
+            if constexpr (G::attr == singular) {
+                this->emplace(G::element_key, [](V& v, bytes b) {
+                    return decode_singular_field<I, G>(v, b);
+                });
+            } else {
+                this->template insert_field<G>([](V& v) -> G& {
+                    return std::get<I>(v.columns).values.back();
+                });
+            }
+        }
+
+        template <std::size_t... I>
+        explicit soa_vector_decode_map(std::index_sequence<I...>) {
+            (insert_field_at<I, F>(), ...);
+        }
+
+    public:
+        soa_vector_decode_map() : soa_vector_decode_map(std::index_sequence_for<F...>{}) {}
+    };
+
+    template <coder_mode Mode, typename V>
+    inline const soa_vector_decode_map<Mode, V> soa_decode_map;
+
+    template <field_c... F>
+    template <coder C, coder_mode Mode> requires std::same_as<C, embedded_message_coder<message<F...>>>
+    decode_to_result<Mode> soa_vector<message<F...>>::decode_back(bytes b) {
+        decode_value<uint<8>> decode_len;
+        if (!Mode::get_value_from_result(varint_coder<uint<8>>::decode<Mode>(b), decode_len)) {
+            return {};
+        }
+
+        const auto& [len, rest] = decode_len;
+        if (!check_length<Mode>(rest, len)) {
+            return {};
+        }
+
+        emplace_back();
+
+        bytes fields = rest.subspan(0, len);
+        while(fields.end() > fields.begin()) {
+            std::pair<bytes, bool> bytes_with_next;
+            if (!Mode::get_value_from_result(soa_decode_map<Mode, soa_vector>.decode(*this, fields), bytes_with_next)) {
+                return {};
+            }
+
+            bool next = true;
+            std::tie(fields, next) = bytes_with_next;
+
+            if(!next) break;
+        }
+
+        return Mode::template make_result<decode_to_result<Mode>>(rest.subspan(len));
+    }
+
+}
+
+#endif //PROTOPUF_SOA_VECTOR_H
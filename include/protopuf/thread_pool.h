@@ -0,0 +1,229 @@
+//   Copyright 2020-2021 PragmaTwice
+//
+//   Licensed under the Apache License, Version 2.0 (the "License");
+//   you may not use this file except in compliance with the License.
+//   You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the License is distributed on an "AS IS" BASIS,
+//   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//   See the License for the specific language governing permissions and
+//   limitations under the License.
+
+#ifndef PROTOPUF_THREAD_POOL_H
+#define PROTOPUF_THREAD_POOL_H
+
+#include "executor.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace pp {
+
+    /// @brief A fixed-size work-stealing thread pool, which is an @ref executor
+    ///
+    /// A loop is split into chunks, which are dealt evenly into per-thread ranges.
+    /// Every thread takes chunks from the front of its own range, and steals half of the remaining chunks
+    /// from the back of other ranges after its own range is exhausted.
+    /// The calling thread of `parallel_for` participates in the loop as well,
+    /// so a pool with concurrency `n` owns `n - 1` worker threads.
+    /// Loop bodies should not throw.
+    class thread_pool {
+    public:
+        /// Construct a pool where at most `concurrency` threads run a loop at the same time
+        explicit thread_pool(std::size_t concurrency = std::thread::hardware_concurrency())
+            : ranges(std::max<std::size_t>(concurrency, 1)) {
+            workers.reserve(ranges.size() - 1);
+            for (std::size_t i = 1; i < ranges.size(); ++i) {
+                workers.emplace_back([this, i] { work(i); });
+            }
+        }
+
+        thread_pool(const thread_pool&) = delete;
+        thread_pool& operator=(const thread_pool&) = delete;
+
+        ~thread_pool() {
+            {
+                std::lock_guard lock(mutex);
+                stopped = true;
+            }
+            job_cv.notify_all();
+
+            for (auto& worker : workers) {
+                worker.join();
+            }
+        }
+
+        /// the maximum number of threads running a loop at the same time
+        std::size_t concurrency() const {
+            return ranges.size();
+        }
+
+        /// @brief Run `f(begin, end)` over chunks of `[0, n)` in all threads of the pool
+        /// @param grain the chunk size, or `0` to choose it by the concurrency
+        template <typename F>
+        void parallel_for(std::size_t n, F&& f, std::size_t grain = 0) {
+            if (n == 0) {
+                return;
+            }
+
+            if (grain == 0) {
+                grain = std::max<std::size_t>(n / (concurrency() * 8), 1);
+            }
+
+            if (workers.empty() || n <= grain || in_worker) {
+                f(0, n);
+                return;
+            }
+
+            std::lock_guard run_lock(run_mutex);
+
+            job j{ [](void* ctx, std::size_t begin, std::size_t end) {
+                (*static_cast<std::remove_reference_t<F>*>(ctx))(begin, end);
+            }, &f, n, grain };
+
+            const std::size_t chunks = (n + grain - 1) / grain;
+            for (std::size_t i = 0; i < ranges.size(); ++i) {
+                ranges[i].store(chunk_range::make(chunks * i / ranges.size(), chunks * (i + 1) / ranges.size()));
+            }
+
+            {
+                std::lock_guard lock(mutex);
+                current = &j;
+                ++generation;
+            }
+            job_cv.notify_all();
+
+            in_worker = true;
+            run(j, 0);
+            in_worker = false;
+
+            std::unique_lock lock(mutex);
+            current = nullptr;
+            done_cv.wait(lock, [this] { return active == 0; });
+        }
+
+    private:
+        struct job {
+            void (*invoke)(void*, std::size_t, std::size_t);
+            void* ctx;
+            std::size_t n;
+            std::size_t grain;
+
+            void run_chunks(std::size_t begin, std::size_t end) const {
+                invoke(ctx, begin * grain, std::min(end * grain, n));
+            }
+        };
+
+        // a range of chunk indices [begin, end), packed into one word so that the owner and thieves can race by CAS
+        struct alignas(64) chunk_range : std::atomic<std::uint64_t> {
+            static constexpr std::uint64_t make(std::uint64_t begin, std::uint64_t end) {
+                return begin << 32 | end;
+            }
+
+            static constexpr std::uint32_t begin_of(std::uint64_t r) {
+                return static_cast<std::uint32_t>(r >> 32);
+            }
+
+            static constexpr std::uint32_t end_of(std::uint64_t r) {
+                return static_cast<std::uint32_t>(r);
+            }
+
+            // take one chunk from the front, returns false if the range is empty
+            bool pop(std::size_t& chunk) {
+                auto r = load(std::memory_order_relaxed);
+                while (begin_of(r) < end_of(r)) {
+                    if (compare_exchange_weak(r, make(begin_of(r) + 1, end_of(r)))) {
+                        chunk = begin_of(r);
+                        return true;
+                    }
+                }
+                return false;
+            }
+
+            // take half of the chunks from the back, returns false if the range is empty
+            bool steal(std::size_t& begin, std::size_t& end) {
+                auto r = load(std::memory_order_relaxed);
+                while (begin_of(r) < end_of(r)) {
+                    const auto half = (end_of(r) - begin_of(r) + 1) / 2;
+                    if (compare_exchange_weak(r, make(begin_of(r), end_of(r) - half))) {
+                        begin = end_of(r) - half, end = end_of(r);
+                        return true;
+                    }
+                }
+                return false;
+            }
+        };
+
+        void run(const job& j, std::size_t self) {
+            std::size_t chunk = 0;
+            while (ranges[self].pop(chunk)) {
+                j.run_chunks(chunk, chunk + 1);
+            }
+
+            for (std::size_t i = 1; i < ranges.size(); ++i) {
+                auto& victim = ranges[(self + i) % ranges.size()];
+                std::size_t begin = 0, end = 0;
+                while (victim.steal(begin, end)) {
+                    j.run_chunks(begin, end);
+                }
+            }
+        }
+
+        void work(std::size_t self) {
+            in_worker = true;
+            std::size_t seen = 0;
+
+            std::unique_lock lock(mutex);
+            while (true) {
+                job_cv.wait(lock, [this, seen] { return stopped || (current && generation != seen); });
+                if (stopped) {
+                    return;
+                }
+
+                seen = generation;
+                const job* j = current;
+                ++active;
+                lock.unlock();
+
+                run(*j, self);
+
+                lock.lock();
+                if (--active == 0) {
+                    done_cv.notify_one();
+                }
+            }
+        }
+
+        // set while the thread runs a loop body, so nested loops run inline instead of deadlocking
+        static inline thread_local bool in_worker = false;
+
+        std::vector<chunk_range> ranges;
+        std::vector<std::thread> workers;
+        std::mutex run_mutex;
+        std::mutex mutex;
+        std::condition_variable job_cv;
+        std::condition_variable done_cv;
+        const job* current = nullptr;
+        std::size_t generation = 0;
+        std::size_t active = 0;
+        bool stopped = false;
+    };
+
+    /// A process-wide @ref thread_pool with the hardware concurrency, created on first use
+    inline thread_pool& default_thread_pool() {
+        static thread_pool pool;
+        return pool;
+    }
+
+}
+
+#endif //PROTOPUF_THREAD_POOL_H
@@ -0,0 +1,265 @@
+//   Copyright 2020-2021 PragmaTwice
+//
+//   Licensed under the Apache License, Version 2.0 (the "License");
+//   you may not use this file except in compliance with the License.
+//   You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the License is distributed on an "AS IS" BASIS,
+//   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//   See the License for the specific language governing permissions and
+//   limitations under the License.
+
+#ifndef PROTOPUF_UTF8_H
+#define PROTOPUF_UTF8_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <span>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__)) && !defined(PROTOPUF_NO_SIMD)
+#define PROTOPUF_UTF8_X86 1
+#include <immintrin.h>
+#endif
+
+namespace pp {
+
+    /// @brief Validate UTF-8 characters in `p[i, n)` from the character boundary `i`, until a character ends at or after `until`
+    ///
+    /// Runs of ASCII characters are skipped 8 bytes at a time.
+    /// Reference: https://datatracker.ietf.org/doc/html/rfc3629#section-4
+    /// @returns the index after the last validated character, or `std::size_t(-1)` if any character is invalid or truncated
+    inline std::size_t validate_utf8_scalar(const unsigned char* p, std::size_t n, std::size_t i, std::size_t until) {
+        constexpr auto invalid = std::numeric_limits<std::size_t>::max();
+
+        while (i < until) {
+            if (i + 8 <= n) {
+                std::uint64_t w;
+                std::memcpy(&w, p + i, 8);
+                if ((w & 0x8080808080808080u) == 0) {
+                    i += 8;
+                    continue;
+                }
+            }
+
+            const unsigned char c = p[i];
+            if (c < 0x80) {
+                ++i;
+                continue;
+            }
+
+            std::size_t len = 0;
+            unsigned char lo = 0x80, hi = 0xbf;
+            if (c >= 0xc2 && c <= 0xdf) {
+                len = 2;
+            } else if (c >= 0xe0 && c <= 0xef) {
+                len = 3;
+                if (c == 0xe0) lo = 0xa0;
+                if (c == 0xed) hi = 0x9f;
+            } else if (c >= 0xf0 && c <= 0xf4) {
+                len = 4;
+                if (c == 0xf0) lo = 0x90;
+                if (c == 0xf4) hi = 0x8f;
+            } else {
+                return invalid;
+            }
+
+            if (i + len > n || p[i + 1] < lo || p[i + 1] > hi) {
+                return invalid;
+            }
+            for (std::size_t k = 2; k < len; ++k) {
+                if ((p[i + k] & 0xc0) != 0x80) {
+                    return invalid;
+                }
+            }
+
+            i += len;
+        }
+
+        return i;
+    }
+
+#ifdef PROTOPUF_UTF8_X86
+
+    /// @brief Validate UTF-8 in `src[0, n)` by SSE2, and copy it into `dst` (if not null) in the same pass
+    ///
+    /// Blocks of 16 ASCII characters are checked by a single comparison,
+    /// and blocks with other characters are validated by @ref validate_utf8_scalar.
+    __attribute__((target("sse2")))
+    inline bool copy_utf8_sse2(unsigned char* dst, const unsigned char* src, std::size_t n) {
+        std::size_t i = 0;
+        while (i + 16 <= n) {
+            const __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+            if (dst) {
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), in);
+            }
+
+            if (_mm_movemask_epi8(in) == 0) {
+                i += 16;
+                continue;
+            }
+
+            // characters ending beyond the block are validated as a whole, and copied in the next block
+            const auto next = validate_utf8_scalar(src, n, i, i + 16);
+            if (next == std::numeric_limits<std::size_t>::max()) {
+                return false;
+            }
+            if (dst && next > i + 16) {
+                std::memcpy(dst + i + 16, src + i + 16, next - i - 16);
+            }
+            i = next;
+        }
+
+        if (validate_utf8_scalar(src, n, i, n) == std::numeric_limits<std::size_t>::max()) {
+            return false;
+        }
+        if (dst && i < n) {
+            std::memcpy(dst + i, src + i, n - i);
+        }
+        return true;
+    }
+
+    /// @brief Validate UTF-8 in `src[0, n)` by AVX2, and copy it into `dst` (if not null) in the same pass
+    ///
+    /// It is the lookup algorithm by Keiser and Lemire, where all errors of a block are found by three table lookups
+    /// on nibbles of each byte and its previous byte, plus a check of the 3rd and 4th bytes of multi-byte characters.
+    /// Reference: https://arxiv.org/abs/2010.03090 (Validating UTF-8 In Less Than One Instruction Per Byte)
+    __attribute__((target("avx2")))
+    inline bool copy_utf8_avx2(unsigned char* dst, const unsigned char* src, std::size_t n) {
+        // error kinds of a pair of bytes, found by the high and low nibbles of the first byte and the high nibble of the second one
+        constexpr char too_short = 1 << 0, too_long = 1 << 1, overlong_3 = 1 << 2, too_large = 1 << 3, surrogate = 1 << 4,
+            overlong_2 = 1 << 5, too_large_1000 = 1 << 6, overlong_4 = 1 << 6;
+        constexpr char two_conts = static_cast<char>(1 << 7);
+        constexpr char carry = too_short | too_long | two_conts;
+
+        const __m256i byte_1_high_table = _mm256_setr_epi8(
+            too_long, too_long, too_long, too_long, too_long, too_long, too_long, too_long,
+            two_conts, two_conts, two_conts, two_conts,
+            too_short | overlong_2, too_short, too_short | overlong_3 | surrogate, too_short | too_large | too_large_1000 | overlong_4,
+            too_long, too_long, too_long, too_long, too_long, too_long, too_long, too_long,
+            two_conts, two_conts, two_conts, two_conts,
+            too_short | overlong_2, too_short, too_short | overlong_3 | surrogate, too_short | too_large | too_large_1000 | overlong_4);
+
+        constexpr char large = carry | too_large | too_large_1000;
+        const __m256i byte_1_low_table = _mm256_setr_epi8(
+            carry | overlong_3 | overlong_2 | overlong_4, carry | overlong_2, carry, carry,
+            carry | too_large, large, large, large, large, large, large, large, large, large | surrogate, large, large,
+            carry | overlong_3 | overlong_2 | overlong_4, carry | overlong_2, carry, carry,
+            carry | too_large, large, large, large, large, large, large, large, large, large | surrogate, large, large);
+
+        constexpr char cont = too_long | overlong_2 | two_conts;
+        const __m256i byte_2_high_table = _mm256_setr_epi8(
+            too_short, too_short, too_short, too_short, too_short, too_short, too_short, too_short,
+            cont | overlong_3 | too_large_1000 | overlong_4, cont | overlong_3 | too_large, cont | surrogate | too_large, cont | surrogate | too_large,
+            too_short, too_short, too_short, too_short,
+            too_short, too_short, too_short, too_short, too_short, too_short, too_short, too_short,
+            cont | overlong_3 | too_large_1000 | overlong_4, cont | overlong_3 | too_large, cont | surrogate | too_large, cont | surrogate | too_large,
+            too_short, too_short, too_short, too_short);
+
+        // a block is incomplete if any of its last 3 bytes begins a character longer than the rest of the block
+        const __m256i incomplete_max = _mm256_setr_epi8(
+            -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+            -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+            static_cast<char>(0xf0 - 1), static_cast<char>(0xe0 - 1), static_cast<char>(0xc0 - 1));
+
+        const __m256i low_nibble = _mm256_set1_epi8(0x0f);
+
+        __m256i error = _mm256_setzero_si256(), prev_input = _mm256_setzero_si256(), prev_incomplete = _mm256_setzero_si256();
+
+        const auto check_block = [&](__m256i in) __attribute__((target("avx2"))) {
+            if (_mm256_movemask_epi8(in) == 0) {
+                error = _mm256_or_si256(error, prev_incomplete);
+            } else {
+                // the bytes before every byte of the block, which are shifted in from the previous block
+                const __m256i carried = _mm256_permute2x128_si256(prev_input, in, 0x21);
+                const __m256i prev1 = _mm256_alignr_epi8(in, carried, 16 - 1);
+                const __m256i prev2 = _mm256_alignr_epi8(in, carried, 16 - 2);
+                const __m256i prev3 = _mm256_alignr_epi8(in, carried, 16 - 3);
+
+                const __m256i byte_1_high = _mm256_shuffle_epi8(byte_1_high_table, _mm256_and_si256(_mm256_srli_epi16(prev1, 4), low_nibble));
+                const __m256i byte_1_low = _mm256_shuffle_epi8(byte_1_low_table, _mm256_and_si256(prev1, low_nibble));
+                const __m256i byte_2_high = _mm256_shuffle_epi8(byte_2_high_table, _mm256_and_si256(_mm256_srli_epi16(in, 4), low_nibble));
+                const __m256i special_cases = _mm256_and_si256(_mm256_and_si256(byte_1_high, byte_1_low), byte_2_high);
+
+                // bytes which must be the 3rd or 4th bytes of characters, which should be continuation bytes
+                const __m256i must_be_23 = _mm256_or_si256(
+                    _mm256_subs_epu8(prev2, _mm256_set1_epi8(static_cast<char>(0xe0 - 0x80))),
+                    _mm256_subs_epu8(prev3, _mm256_set1_epi8(static_cast<char>(0xf0 - 0x80))));
+                const __m256i must_be_23_80 = _mm256_and_si256(must_be_23, _mm256_set1_epi8(static_cast<char>(0x80)));
+
+                error = _mm256_or_si256(error, _mm256_xor_si256(must_be_23_80, special_cases));
+                prev_incomplete = _mm256_subs_epu8(in, incomplete_max);
+            }
+            prev_input = in;
+        };
+
+        std::size_t i = 0;
+        for (; i + 32 <= n; i += 32) {
+            const __m256i in = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+            if (dst) {
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), in);
+            }
+            check_block(in);
+        }
+
+        if (i < n) {
+            // the rest is padded with ASCII zeros, so that characters truncated at the end are found as too short
+            alignas(32) unsigned char tail[32] = {};
+            std::memcpy(tail, src + i, n - i);
+            check_block(_mm256_load_si256(reinterpret_cast<const __m256i*>(tail)));
+            if (dst) {
+                std::memcpy(dst + i, tail, n - i);
+            }
+        }
+
+        error = _mm256_or_si256(error, prev_incomplete);
+        return _mm256_testz_si256(error, error);
+    }
+
+    /// Whether AVX2 instructions are available on the running CPU
+    inline bool has_avx2() {
+        static const bool value = __builtin_cpu_supports("avx2");
+        return value;
+    }
+
+#endif
+
+    /// @brief Validate UTF-8 in `src`, and copy it into `dst` (if not null) in the same pass
+    ///
+    /// It is vectorized by AVX2 (ref to @ref copy_utf8_avx2) or SSE2 (ref to @ref copy_utf8_sse2) if available on x86,
+    /// which is detected at run time, and falls back to @ref validate_utf8_scalar on other platforms.
+    /// `dst` is unspecified if `src` is invalid.
+    inline bool copy_utf8(void* dst, std::span<const std::byte> src) {
+        const auto* s = reinterpret_cast<const unsigned char*>(src.data());
+        auto* d = static_cast<unsigned char*>(dst);
+
+#ifdef PROTOPUF_UTF8_X86
+        if (has_avx2()) {
+            return copy_utf8_avx2(d, s, src.size());
+        }
+        return copy_utf8_sse2(d, s, src.size());
+#else
+        if (validate_utf8_scalar(s, src.size(), 0, src.size()) == std::numeric_limits<std::size_t>::max()) {
+            return false;
+        }
+        if (d && !src.empty()) {
+            std::memcpy(d, s, src.size());
+        }
+        return true;
+#endif
+    }
+
+    /// @brief Check whether `s` is valid UTF-8, i.e. without overlong encodings, surrogates or code points beyond U+10FFFF
+    ///
+    /// It is vectorized if available, ref to @ref copy_utf8.
+    inline bool validate_utf8(std::span<const std::byte> s) {
+        return copy_utf8(nullptr, s);
+    }
+
+}
+
+#endif //PROTOPUF_UTF8_H
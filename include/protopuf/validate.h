@@ -0,0 +1,297 @@
+//   Copyright 2020-2021 PragmaTwice
+//
+//   Licensed under the Apache License, Version 2.0 (the "License");
+//   you may not use this file except in compliance with the License.
+//   You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the License is distributed on an "AS IS" BASIS,
+//   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//   See the License for the specific language governing permissions and
+//   limitations under the License.
+
+#ifndef PROTOPUF_VALIDATE_H
+#define PROTOPUF_VALIDATE_H
+
+#include "compact_message.h"
+#include "map.h"
+#include "utf8.h"
+
+#include <bit>
+#include <cstring>
+#include <limits>
+
+namespace pp {
+
+    /// The maximum number of bytes of a varint encoding a field key (a 32-bit integer)
+    inline constexpr std::size_t key_max_size = 5;
+
+    /// The most significant bit of every byte in a 64-bit word, i.e. the continuation bits of varints
+    inline constexpr uint<8> varint_continuation_mask = 0x8080808080808080u;
+
+    /// Load 8 bytes from `p` as a little-endian integer, so that the first byte is the least significant one
+    inline uint<8> load_le64(const std::byte* p) {
+        uint<8> w;
+        std::memcpy(&w, p, 8);
+        if constexpr (std::endian::native == std::endian::big) {
+            uint<8> r = 0;
+            for (std::size_t i = 0; i < 8; ++i) {
+                r = (r << 8) | ((w >> (8 * i)) & 0xffu);
+            }
+            w = r;
+        }
+        return w;
+    }
+
+    /// @brief Get the size of the varint at the beginning of `b`, where 8 bytes are scanned at a time (SWAR)
+    /// @returns 0 if the varint is truncated, or longer than `Max` bytes
+    template <std::size_t Max = varint_max_size>
+    inline std::size_t varint_size(bytes b) {
+        if (b.size() >= 8) {
+            // the first byte without the continuation bit ends the varint
+            if (const uint<8> stop = ~load_le64(b.data()) & varint_continuation_mask; stop != 0) {
+                const std::size_t n = std::countr_zero(stop) / 8 + 1;
+                return n <= Max ? n : 0;
+            }
+        }
+
+        for (std::size_t i = 0; i < std::min(b.size(), Max); ++i) {
+            if ((b[i] >> 7) == 0_b) {
+                return i + 1;
+            }
+        }
+        return 0;
+    }
+
+    /// @brief Check whether `b` consists of complete varints which are at most @ref varint_max_size bytes,
+    /// i.e. values of a @ref packed field, where 8 bytes are scanned at a time (SWAR)
+    inline bool validate_varints(bytes b) {
+        // the number of continuation bytes seen in the current varint
+        std::size_t run = 0;
+
+        std::size_t i = 0;
+        for (; i + 8 <= b.size(); i += 8) {
+            const uint<8> stop = ~load_le64(b.data() + i) & varint_continuation_mask;
+            if (stop == 0) {
+                run += 8;
+            } else {
+                if (run + std::countr_zero(stop) / 8 >= varint_max_size) {
+                    return false;
+                }
+
+                // varints ending inside the word are shorter than 8 bytes, so only the last one is carried
+                run = std::countl_zero(stop) / 8;
+            }
+
+            if (run >= varint_max_size) {
+                return false;
+            }
+        }
+
+        for (; i < b.size(); ++i) {
+            if ((b[i] >> 7) == 0_b) {
+                run = 0;
+            } else if (++run >= varint_max_size) {
+                return false;
+            }
+        }
+
+        return run == 0;
+    }
+
+    /// @brief A validator checking whether bytes begin with a well-formed value encoded by the @ref coder `C`, without decoding it
+    ///
+    /// Scalars are checked by their wire types, strings of `char` are checked to be UTF-8 if `Utf8` is true,
+    /// and embedded messages are validated recursively (ref to @ref message_validator).
+    template <coder C, bool Utf8>
+    struct value_validator {
+        /// @returns the bytes after the value, or an empty result if the value is malformed
+        static decode_skip_result<safe_mode> validate(bytes b) {
+            constexpr auto wire = wire_type<C>;
+            if constexpr (wire == 0) {
+                if (const auto n = varint_size(b); n != 0) {
+                    return b.subspan(n);
+                }
+                return {};
+            } else {
+                constexpr std::size_t n = wire == 1 ? 8 : 4;
+                if (b.size() < n) {
+                    return {};
+                }
+                return b.subspan(n);
+            }
+        }
+
+        /// @returns whether `b` consists of complete values, i.e. values of a @ref packed field without the length prefix
+        static bool validate_packed(bytes b) {
+            constexpr auto wire = wire_type<C>;
+            if constexpr (wire == 0) {
+                return validate_varints(b);
+            } else {
+                return b.size() % (wire == 1 ? 8 : 4) == 0;
+            }
+        }
+    };
+
+    /// @brief Get the length-delimited value at the beginning of `b`
+    /// @returns the value (without the length prefix) and the bytes after it, or an empty result if it is truncated
+    inline std::optional<std::pair<bytes, bytes>> validate_length_delimited(bytes b) {
+        const auto n = varint_size(b);
+        if (n == 0) {
+            return {};
+        }
+
+        decode_value<uint<8>> decode_len;
+        unsafe_mode::get_value_from_result(varint_coder<uint<8>>::decode<unsafe_mode>(b), decode_len);
+        const auto& [len, rest] = decode_len;
+        if (len > rest.size()) {
+            return {};
+        }
+
+        return std::pair{rest.subspan(0, len), rest.subspan(len)};
+    }
+
+    template <coder C, typename R, bool Utf8>
+    struct value_validator<array_coder<C, R>, Utf8> {
+        static decode_skip_result<safe_mode> validate(bytes b) {
+            const auto value = validate_length_delimited(b);
+            if (!value) {
+                return {};
+            }
+
+            auto [elements, rest] = *value;
+            using T = typename C::value_type;
+            if constexpr (std::same_as<C, integer_coder<T>> && sizeof(T) == 1) {
+                if constexpr (Utf8 && (std::same_as<T, char> || std::same_as<T, char8_t>)) {
+                    if (!validate_utf8(elements)) {
+                        return {};
+                    }
+                }
+            } else {
+                while (elements.end() > elements.begin()) {
+                    if (!safe_mode::get_value_from_result(value_validator<C, Utf8>::validate(elements), elements)) {
+                        return {};
+                    }
+                }
+            }
+
+            return rest;
+        }
+    };
+
+    template <typename R, bool Utf8>
+    struct value_validator<utf8_string_coder<R>, Utf8> : value_validator<array_coder<integer_coder<char>, R>, true> {};
+
+    template <message_c T, bool Utf8>
+    struct message_validator;
+
+    template <message_c T, bool Utf8>
+    struct value_validator<embedded_message_coder<T>, Utf8> {
+        static decode_skip_result<safe_mode> validate(bytes b) {
+            const auto value = validate_length_delimited(b);
+            if (!value || !message_validator<T, Utf8>::validate(value->first)) {
+                return {};
+            }
+
+            return value->second;
+        }
+    };
+
+    /// @brief A validator checking whether bytes are a well-formed encoded message of type `message<F...>`, without decoding it
+    ///
+    /// Keys, varints and length prefixes are checked to be complete, and values of declared fields are checked by their coders
+    /// (ref to @ref value_validator), where a value whose wire type differs from the declared one is malformed.
+    /// Values of unknown fields are checked by their wire types.
+    template <field_c... F, bool Utf8>
+    struct message_validator<message<F...>, Utf8> {
+    private:
+        // check the value if the field number of `key` belongs to `G`, or return false
+        template <field_c G>
+        static bool validate_field(uint<4> key, bytes b, decode_skip_result<safe_mode>& rest) {
+            if constexpr (G::attr == unknown) {
+                return false;
+            } else if constexpr (G::attr == oneof) {
+                return [&]<std::size_t... I>(std::index_sequence<I...>) {
+                    return (validate_field<typename G::template member<I>>(key, b, rest) || ...);
+                }(std::make_index_sequence<G::size>{});
+            } else {
+                if (to_field_number(key) != G::number) {
+                    return false;
+                }
+
+                using V = value_validator<typename G::coder, Utf8>;
+                if (key == G::element_key) {
+                    rest = V::validate(b);
+                } else if constexpr (G::packable) {
+                    if (key == G::packed_key) {
+                        if (const auto value = validate_length_delimited(b); value && V::validate_packed(value->first)) {
+                            rest = value->second;
+                        }
+                    }
+                }
+                return true;
+            }
+        }
+
+        static decode_skip_result<safe_mode> validate_unknown(uint<1> wire, bytes b) {
+            switch (wire) {
+                case 0: return value_validator<varint_coder<uint<8>>, false>::validate(b);
+                case 1: return value_validator<integer_coder<uint<8>>, false>::validate(b);
+                case 2: return value_validator<bytes_coder, false>::validate(b);
+                case 5: return value_validator<integer_coder<uint<4>>, false>::validate(b);
+                default: return {};
+            }
+        }
+
+    public:
+        /// @returns whether `b` is a well-formed encoded message
+        static bool validate(bytes b) {
+            while (b.end() > b.begin()) {
+                const auto n = varint_size<key_max_size>(b);
+                if (n == 0) {
+                    return false;
+                }
+
+                decode_value<uint<8>> decode_key;
+                unsafe_mode::get_value_from_result(varint_coder<uint<8>>::decode<unsafe_mode>(b), decode_key);
+                const auto& [key64, nb] = decode_key;
+                if (key64 > std::numeric_limits<uint<4>>::max() || to_field_number(key64) == 0) {
+                    return false;
+                }
+
+                const auto key = static_cast<uint<4>>(key64);
+                decode_skip_result<safe_mode> rest;
+                if (!(validate_field<F>(key, nb, rest) || ...)) {
+                    rest = validate_unknown(to_wire_key(key), nb);
+                }
+
+                if (!safe_mode::get_value_from_result(rest, b)) {
+                    return false;
+                }
+            }
+
+            return true;
+        }
+    };
+
+    template <field_c... F, bool Utf8>
+    struct message_validator<compact_message<F...>, Utf8> : message_validator<message<F...>, Utf8> {};
+
+    template <coder K, coder V, bool Utf8>
+    struct message_validator<map_element<K, V>, Utf8> : message_validator<map_element_base<K, V>, Utf8> {};
+
+    /// @brief Check whether `b` is a well-formed encoded message of type `T`, without decoding or allocating anything
+    ///
+    /// It is much cheaper than decoding in @ref safe_mode, i.e. to reject malformed payloads before storing them.
+    /// Different from decoding, field number 0 and values with wire types different from the declared ones are malformed.
+    /// @param Utf8 whether strings of `char` are checked to be valid UTF-8 (as proto3 `string` fields require)
+    template <message_c T, bool Utf8 = false>
+    bool validate(bytes b) {
+        return message_validator<T, Utf8>::validate(b);
+    }
+
+}
+
+#endif //PROTOPUF_VALIDATE_H
@@ -22,6 +22,9 @@
 
 namespace pp {
 
+    /// The maximum number of bytes of a varint, i.e. of a 64-bit integer, where longer varints are rejected except in @ref unsafe_mode
+    inline constexpr std::size_t varint_max_size = 10;
+
     /// @brief A @ref coder for variable-length integers
     ///
     /// Each byte in a varint, except the last byte, has the most significant bit (msb) set, 
@@ -65,6 +68,22 @@ namespace pp {
         template<coder_mode Mode>
         static constexpr decode_result<T, Mode> decode(bytes s) {
             T n = 0;
+            if (!Mode::get_value_from_result(decode_to<Mode>(n, s), s)) {
+                return {};
+            }
+
+            return Mode::template make_result<decode_result<T, Mode>>(std::move(n), s);
+        }
+
+        template<coder_mode Mode>
+        static constexpr decode_to_result<Mode> decode_to(T& out, bytes s) {
+            if (is_readable<Mode>(s)) {
+                const std::size_t size = decode_readable<Mode>(out, s);
+                if (size == 0) {
+                    return {};
+                }
+                return Mode::template make_result<decode_to_result<Mode>>(s.subspan(size));
+            }
 
             auto iter = s.begin();
             const auto end = s.end();
@@ -73,18 +92,67 @@ namespace pp {
                 return {};
             }
 
+            T n = 0;
             std::size_t i = 0;
             while((*iter >> 7) == 1_b) {
-                n |= static_cast<T>(static_cast<T>(*iter & 0b0111'1111_b) << 7*i);
+                n |= static_cast<T>(static_cast<uint<8>>(*iter & 0b0111'1111_b) << 7*i);
                 ++iter, ++i;
 
+                if constexpr (!std::same_as<Mode, unsafe_mode>) {
+                    if (i == varint_max_size) {
+                        report_coder_error<Mode>(coder_error_code::overlong_varint, std::to_address(s.begin()));
+                        return {};
+                    }
+                }
+
                 if (!Mode::check_iterator(iter, end)) {
                     return {};
                 }
             }
-            n |= static_cast<T>(static_cast<T>(*iter++) << 7 * i);
+            out = n | static_cast<T>(static_cast<uint<8>>(*iter++) << 7 * i);
+
+            return Mode::template make_result<decode_to_result<Mode>>(bytes{iter, s.end()});
+        }
+
+        /// whether a whole varint (i.e. `varint_max_size` bytes) can be read from `s` without checking every byte,
+        /// since the bytes are long enough or followed by the slop of `Mode` (ref to @ref slop_mode)
+        template<coder_mode Mode>
+        static constexpr bool is_readable(bytes s) {
+            if constexpr (std::same_as<Mode, unsafe_mode>) {
+                return false;
+            } else {
+                return s.size() >= varint_max_size || (readable_slop<Mode> >= varint_max_size && !s.empty());
+            }
+        }
+
+        /// decode a varint from readable bytes (ref to `is_readable`) with a single check after the varint,
+        /// returns the size of the varint, or 0 if the varint is overlong or exceeds `s`,
+        /// which is shared with the @ref skipper of varints, where the unused value is optimized out
+        template<coder_mode Mode>
+        static constexpr std::size_t decode_readable(T& out, bytes s) {
+            const std::byte* p = s.data();
+
+            uint<8> n = 0;
+            for (std::size_t i = 0; i < varint_max_size; ++i) {
+                n |= static_cast<uint<8>>(p[i] & 0b0111'1111_b) << 7*i;
+
+                if ((p[i] >> 7) == 0_b) {
+                    if (i >= s.size()) {
+                        report_coder_error<Mode>(coder_error_code::truncated, p + s.size());
+                        return 0;
+                    }
+
+                    out = static_cast<T>(n);
+                    return i + 1;
+                }
+            }
 
-            return Mode::template make_result<decode_result<T, Mode>>(std::move(n), bytes{iter, s.end()});
+            if (s.size() < varint_max_size) {
+                report_coder_error<Mode>(coder_error_code::truncated, p + s.size());
+            } else {
+                report_coder_error<Mode>(coder_error_code::overlong_varint, p);
+            }
+            return 0;
         }
     };
 
@@ -104,6 +172,14 @@ namespace pp {
         static constexpr decode_result<T, Mode> decode(bytes s) {
             return varint_coder<std::make_unsigned_t<T>>::template decode<Mode>(s);
         }
+
+        template<coder_mode Mode>
+        static constexpr decode_to_result<Mode> decode_to(T& out, bytes s) {
+            std::make_unsigned_t<T> u{};
+            auto result = varint_coder<std::make_unsigned_t<T>>::template decode_to<Mode>(u, s);
+            out = static_cast<T>(u);
+            return result;
+        }
     };
 
 
@@ -135,6 +135,14 @@ namespace pp {
             
             return {};
         }
+
+        template<coder_mode Mode>
+        static constexpr decode_to_result<Mode> decode_to(T& out, bytes bytes) {
+            uint<N> u{};
+            auto result = integer_coder<uint<N>>::template decode_to<Mode>(u, bytes);
+            out = T::from_uint(u);
+            return result;
+        }
     };
 
 
@@ -161,6 +169,14 @@ namespace pp {
             
             return {};
         }
+
+        template<coder_mode Mode>
+        static constexpr decode_to_result<Mode> decode_to(T& out, bytes s) {
+            uint<N> u{};
+            auto result = varint_coder<uint<N>>::template decode_to<Mode>(u, s);
+            out = T::from_uint(u);
+            return result;
+        }
     };
 }
 
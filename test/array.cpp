@@ -50,6 +50,44 @@ TYPED_TEST(test_array_coder, decode) {
     EXPECT_EQ(con, v);
 }
 
+TYPED_TEST(test_array_coder, decode_reserves_fixed_length_elements) {
+    array<byte, 9> f{0x08_b, 0x00_b, 0x00_b, 0x80_b, 0x3f_b, 0x00_b, 0x00_b, 0x00_b, 0x40_b};
+    decode_value<vector<float>> float_value;
+    ASSERT_TRUE(TestFixture::mode::get_value_from_result(
+        array_coder<float_coder<float>>::decode<typename TestFixture::mode>(f), float_value));
+    const auto& [v, n] = float_value;
+    EXPECT_EQ(begin_diff(n, f), 9);
+    EXPECT_EQ(v, (vector<float>{1.0f, 2.0f}));
+    EXPECT_GE(v.capacity(), 2);
+}
+
+TYPED_TEST(test_array_coder, decode_append_fixed_length_values) {
+    array<byte, 13> a{0x0c_b, 0x01_b, 0x00_b, 0x00_b, 0x00_b, 0xfe_b, 0xff_b, 0xff_b, 0xff_b, 0x00_b, 0x00_b, 0x80_b, 0x3f_b};
+    bytes rest;
+
+    vector<sint<4>> ints{5};
+    ASSERT_TRUE(TestFixture::mode::get_value_from_result(
+        array_coder<integer_coder<sint<4>>>::decode_append<typename TestFixture::mode>(ints, a), rest));
+    EXPECT_EQ(begin_diff(rest, a), 13);
+    EXPECT_EQ(ints, (vector<sint<4>>{5, 1, -2, 1065353216}));
+
+    vector<float> floats;
+    ASSERT_TRUE(TestFixture::mode::get_value_from_result(
+        array_coder<float_coder<float>>::decode_to<typename TestFixture::mode>(floats, a), rest));
+    EXPECT_EQ(floats.size(), 3);
+    EXPECT_EQ(floats[2], 1.0f);
+}
+
+GTEST_TEST(static, encoded_count) {
+    static_assert(countable_coder<integer_coder<sint<4>>>);
+    static_assert(countable_coder<varint_coder<sint_zigzag<8>>>);
+    static_assert(!countable_coder<string_coder>);
+
+    array<byte, 4> a{0x80_b, 0x01_b, 0x7f_b, 0x00_b};
+    EXPECT_EQ(encoded_count<varint_coder<pp::uint<4>>>(a), 3);
+    EXPECT_EQ(encoded_count<integer_coder<pp::uint<2>>>(a), 2);
+}
+
 template<typename T>
 struct test_string_coder : test_fixture<T> {};
 TYPED_TEST_SUITE(test_string_coder, coder_mode_types, test_name_generator);
@@ -80,6 +118,11 @@ GTEST_TEST(array_coder, encode_with_insufficient_buffer_size) {
     run_safe_encode_tests_with_insufficient_buffer_size<array_coder<varint_coder<sint_zigzag<8>>>, 7>(con);
 }
 
+GTEST_TEST(array_coder, decode_misaligned_fixed_length_values) {
+    array<byte, 8> a{0x07_b, 0x01_b, 0x00_b, 0x00_b, 0x00_b, 0x02_b, 0x00_b, 0x00_b};
+    EXPECT_FALSE(array_coder<integer_coder<pp::uint<4>>>::decode<safe_mode>(a));
+}
+
 GTEST_TEST(array_coder, decode_with_insufficient_buffer_size) {
     array<byte, 7> a{0x06_b, 0x01_b, 0xC0_b, 0x9A_b, 0x0C_b, 0x12_b, 0x08_b};
     run_safe_decode_tests_with_insufficient_buffer_size<array_coder<varint_coder<sint_zigzag<8>>>>(a);
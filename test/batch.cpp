@@ -0,0 +1,79 @@
+//   Copyright 2020-2021 PragmaTwice
+//
+//   Licensed under the Apache License, Version 2.0 (the "License");
+//   you may not use this file except in compliance with the License.
+//   You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the License is distributed on an "AS IS" BASIS,
+//   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//   See the License for the specific language governing permissions and
+//   limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <protopuf/batch.h>
+#include <vector>
+
+#include "test_fixture.h"
+
+using namespace pp;
+using namespace std;
+
+using Student = message<uint32_field<"id", 1>, string_field<"name", 3>>;
+
+template <typename T>
+struct test_batch : testing::Test {};
+TYPED_TEST_SUITE(test_batch, coder_mode_types, test_name_generator);
+
+TYPED_TEST(test_batch, encode_decode) {
+    using Mode = TypeParam;
+
+    vector<Student> students;
+    for (uint32 i = 0; i < 1000; ++i) {
+        students.push_back(Student{i, "student " + to_string(i)});
+    }
+
+    vector<array<byte, 64>> storage(students.size());
+    vector<bytes> outputs(storage.begin(), storage.end());
+    thread_pool pool(4);
+
+    EXPECT_TRUE((encode_batch<Student, Mode>(students, outputs, pool)));
+    for (size_t i = 0; i < students.size(); ++i) {
+        ASSERT_EQ(outputs[i].data(), storage[i].data());
+        ASSERT_EQ(outputs[i].size(), skipper<message_coder<Student>>::encode_skip(students[i]));
+    }
+
+    vector<Student> decoded(students.size());
+    EXPECT_TRUE((decode_batch<Student, Mode>(outputs, span(decoded), pool)));
+    EXPECT_EQ(decoded, students);
+
+    sequential_executor seq;
+    vector<Student> decoded_seq(students.size());
+    EXPECT_TRUE((decode_batch<Student, Mode>(outputs, span(decoded_seq), seq)));
+    EXPECT_EQ(decoded_seq, students);
+
+    vector<Student> decoded_default(students.size());
+    EXPECT_TRUE((decode_batch<Student, Mode>(outputs, span(decoded_default))));
+    EXPECT_EQ(decoded_default, students);
+}
+
+GTEST_TEST(batch, failure) {
+    vector<Student> students{Student{1u, "twice"}, Student{2u, string(100, 'x')}, Student{3u, "tom"}};
+
+    vector<array<byte, 16>> storage(students.size());
+    vector<bytes> outputs(storage.begin(), storage.end());
+    thread_pool pool(2);
+
+    EXPECT_FALSE(encode_batch<Student>(students, outputs, pool));
+    EXPECT_EQ(outputs[0].size(), 9);
+    EXPECT_EQ(outputs[2].size(), 7);
+
+    outputs[1] = outputs[0].first(5);
+    vector<Student> decoded(students.size());
+    EXPECT_FALSE(decode_batch<Student>(outputs, span(decoded), pool));
+    EXPECT_EQ(decoded[0], students[0]);
+    EXPECT_EQ(decoded[2], students[2]);
+}
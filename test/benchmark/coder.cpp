@@ -0,0 +1,240 @@
+//   Copyright 2020-2021 PragmaTwice
+//
+//   Licensed under the Apache License, Version 2.0 (the "License");
+//   you may not use this file except in compliance with the License.
+//   You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the License is distributed on an "AS IS" BASIS,
+//   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//   See the License for the specific language governing permissions and
+//   limitations under the License.
+
+// Microbenchmarks of every scalar coder and of skipping every wire type, over 2^20 values per run,
+// which are generated deterministically with controlled distributions (so that branch predictors cannot memorize them).
+// Every benchmark reports the time per value (time/value, in seconds) and bytes per second.
+
+#include <protopuf/message.h>
+#include <benchmark/benchmark.h>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace pp;
+using namespace std;
+
+constexpr size_t coder_values = 1 << 20;
+
+// A set of values to be coded by the @ref coder `coder`
+template <coder C, typename Derived>
+struct value_set {
+    using coder = C;
+    using value_type = typename C::value_type;
+
+    static const vector<value_type>& values() {
+        static const vector<value_type> v = [] {
+            mt19937_64 gen(20240601);
+            vector<value_type> v(coder_values);
+            for (size_t i = 0; i < v.size(); ++i) {
+                v[i] = Derived::make(gen);
+            }
+            return v;
+        }();
+        return v;
+    }
+
+    static const vector<byte>& encoded() {
+        static const vector<byte> b = [] {
+            size_t size = 0;
+            for (const auto& x : values()) {
+                size += skipper<C>::encode_skip(x);
+            }
+
+            vector<byte> b(size);
+            bytes rest = b;
+            for (const auto& x : values()) {
+                rest = *C::template encode<safe_mode>(x, rest);
+            }
+            return b;
+        }();
+        return b;
+    }
+
+    // the encoded values followed by the slop of `Mode`, i.e. the bytes which decoding in `Mode` may read past the end
+    template <coder_mode Mode>
+    static const vector<byte>& padded() {
+        if constexpr (readable_slop<Mode> == 0) {
+            return encoded();
+        } else {
+            static const vector<byte> b = [] {
+                vector<byte> b = encoded();
+                b.resize(b.size() + readable_slop<Mode>);
+                return b;
+            }();
+            return b;
+        }
+    }
+};
+
+// varints which are exactly `L` bytes long
+template <size_t L>
+struct varint_length : value_set<varint_coder<pp::uint<8>>, varint_length<L>> {
+    static pp::uint<8> make(mt19937_64& gen) {
+        const pp::uint<8> low = L == 1 ? 0 : pp::uint<8>(1) << 7 * (L - 1);
+        const pp::uint<8> high = L >= 10 ? ~pp::uint<8>(0) : (pp::uint<8>(1) << 7 * L) - 1;
+        return uniform_int_distribution<pp::uint<8>>(low, high)(gen);
+    }
+};
+
+// varints whose lengths follow a Zipfian distribution, i.e. a length of `L` bytes is taken in proportion to 1 / L
+struct varint_zipf : value_set<varint_coder<pp::uint<8>>, varint_zipf> {
+    static pp::uint<8> make(mt19937_64& gen) {
+        static discrete_distribution<size_t> length{1.0, 1.0 / 2, 1.0 / 3, 1.0 / 4, 1.0 / 5, 1.0 / 6, 1.0 / 7, 1.0 / 8, 1.0 / 9, 1.0 / 10};
+        switch (length(gen) + 1) {
+            case 1: return varint_length<1>::make(gen);
+            case 2: return varint_length<2>::make(gen);
+            case 3: return varint_length<3>::make(gen);
+            case 4: return varint_length<4>::make(gen);
+            case 5: return varint_length<5>::make(gen);
+            case 6: return varint_length<6>::make(gen);
+            case 7: return varint_length<7>::make(gen);
+            case 8: return varint_length<8>::make(gen);
+            case 9: return varint_length<9>::make(gen);
+            default: return varint_length<10>::make(gen);
+        }
+    }
+};
+
+// zigzag-encoded signed integers of both signs with magnitudes in a geometric distribution
+struct zigzag_values : value_set<varint_coder<sint64>, zigzag_values> {
+    static sint64 make(mt19937_64& gen) {
+        const auto magnitude = static_cast<pp::sint<8>>(gen() >> (gen() % 63 + 1));
+        return sint64(gen() % 2 ? magnitude : -magnitude);
+    }
+};
+
+template <typename T>
+struct integer_values : value_set<integer_coder<T>, integer_values<T>> {
+    static T make(mt19937_64& gen) {
+        return static_cast<T>(gen());
+    }
+};
+
+template <typename T>
+struct float_values : value_set<float_coder<T>, float_values<T>> {
+    static T make(mt19937_64& gen) {
+        return static_cast<T>(uniform_real_distribution<double>(-1e9, 1e9)(gen));
+    }
+};
+
+struct bool_values : value_set<bool_coder, bool_values> {
+    static bool make(mt19937_64& gen) {
+        return gen() % 2;
+    }
+};
+
+enum class color { red, green, blue, cyan = 100, magenta = 1000, yellow = 100000 };
+
+struct enum_values : value_set<enum_coder<color>, enum_values> {
+    static color make(mt19937_64& gen) {
+        constexpr color colors[] = {color::red, color::green, color::blue, color::cyan, color::magenta, color::yellow};
+        return colors[gen() % size(colors)];
+    }
+};
+
+// length-delimited values, i.e. strings of 0 to 64 bytes
+struct string_values : value_set<string_coder, string_values> {
+    static string make(mt19937_64& gen) {
+        return string(gen() % 65, 'x');
+    }
+};
+
+void report_values(benchmark::State& state, size_t bytes) {
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * bytes));
+    state.counters["time/value"] = benchmark::Counter(static_cast<double>(coder_values),
+        benchmark::Counter::kIsIterationInvariantRate | benchmark::Counter::kInvert);
+}
+
+template <typename Values, coder_mode Mode>
+void BM_coder_encode(benchmark::State& state) {
+    const auto& values = Values::values();
+    vector<byte> buffer(Values::encoded().size());
+
+    for (auto _ : state) {
+        bytes b = buffer;
+        for (const auto& x : values) {
+            Mode::get_value_from_result(Values::coder::template encode<Mode>(x, b), b);
+        }
+        benchmark::DoNotOptimize(buffer.data());
+        benchmark::ClobberMemory();
+    }
+    report_values(state, buffer.size());
+}
+
+template <typename Values, coder_mode Mode>
+void BM_coder_decode(benchmark::State& state) {
+    const auto& encoded = Values::encoded();
+    const auto& padded = Values::template padded<Mode>();
+
+    for (auto _ : state) {
+        bytes b{const_cast<byte*>(padded.data()), encoded.size()};
+        for (size_t i = 0; i < coder_values; ++i) {
+            decode_value<typename Values::value_type> v;
+            Mode::get_value_from_result(Values::coder::template decode<Mode>(b), v);
+            benchmark::DoNotOptimize(v.first);
+            b = v.second;
+        }
+    }
+    report_values(state, encoded.size());
+}
+
+template <pp::uint<1> Wire, typename Values, coder_mode Mode>
+void BM_coder_skip(benchmark::State& state) {
+    const auto& encoded = Values::encoded();
+
+    for (auto _ : state) {
+        bytes b{const_cast<byte*>(encoded.data()), encoded.size()};
+        for (size_t i = 0; i < coder_values; ++i) {
+            Mode::get_value_from_result(wire_skip<Wire>::template decode_skip<Mode>(b), b);
+        }
+        benchmark::DoNotOptimize(b);
+    }
+    report_values(state, encoded.size());
+}
+
+#define CODER_BENCHMARKS(Values) \
+    BENCHMARK_TEMPLATE(BM_coder_encode, Values, unsafe_mode); \
+    BENCHMARK_TEMPLATE(BM_coder_encode, Values, safe_mode); \
+    BENCHMARK_TEMPLATE(BM_coder_decode, Values, unsafe_mode); \
+    BENCHMARK_TEMPLATE(BM_coder_decode, Values, safe_mode)
+
+CODER_BENCHMARKS(varint_length<1>);
+CODER_BENCHMARKS(varint_length<2>);
+CODER_BENCHMARKS(varint_length<3>);
+CODER_BENCHMARKS(varint_length<4>);
+CODER_BENCHMARKS(varint_length<5>);
+CODER_BENCHMARKS(varint_length<6>);
+CODER_BENCHMARKS(varint_length<7>);
+CODER_BENCHMARKS(varint_length<8>);
+CODER_BENCHMARKS(varint_length<9>);
+CODER_BENCHMARKS(varint_length<10>);
+CODER_BENCHMARKS(varint_zipf);
+BENCHMARK_TEMPLATE(BM_coder_decode, varint_zipf, slop_mode);
+CODER_BENCHMARKS(zigzag_values);
+CODER_BENCHMARKS(integer_values<pp::uint<4>>);
+CODER_BENCHMARKS(integer_values<pp::uint<8>>);
+CODER_BENCHMARKS(float_values<floating<4>>);
+CODER_BENCHMARKS(float_values<floating<8>>);
+CODER_BENCHMARKS(bool_values);
+CODER_BENCHMARKS(enum_values);
+
+#define SKIP_BENCHMARKS(Wire, Values) \
+    BENCHMARK_TEMPLATE(BM_coder_skip, Wire, Values, unsafe_mode); \
+    BENCHMARK_TEMPLATE(BM_coder_skip, Wire, Values, safe_mode)
+
+SKIP_BENCHMARKS(0, varint_zipf);
+SKIP_BENCHMARKS(1, integer_values<pp::uint<8>>);
+SKIP_BENCHMARKS(2, string_values);
+SKIP_BENCHMARKS(5, integer_values<pp::uint<4>>);
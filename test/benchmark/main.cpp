@@ -12,10 +12,16 @@
 //   See the License for the specific language governing permissions and
 //   limitations under the License.
 
+#include <protopuf/batch.h>
 #include <protopuf/message.h>
+#include <protopuf/path.h>
+#include <protopuf/thread_pool.h>
 #include <benchmark/benchmark.h>
 #include <message.pb.h>
 #include <array>
+#include <memory_resource>
+#include <string>
+#include <vector>
 
 using namespace pp;
 using namespace std;
@@ -95,6 +101,70 @@ void BM_protopuf_safe_decode(benchmark::State& state) {
 }
 BENCHMARK(BM_protopuf_safe_decode);
 
+void BM_protopuf_decode_into(benchmark::State& state) {
+    Class myClass;
+    for(auto _ : state) {
+        auto rest = message_coder<Class>::decode_into<unsafe_mode>(myClass, decode_buffer);
+        benchmark::DoNotOptimize(rest);
+        benchmark::DoNotOptimize(myClass);
+    }
+}
+BENCHMARK(BM_protopuf_decode_into);
+
+void BM_protopuf_safe_decode_into(benchmark::State& state) {
+    Class myClass;
+    for(auto _ : state) {
+        auto rest = message_coder<Class>::decode_into<safe_mode>(myClass, decode_buffer);
+        benchmark::DoNotOptimize(rest);
+        benchmark::DoNotOptimize(myClass);
+    }
+}
+BENCHMARK(BM_protopuf_safe_decode_into);
+
+using PmrStudent = message<pp::pmr::field<"id", 1, varint_coder<uint32>>, pp::pmr::string_field<"name", 3>>;
+using PmrClass = message<pp::pmr::string_field<"name", 8>, pp::pmr::message_field<"students", 3, PmrStudent, repeated>>;
+
+void BM_protopuf_arena_decode(benchmark::State& state) {
+    array<byte, 1024> arena_buffer;
+
+    for(auto _ : state) {
+        std::pmr::monotonic_buffer_resource arena(arena_buffer.data(), arena_buffer.size());
+        auto [myClass, _2] = message_coder<PmrClass>::decode<unsafe_mode>(decode_buffer, &arena);
+        benchmark::DoNotOptimize(myClass);
+    }
+}
+BENCHMARK(BM_protopuf_arena_decode);
+
+void BM_protopuf_safe_arena_decode(benchmark::State& state) {
+    array<byte, 1024> arena_buffer;
+
+    for(auto _ : state) {
+        std::pmr::monotonic_buffer_resource arena(arena_buffer.data(), arena_buffer.size());
+        auto [myClass, _2] = *message_coder<PmrClass>::decode<safe_mode>(decode_buffer, &arena);
+        benchmark::DoNotOptimize(myClass);
+    }
+}
+BENCHMARK(BM_protopuf_safe_arena_decode);
+
+using InlineStudent = message<uint32_field<"id", 1>, inline_string_field<"name", 3, 15>>;
+using InlineClass = message<inline_string_field<"name", 8, 15>, message_field<"students", 3, InlineStudent, repeated, small_vector<InlineStudent, 4>>>;
+
+void BM_protopuf_inline_decode(benchmark::State& state) {
+    for(auto _ : state) {
+        auto [myClass, _2] = message_coder<InlineClass>::decode<unsafe_mode>(decode_buffer);
+        benchmark::DoNotOptimize(myClass);
+    }
+}
+BENCHMARK(BM_protopuf_inline_decode);
+
+void BM_protopuf_safe_inline_decode(benchmark::State& state) {
+    for(auto _ : state) {
+        auto [myClass, _2] = *message_coder<InlineClass>::decode<safe_mode>(decode_buffer);
+        benchmark::DoNotOptimize(myClass);
+    }
+}
+BENCHMARK(BM_protopuf_safe_inline_decode);
+
 void BM_protobuf_decode(benchmark::State& state) {
     for(auto _ : state) {
         pb::Class myClass;
@@ -104,4 +174,167 @@ void BM_protobuf_decode(benchmark::State& state) {
 }
 BENCHMARK(BM_protobuf_decode);
 
+void BM_protopuf_decode_student_ids(benchmark::State& state) {
+    for(auto _ : state) {
+        auto [myClass, _2] = message_coder<Class>::decode<unsafe_mode>(decode_buffer);
+        uint32 sum = 0;
+        for(const auto& student : myClass["students"_f]) {
+            sum += *student["id"_f];
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+}
+BENCHMARK(BM_protopuf_decode_student_ids);
+
+void BM_protopuf_extract_student_ids(benchmark::State& state) {
+    for(auto _ : state) {
+        uint32 sum = 0;
+        field_name_path<Class, "students", "id">::extract<unsafe_mode>(decode_buffer, [&sum](uint32 id) {
+            sum += id;
+        });
+        benchmark::DoNotOptimize(sum);
+    }
+}
+BENCHMARK(BM_protopuf_extract_student_ids);
+
+void BM_protopuf_safe_extract_student_ids(benchmark::State& state) {
+    for(auto _ : state) {
+        uint32 sum = 0;
+        field_name_path<Class, "students", "id">::extract<safe_mode>(decode_buffer, [&sum](uint32 id) {
+            sum += id;
+        });
+        benchmark::DoNotOptimize(sum);
+    }
+}
+BENCHMARK(BM_protopuf_safe_extract_student_ids);
+
+const Class& large_class() {
+    static const Class c = [] {
+        Class c {"class 101", vector<Student>{}};
+        for (uint32 i = 0; i < 100'000; ++i) {
+            c["students"_f].push_back(Student{i, "student " + to_string(i)});
+        }
+        return c;
+    }();
+
+    return c;
+}
+
+const vector<byte>& large_class_buffer() {
+    static const vector<byte> buffer = [] {
+        vector<byte> b(skipper<message_coder<Class>>::encode_skip(large_class()));
+        message_coder<Class>::encode<unsafe_mode>(large_class(), b);
+        return b;
+    }();
+
+    return buffer;
+}
+
+void BM_protopuf_large_encode(benchmark::State& state) {
+    vector<byte> buffer(large_class_buffer().size());
+
+    for(auto _ : state) {
+        auto result = message_coder<Class>::encode<safe_mode>(large_class(), buffer);
+        benchmark::DoNotOptimize(result);
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * buffer.size()));
+}
+BENCHMARK(BM_protopuf_large_encode)->Unit(benchmark::kMillisecond);
+
+void BM_protopuf_large_parallel_encode(benchmark::State& state) {
+    vector<byte> buffer(large_class_buffer().size());
+    thread_pool pool(state.range(0));
+
+    for(auto _ : state) {
+        auto result = message_coder<Class>::encode<safe_mode>(large_class(), buffer, pool);
+        benchmark::DoNotOptimize(result);
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * buffer.size()));
+}
+BENCHMARK(BM_protopuf_large_parallel_encode)->RangeMultiplier(2)->Range(1, 32)->UseRealTime()->Unit(benchmark::kMillisecond);
+
+void BM_protopuf_large_decode(benchmark::State& state) {
+    bytes buffer{const_cast<byte*>(large_class_buffer().data()), large_class_buffer().size()};
+
+    for(auto _ : state) {
+        auto myClass = message_coder<Class>::decode<safe_mode>(buffer);
+        benchmark::DoNotOptimize(myClass);
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * buffer.size()));
+}
+BENCHMARK(BM_protopuf_large_decode)->Unit(benchmark::kMillisecond);
+
+void BM_protopuf_large_reserved_decode(benchmark::State& state) {
+    bytes buffer{const_cast<byte*>(large_class_buffer().data()), large_class_buffer().size()};
+
+    for(auto _ : state) {
+        auto myClass = message_coder<Class>::decode<safe_mode>(buffer, reserve_repeated);
+        benchmark::DoNotOptimize(myClass);
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * buffer.size()));
+}
+BENCHMARK(BM_protopuf_large_reserved_decode)->Unit(benchmark::kMillisecond);
+
+void BM_protopuf_large_parallel_decode(benchmark::State& state) {
+    bytes buffer{const_cast<byte*>(large_class_buffer().data()), large_class_buffer().size()};
+    thread_pool pool(state.range(0));
+
+    for(auto _ : state) {
+        auto myClass = message_coder<Class>::decode<safe_mode>(buffer, pool);
+        benchmark::DoNotOptimize(myClass);
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * buffer.size()));
+}
+BENCHMARK(BM_protopuf_large_parallel_decode)->RangeMultiplier(2)->Range(1, 32)->UseRealTime()->Unit(benchmark::kMillisecond);
+
+const vector<Class>& batch_classes() {
+    static const vector<Class> classes = [] {
+        vector<Class> v;
+        for (uint32 i = 0; i < 100'000; ++i) {
+            v.push_back(Class{"class " + to_string(i), {Student{i, "tom"}, Student{i + 1, "jerry"}, Student{i + 2, "twice"}}});
+        }
+        return v;
+    }();
+
+    return classes;
+}
+
+const vector<bytes>& batch_buffers() {
+    static vector<array<byte, 64>> storage(batch_classes().size());
+    static const vector<bytes> buffers = [] {
+        vector<bytes> v(storage.begin(), storage.end());
+        sequential_executor seq;
+        encode_batch<Class, unsafe_mode>(span(batch_classes()), span(v), seq);
+        return v;
+    }();
+
+    return buffers;
+}
+
+void BM_protopuf_batch_encode(benchmark::State& state) {
+    vector<array<byte, 64>> storage(batch_classes().size());
+    vector<bytes> buffers(batch_classes().size());
+    thread_pool pool(state.range(0));
+
+    for(auto _ : state) {
+        buffers.assign(storage.begin(), storage.end());
+        auto result = encode_batch<Class>(span(batch_classes()), span(buffers), pool);
+        benchmark::DoNotOptimize(result);
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * batch_classes().size()));
+}
+BENCHMARK(BM_protopuf_batch_encode)->RangeMultiplier(2)->Range(1, 32)->UseRealTime()->Unit(benchmark::kMillisecond);
+
+void BM_protopuf_batch_decode(benchmark::State& state) {
+    vector<Class> classes(batch_buffers().size());
+    thread_pool pool(state.range(0));
+
+    for(auto _ : state) {
+        auto result = decode_batch<Class>(span(batch_buffers()), span(classes), pool);
+        benchmark::DoNotOptimize(result);
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * batch_buffers().size()));
+}
+BENCHMARK(BM_protopuf_batch_decode)->RangeMultiplier(2)->Range(1, 32)->UseRealTime()->Unit(benchmark::kMillisecond);
+
 BENCHMARK_MAIN();
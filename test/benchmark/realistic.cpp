@@ -0,0 +1,483 @@
+//   Copyright 2020-2021 PragmaTwice
+//
+//   Licensed under the Apache License, Version 2.0 (the "License");
+//   you may not use this file except in compliance with the License.
+//   You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the License is distributed on an "AS IS" BASIS,
+//   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//   See the License for the specific language governing permissions and
+//   limitations under the License.
+
+// Benchmarks over realistic message shapes (wide, deep, packed, string-heavy, maps and unknown fields),
+// comparing protopuf in unsafe and safe modes with protobuf (with and without arenas).
+// Inputs are generated deterministically, and every benchmark reports bytes per second and allocations per operation.
+
+#include <protopuf/map.h>
+#include <protopuf/message.h>
+#include <benchmark/benchmark.h>
+#include <google/protobuf/arena.h>
+#include <realistic.pb.h>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <optional>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace pp;
+using namespace std;
+
+// Every allocation of the process is counted, so that allocations per operation can be reported
+
+static atomic<size_t> allocation_count = 0;
+
+void* operator new(size_t size) {
+    allocation_count.fetch_add(1, memory_order_relaxed);
+    if (void* p = malloc(size ? size : 1)) {
+        return p;
+    }
+    throw bad_alloc();
+}
+
+void* operator new[](size_t size) {
+    return operator new(size);
+}
+
+void operator delete(void* p) noexcept {
+    free(p);
+}
+
+void operator delete[](void* p) noexcept {
+    free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+    free(p);
+}
+
+void operator delete[](void* p, size_t) noexcept {
+    free(p);
+}
+
+// Counts allocations during the benchmark loop, and reports them per iteration when it is destroyed
+class allocation_counter {
+public:
+    explicit allocation_counter(benchmark::State& state) : state(state), start(allocation_count.load(memory_order_relaxed)) {}
+
+    ~allocation_counter() {
+        state.counters["allocs/op"] = benchmark::Counter(
+            static_cast<double>(allocation_count.load(memory_order_relaxed) - start), benchmark::Counter::kAvgIterations);
+    }
+
+private:
+    benchmark::State& state;
+    size_t start;
+};
+
+// Generates values deterministically, where varints take every length from 1 byte up to the width of the type
+class generator {
+public:
+    template <typename T>
+    T varint() {
+        const auto bits = gen() % (sizeof(T) * 8) + 1;
+        return static_cast<T>(gen() & (bits == 64 ? ~0ull : (1ull << bits) - 1));
+    }
+
+    double real() {
+        return uniform_real_distribution<double>(-1e6, 1e6)(gen);
+    }
+
+    string text(size_t min, size_t max) {
+        string s(min + gen() % (max - min + 1), ' ');
+        for (auto& c : s) {
+            c = static_cast<char>('a' + gen() % 26);
+        }
+        return s;
+    }
+
+    uint64_t operator()() {
+        return gen();
+    }
+
+private:
+    mt19937_64 gen{20240601};
+};
+
+template <message_c T>
+vector<byte> encode_to_vector(const T& m) {
+    vector<byte> v(skipper<message_coder<T>>::encode_skip(m));
+    message_coder<T>::template encode<safe_mode>(m, v);
+    return v;
+}
+
+// Wide: a flat message of 120 scalar fields, i.e. uint32, int64, sint32 and double fields in turn
+
+template <size_t I>
+constexpr basic_fixed_string<char, 5> wide_name = [] {
+    const char name[5] = {'f', char('0' + I / 100), char('0' + I / 10 % 10), char('0' + I % 10), '\0'};
+    return basic_fixed_string<char, 5>(name);
+}();
+
+template <size_t I>
+using wide_field = conditional_t<I % 4 == 0, uint32_field<wide_name<I>, I + 1>,
+    conditional_t<I % 4 == 1, int64_field<wide_name<I>, I + 1>,
+    conditional_t<I % 4 == 2, sint32_field<wide_name<I>, I + 1>, double_field<wide_name<I>, I + 1>>>>;
+
+template <typename>
+struct wide_message;
+
+template <size_t... I>
+struct wide_message<index_sequence<I...>> {
+    using type = message<wide_field<I>...>;
+};
+
+using Wide = wide_message<make_index_sequence<120>>::type;
+
+struct wide_shape {
+    using message_type = Wide;
+    using pb_type = pb::Wide;
+
+    static Wide make() {
+        generator gen;
+        Wide m;
+        m.for_each([&gen](auto&& f) {
+            using T = typename remove_cvref_t<decltype(f)>::coder::value_type;
+            if constexpr (is_same_v<T, floating<8>>) {
+                f = gen.real();
+            } else if constexpr (is_same_v<T, sint32>) {
+                f = sint32(gen.varint<pp::uint<4>>() - (1u << 31));
+            } else {
+                f = gen.varint<T>();
+            }
+        });
+        return m;
+    }
+};
+
+// Unknown fields: wide messages decoded into a message declaring only two of their fields,
+// where the rest is skipped, or preserved (and encoded again) by an unknown_fields_field.
+// Protobuf always keeps unknown fields in parsed messages, so it is only compared with the preserving one.
+
+using Narrow = message<uint32_field<"f000", 1>, int64_field<"f001", 2>>;
+using NarrowProxy = message<uint32_field<"f000", 1>, int64_field<"f001", 2>, unknown_fields_field<"unknown">>;
+
+struct unknown_skipped_shape {
+    using message_type = Narrow;
+
+    static Wide make() {
+        return wide_shape::make();
+    }
+};
+
+struct unknown_preserved_shape {
+    using message_type = NarrowProxy;
+    using pb_type = pb::Narrow;
+
+    static Wide make() {
+        return wide_shape::make();
+    }
+};
+
+// Deep: a complete binary tree of depth 10 (1023 nodes), where every level is a distinct message type
+
+template <size_t Depth>
+struct node {
+    using type = message<uint32_field<"id", 1>, string_field<"name", 2>,
+        message_field<"children", 3, typename node<Depth - 1>::type, repeated>>;
+};
+
+template <>
+struct node<1> {
+    using type = message<uint32_field<"id", 1>, string_field<"name", 2>>;
+};
+
+constexpr size_t tree_depth = 10;
+
+using Tree = node<tree_depth>::type;
+
+template <size_t Depth>
+typename node<Depth>::type make_tree(generator& gen) {
+    typename node<Depth>::type m;
+    m["id"_f] = gen.varint<pp::uint<4>>();
+    m["name"_f] = gen.text(4, 16);
+    if constexpr (Depth > 1) {
+        m["children"_f].push_back(make_tree<Depth - 1>(gen));
+        m["children"_f].push_back(make_tree<Depth - 1>(gen));
+    }
+    return m;
+}
+
+struct deep_shape {
+    using message_type = Tree;
+    using pb_type = pb::Node;
+
+    static Tree make() {
+        generator gen;
+        return make_tree<tree_depth>(gen);
+    }
+};
+
+// Packed: 16384 elements in each of packed fields of small, mixed-length and signed varints, doubles and fixed32s
+
+using Packed = message<uint32_field<"small", 1, packed>, uint64_field<"mixed", 2, packed>, sint64_field<"deltas", 3, packed>,
+    double_field<"reals", 4, packed>, fixed32_field<"hashes", 5, packed>>;
+
+struct packed_shape {
+    using message_type = Packed;
+    using pb_type = pb::Packed;
+
+    static Packed make() {
+        generator gen;
+        Packed m;
+        for (size_t i = 0; i < 16384; ++i) {
+            m["small"_f].push_back(gen() % 128);
+            m["mixed"_f].push_back(gen.varint<pp::uint<8>>());
+            m["deltas"_f].push_back(sint64(static_cast<pp::sint<8>>(gen() % 2001) - 1000));
+            m["reals"_f].push_back(gen.real());
+            m["hashes"_f].push_back(static_cast<pp::uint<4>>(gen()));
+        }
+        return m;
+    }
+};
+
+// Strings: 2000 short names and 200 long texts
+
+using Strings = message<string_field<"title", 1>, string_field<"names", 2, repeated>, string_field<"texts", 3, repeated>>;
+
+struct strings_shape {
+    using message_type = Strings;
+    using pb_type = pb::Strings;
+
+    static Strings make() {
+        generator gen;
+        Strings m;
+        m["title"_f] = gen.text(32, 32);
+        for (size_t i = 0; i < 2000; ++i) {
+            m["names"_f].push_back(gen.text(4, 32));
+        }
+        for (size_t i = 0; i < 200; ++i) {
+            m["texts"_f].push_back(gen.text(256, 2048));
+        }
+        return m;
+    }
+};
+
+// Maps: 1000 entries in each of a string-to-integer map and an integer-to-string map
+
+using Maps = message<map_field<"counters", 1, string_coder, varint_coder<pp::uint<8>>>,
+    map_field<"labels", 2, varint_coder<pp::uint<4>>, string_coder>>;
+
+struct maps_shape {
+    using message_type = Maps;
+    using pb_type = pb::Maps;
+
+    static Maps make() {
+        generator gen;
+        Maps m;
+        for (size_t i = 0; i < 1000; ++i) {
+            m["counters"_f].emplace(gen.text(8, 24), gen.varint<pp::uint<8>>());
+            m["labels"_f].emplace(gen.varint<pp::uint<4>>(), gen.text(8, 24));
+        }
+        return m;
+    }
+};
+
+// the encoded input of a shape, which is decoded by the decoding benchmarks
+template <typename Shape>
+const vector<byte>& shape_input() {
+    static const vector<byte> input = encode_to_vector(Shape::make());
+    return input;
+}
+
+// the message decoded from the input of a shape, which is encoded by the encoding benchmarks, or null if it fails to decode
+template <typename Shape>
+const typename Shape::message_type* shape_message() {
+    static const auto m = []() -> optional<typename Shape::message_type> {
+        const auto& input = shape_input<Shape>();
+        auto result = message_coder<typename Shape::message_type>::template decode<safe_mode>(bytes{const_cast<byte*>(input.data()), input.size()});
+        if (!result) {
+            return nullopt;
+        }
+        return std::move(result->first);
+    }();
+    return m ? &*m : nullptr;
+}
+
+// the protobuf message parsed from the input of a shape, or null if it fails to parse
+template <typename Shape>
+const typename Shape::pb_type* shape_pb_message() {
+    static const auto m = []() -> optional<typename Shape::pb_type> {
+        typename Shape::pb_type pb;
+        if (!pb.ParseFromArray(shape_input<Shape>().data(), static_cast<int>(shape_input<Shape>().size()))) {
+            return nullopt;
+        }
+        return pb;
+    }();
+    return m ? &*m : nullptr;
+}
+
+// whether a result of the coder mode `Mode` is a success, which is not checked in unsafe mode
+template <coder_mode Mode, typename R>
+bool succeeded(const R& result) {
+    if constexpr (same_as<Mode, unsafe_mode>) {
+        return true;
+    } else {
+        return result.has_value();
+    }
+}
+
+template <typename Shape, coder_mode Mode>
+void BM_realistic_encode(benchmark::State& state) {
+    using T = typename Shape::message_type;
+
+    const auto* m = shape_message<Shape>();
+    if (!m) {
+        state.SkipWithError("the input fails to decode");
+        return;
+    }
+    vector<byte> buffer(skipper<message_coder<T>>::encode_skip(*m));
+
+    {
+        allocation_counter counter(state);
+        for (auto _ : state) {
+            auto result = message_coder<T>::template encode<Mode>(*m, buffer);
+            if (!succeeded<Mode>(result)) {
+                state.SkipWithError("the message fails to encode");
+                break;
+            }
+            benchmark::DoNotOptimize(result);
+        }
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * buffer.size()));
+}
+
+template <typename Shape, coder_mode Mode>
+void BM_realistic_decode(benchmark::State& state) {
+    using T = typename Shape::message_type;
+
+    const auto& input = shape_input<Shape>();
+    const bytes b{const_cast<byte*>(input.data()), input.size()};
+
+    {
+        allocation_counter counter(state);
+        for (auto _ : state) {
+            auto result = message_coder<T>::template decode<Mode>(b);
+            if (!succeeded<Mode>(result)) {
+                state.SkipWithError("the input fails to decode");
+                break;
+            }
+            benchmark::DoNotOptimize(result);
+        }
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * input.size()));
+}
+
+// decoding into the same message repeatedly, which reuses its storage
+template <typename Shape, coder_mode Mode>
+void BM_realistic_decode_into(benchmark::State& state) {
+    using T = typename Shape::message_type;
+
+    const auto& input = shape_input<Shape>();
+    const bytes b{const_cast<byte*>(input.data()), input.size()};
+    T m;
+
+    {
+        allocation_counter counter(state);
+        for (auto _ : state) {
+            auto result = message_coder<T>::template decode_into<Mode>(m, b);
+            if (!succeeded<Mode>(result)) {
+                state.SkipWithError("the input fails to decode");
+                break;
+            }
+            benchmark::DoNotOptimize(result);
+            benchmark::DoNotOptimize(m);
+        }
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * input.size()));
+}
+
+template <typename Shape>
+void BM_realistic_protobuf_encode(benchmark::State& state) {
+    const auto* m = shape_pb_message<Shape>();
+    if (!m) {
+        state.SkipWithError("the input fails to parse");
+        return;
+    }
+    vector<byte> buffer(m->ByteSizeLong());
+
+    {
+        allocation_counter counter(state);
+        for (auto _ : state) {
+            if (!m->SerializeToArray(buffer.data(), static_cast<int>(buffer.size()))) {
+                state.SkipWithError("the message fails to serialize");
+                break;
+            }
+            benchmark::DoNotOptimize(buffer.data());
+        }
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * buffer.size()));
+}
+
+template <typename Shape>
+void BM_realistic_protobuf_decode(benchmark::State& state) {
+    const auto& input = shape_input<Shape>();
+
+    {
+        allocation_counter counter(state);
+        for (auto _ : state) {
+            typename Shape::pb_type m;
+            if (!m.ParseFromArray(input.data(), static_cast<int>(input.size()))) {
+                state.SkipWithError("the input fails to parse");
+                break;
+            }
+            benchmark::DoNotOptimize(m);
+        }
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * input.size()));
+}
+
+template <typename Shape>
+void BM_realistic_protobuf_arena_decode(benchmark::State& state) {
+    const auto& input = shape_input<Shape>();
+
+    {
+        allocation_counter counter(state);
+        for (auto _ : state) {
+            google::protobuf::Arena arena;
+            auto* m = google::protobuf::Arena::CreateMessage<typename Shape::pb_type>(&arena);
+            if (!m->ParseFromArray(input.data(), static_cast<int>(input.size()))) {
+                state.SkipWithError("the input fails to parse");
+                break;
+            }
+            benchmark::DoNotOptimize(m);
+        }
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * input.size()));
+}
+
+#define PROTOPUF_REALISTIC_BENCHMARKS(Shape) \
+    BENCHMARK_TEMPLATE(BM_realistic_encode, Shape, unsafe_mode); \
+    BENCHMARK_TEMPLATE(BM_realistic_encode, Shape, safe_mode); \
+    BENCHMARK_TEMPLATE(BM_realistic_decode, Shape, unsafe_mode); \
+    BENCHMARK_TEMPLATE(BM_realistic_decode, Shape, safe_mode); \
+    BENCHMARK_TEMPLATE(BM_realistic_decode_into, Shape, safe_mode)
+
+#define REALISTIC_BENCHMARKS(Shape) \
+    PROTOPUF_REALISTIC_BENCHMARKS(Shape); \
+    BENCHMARK_TEMPLATE(BM_realistic_protobuf_encode, Shape); \
+    BENCHMARK_TEMPLATE(BM_realistic_protobuf_decode, Shape); \
+    BENCHMARK_TEMPLATE(BM_realistic_protobuf_arena_decode, Shape)
+
+REALISTIC_BENCHMARKS(wide_shape);
+REALISTIC_BENCHMARKS(deep_shape);
+REALISTIC_BENCHMARKS(packed_shape);
+REALISTIC_BENCHMARKS(strings_shape);
+REALISTIC_BENCHMARKS(maps_shape);
+PROTOPUF_REALISTIC_BENCHMARKS(unknown_skipped_shape);
+REALISTIC_BENCHMARKS(unknown_preserved_shape);
@@ -65,3 +65,22 @@ GTEST_TEST(static, coder) {
     enum E{};
     static_assert(coder<enum_coder<E>>);
 }
+
+GTEST_TEST(static, in_place_decoder) {
+    static_assert(in_place_decoder<integer_coder<pp::uint<4>>, safe_mode>);
+    static_assert(in_place_decoder<integer_coder<sint<8>>, unsafe_mode>);
+    static_assert(in_place_decoder<integer_coder<sint_zigzag<4>>, safe_mode>);
+    static_assert(in_place_decoder<varint_coder<pp::uint<8>>, safe_mode>);
+    static_assert(in_place_decoder<varint_coder<sint<4>>, unsafe_mode>);
+    static_assert(in_place_decoder<varint_coder<sint_zigzag<8>>, safe_mode>);
+    static_assert(in_place_decoder<float_coder<floating<8>>, safe_mode>);
+    static_assert(in_place_decoder<bool_coder, safe_mode>);
+
+    enum E{};
+    static_assert(in_place_decoder<enum_coder<E>, unsafe_mode>);
+
+    static_assert(in_place_decoder<string_coder, safe_mode>);
+    static_assert(in_place_decoder<array_coder<varint_coder<sint<2>>>, safe_mode>);
+    static_assert(in_place_decoder<message_coder<message<integer_field<"", 1, int>, string_field<"", 2>>>, safe_mode>);
+    static_assert(in_place_decoder<embedded_message_coder<message<integer_field<"", 1, int>>>, unsafe_mode>);
+}
@@ -0,0 +1,251 @@
+//   Copyright 2020-2021 PragmaTwice
+//
+//   Licensed under the Apache License, Version 2.0 (the "License");
+//   you may not use this file except in compliance with the License.
+//   You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the License is distributed on an "AS IS" BASIS,
+//   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//   See the License for the specific language governing permissions and
+//   limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <protopuf/message.h>
+#include <protopuf/thread_pool.h>
+#include <array>
+#include <random>
+#include <vector>
+
+using namespace pp;
+using namespace std;
+
+GTEST_TEST(error_mode, static) {
+    static_assert(coder_mode<error_mode>);
+    static_assert(in_place_decoder<varint_coder<pp::uint<8>>, error_mode>);
+    static_assert(in_place_decoder<string_coder, error_mode>);
+
+    // a failure takes no more room than an empty std::optional
+    static_assert(sizeof(error_result<bytes>) == sizeof(optional<bytes>));
+}
+
+GTEST_TEST(error_mode, truncated) {
+    array<byte, 3> a{0x01_b, 0x02_b, 0x03_b};
+    auto result = integer_coder<pp::uint<4>>::decode<error_mode>(a);
+    ASSERT_FALSE(result);
+    EXPECT_EQ(result.error().code, coder_error_code::truncated);
+    EXPECT_EQ(result.error().offset(a), 0);
+
+    array<byte, 2> varint{0x80_b, 0x80_b};
+    auto varint_result = varint_coder<pp::uint<4>>::decode<error_mode>(varint);
+    ASSERT_FALSE(varint_result);
+    EXPECT_EQ(varint_result.error().code, coder_error_code::truncated);
+    EXPECT_EQ(varint_result.error().offset(varint), 2);
+
+    // encoding into a small buffer
+    array<byte, 4> buffer{};
+    auto encode_result = varint_coder<pp::uint<8>>::encode<error_mode>(1ull << 40, buffer);
+    ASSERT_FALSE(encode_result);
+    EXPECT_EQ(encode_result.error().code, coder_error_code::truncated);
+    EXPECT_EQ(encode_result.error().offset(buffer), 4);
+}
+
+GTEST_TEST(error_mode, overlong_varint) {
+    array<byte, 12> a{};
+    fill(a.begin(), a.end(), 0xff_b);
+
+    // a negative int32 is encoded in 10 bytes
+    a[9] = 0x01_b;
+    decode_value<int32> value;
+    ASSERT_TRUE(error_mode::get_value_from_result(varint_coder<int32>::decode<error_mode>(a), value));
+    EXPECT_EQ(value.first, -1);
+    EXPECT_EQ(begin_diff(value.second, a), 10);
+
+    a[9] = 0xff_b;
+    auto result = varint_coder<pp::uint<8>>::decode<error_mode>(bytes(a).subspan(1));
+    ASSERT_FALSE(result);
+    EXPECT_EQ(result.error().code, coder_error_code::overlong_varint);
+    EXPECT_EQ(result.error().offset(a), 1);
+
+    pp::uint<4> out = 0;
+    EXPECT_FALSE(varint_coder<pp::uint<4>>::decode_to<safe_mode>(out, a));
+}
+
+using Student = message<uint32_field<"id", 1>, string_field<"name", 3>>;
+using Class = message<uint32_field<"id", 1>, message_field<"students", 2, Student, repeated>>;
+
+GTEST_TEST(error_mode, message) {
+    // students[0] = {id: 1, name: "ab" with a length of 5}
+    array<byte, 10> overflow{0x08_b, 0x01_b, 0x12_b, 0x06_b, 0x08_b, 0x01_b, 0x1a_b, 0x05_b, 0x61_b, 0x62_b};
+    auto result = message_coder<Class>::decode<error_mode>(overflow);
+    ASSERT_FALSE(result);
+    EXPECT_EQ(result.error().code, coder_error_code::length_overflow);
+    EXPECT_EQ(result.error().offset(overflow), 8);
+
+    // an unknown field 4 of the group wire type (3)
+    array<byte, 4> group{0x08_b, 0x01_b, 0x23_b, 0x24_b};
+    auto group_result = message_coder<Class>::decode<error_mode>(group);
+    ASSERT_FALSE(group_result);
+    EXPECT_EQ(group_result.error().code, coder_error_code::bad_wire_type);
+    EXPECT_EQ(group_result.error().offset(group), 3);
+
+    // the same bytes are decoded successfully after the failures
+    decode_value<Class> value;
+    ASSERT_TRUE(error_mode::get_value_from_result(message_coder<Class>::decode<error_mode>(bytes(overflow).first(2)), value));
+    EXPECT_EQ(value.first["id"_f], 1);
+}
+
+GTEST_TEST(error_mode, capacity_exceeded) {
+    using Ids = message<uint32_field<"ids", 1, packed, static_vector<pp::uint<4>, 2>>>;
+
+    array<byte, 5> a{0x0a_b, 0x03_b, 0x01_b, 0x02_b, 0x03_b};
+    auto result = message_coder<Ids>::decode<error_mode>(a);
+    ASSERT_FALSE(result);
+    EXPECT_EQ(result.error().code, coder_error_code::capacity_exceeded);
+    EXPECT_EQ(result.error().offset(a), 4);
+}
+
+GTEST_TEST(error_mode, invalid_utf8) {
+    using M = message<uint32_field<"id", 1>, utf8_string_field<"name", 2>>;
+
+    array<byte, 6> a{0x08_b, 0x01_b, 0x12_b, 0x02_b, 0xc0_b, 0xaf_b};
+    auto result = message_coder<M>::decode<error_mode>(a);
+    ASSERT_FALSE(result);
+    EXPECT_EQ(result.error().code, coder_error_code::invalid_utf8);
+    EXPECT_EQ(result.error().offset(a), 4);
+}
+
+GTEST_TEST(error_mode, clear) {
+    array<byte, 12> overlong{};
+    fill(overlong.begin(), overlong.end(), 0xff_b);
+    EXPECT_FALSE(varint_coder<pp::uint<8>>::decode<error_mode>(overlong));
+    EXPECT_EQ(last_coder_error.code, coder_error_code::overlong_varint);
+
+    // successful coders never touch the failure, which is cleared by the entry point of coding a message
+    array<byte, 1> one{0x01_b};
+    EXPECT_TRUE(varint_coder<pp::uint<8>>::decode<error_mode>(one));
+    EXPECT_EQ(last_coder_error.code, coder_error_code::overlong_varint);
+
+    array<byte, 2> a{0x08_b, 0x01_b};
+    EXPECT_TRUE(message_coder<Student>::decode<error_mode>(a));
+    EXPECT_EQ(last_coder_error, coder_error{});
+}
+
+GTEST_TEST(error_mode, thread_pool) {
+    // students = {id: 0}, ..., {id: 63}, where the id of students[40] is truncated
+    vector<byte> a;
+    size_t bad = 0;
+    for (uint8_t i = 0; i < 64; ++i) {
+        if (i == 40) {
+            a.insert(a.end(), {0x12_b, 0x02_b, 0x08_b, 0x80_b});
+            bad = a.size();
+        } else {
+            a.insert(a.end(), {0x12_b, 0x02_b, 0x08_b, byte(i)});
+        }
+    }
+
+    // a stale failure from an unrelated coding
+    array<byte, 12> overlong{};
+    fill(overlong.begin(), overlong.end(), 0xff_b);
+    EXPECT_FALSE(varint_coder<pp::uint<8>>::decode<error_mode>(overlong));
+    EXPECT_EQ(last_coder_error.code, coder_error_code::overlong_varint);
+
+    thread_pool pool(4);
+    auto result = message_coder<Class>::decode<error_mode>(a, pool);
+    ASSERT_FALSE(result);
+    EXPECT_EQ(result.error().code, coder_error_code::truncated);
+    EXPECT_EQ(result.error().offset(a), bad);
+
+    // a success clears the failure
+    decode_value<Class> value;
+    ASSERT_TRUE(error_mode::get_value_from_result(message_coder<Class>::decode<error_mode>(bytes(a).first(bad - 4), pool), value));
+    EXPECT_EQ(value.first["students"_f].size(), 40);
+    EXPECT_EQ(last_coder_error, coder_error{});
+
+    // students do not fit in a bounded container
+    using Bounded = message<message_field<"students", 2, Student, repeated, static_vector<Student, 8>>>;
+    static_assert(is_parallel_decodable<Bounded::get_type_by_number<2>>);
+    auto bounded = message_coder<Bounded>::decode<error_mode>(bytes(a).first(bad - 4), pool);
+    ASSERT_FALSE(bounded);
+    EXPECT_EQ(bounded.error().code, coder_error_code::capacity_exceeded);
+    EXPECT_EQ(bounded.error().offset(a), 2);
+}
+
+GTEST_TEST(slop_mode, static) {
+    static_assert(coder_mode<slop_mode>);
+    static_assert(readable_slop<slop_mode> == 16);
+    static_assert(readable_slop<safe_mode> == 0);
+    static_assert(in_place_decoder<varint_coder<pp::uint<8>>, slop_mode>);
+}
+
+GTEST_TEST(slop_mode, varint) {
+    // the decoded bytes are the first ones, and the rest are the slop
+    array<byte, 2 + slop_mode::slop_size> a{};
+    fill(a.begin(), a.end(), 0x80_b);
+    a[1] = 0x01_b;
+
+    decode_value<pp::uint<4>> value;
+    ASSERT_TRUE(slop_mode::get_value_from_result(varint_coder<pp::uint<4>>::decode<slop_mode>(bytes(a).first(2)), value));
+    EXPECT_EQ(value.first, 128);
+    EXPECT_EQ(begin_diff(value.second, a), 2);
+
+    // the varint continues into the slop
+    a[1] = 0x81_b, a[4] = 0x01_b;
+    EXPECT_FALSE(varint_coder<pp::uint<4>>::decode<slop_mode>(bytes(a).first(2)));
+    pp::uint<4> out = 0;
+    EXPECT_FALSE(varint_coder<pp::uint<4>>::decode_to<slop_mode>(out, bytes(a).first(2)));
+    EXPECT_FALSE(skipper<varint_coder<pp::uint<4>>>::decode_skip<slop_mode>(bytes(a).first(2)));
+    EXPECT_TRUE(skipper<varint_coder<pp::uint<4>>>::decode_skip<slop_mode>(bytes(a).first(5)));
+
+    // an overlong varint
+    fill(a.begin(), a.end(), 0xff_b);
+    EXPECT_FALSE(varint_coder<pp::uint<8>>::decode<slop_mode>(a));
+    EXPECT_FALSE(varint_coder<pp::uint<8>>::decode<slop_mode>(bytes(a).first(3)));
+}
+
+GTEST_TEST(slop_mode, message) {
+    Class c{1, vector<Student>{Student{2, "a long enough name"}, Student{3, "b"}}};
+
+    array<byte, 64 + slop_mode::slop_size> a{};
+    bytes b;
+    ASSERT_TRUE(slop_mode::get_value_from_result(message_coder<Class>::encode<slop_mode>(c, a), b));
+    const auto size = begin_diff(b, a);
+
+    decode_value<Class> value;
+    ASSERT_TRUE(slop_mode::get_value_from_result(message_coder<Class>::decode<slop_mode>(bytes(a).first(size)), value));
+    EXPECT_EQ(value.first, c);
+    EXPECT_EQ(begin_diff(value.second, a), size);
+
+    // every truncation fails as in safe mode, while the bytes following the end are never decoded
+    for (size_t n = 0; n < size; ++n) {
+        fill(a.begin() + n, a.end(), 0x80_b);
+        EXPECT_EQ(bool(message_coder<Class>::decode<slop_mode>(bytes(a).first(n))),
+                  bool(message_coder<Class>::decode<safe_mode>(bytes(a).first(n)))) << n;
+        message_coder<Class>::encode<slop_mode>(c, a);
+    }
+}
+
+GTEST_TEST(slop_mode, random) {
+    // random bytes followed by the slop are decoded as in safe mode
+    mt19937 gen(7);
+    const array<byte, 8> alphabet{0x08_b, 0x12_b, 0x1a_b, 0x02_b, 0x80_b, 0xff_b, 0x01_b, 0x61_b};
+
+    for (size_t i = 0; i < 20000; ++i) {
+        vector<byte> v(gen() % 24 + slop_mode::slop_size);
+        for (auto& x : v) {
+            x = alphabet[gen() % alphabet.size()];
+        }
+        const bytes b = bytes(v).first(v.size() - slop_mode::slop_size);
+
+        auto slop = message_coder<Class>::decode<slop_mode>(b);
+        auto safe = message_coder<Class>::decode<safe_mode>(b);
+        ASSERT_EQ(bool(slop), bool(safe));
+        if (slop) {
+            EXPECT_EQ(slop->first, safe->first);
+            EXPECT_EQ(begin_diff(slop->second, b), begin_diff(safe->second, b));
+        }
+    }
+}
@@ -0,0 +1,189 @@
+//   Copyright 2020-2021 PragmaTwice
+//
+//   Licensed under the Apache License, Version 2.0 (the "License");
+//   you may not use this file except in compliance with the License.
+//   You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the License is distributed on an "AS IS" BASIS,
+//   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//   See the License for the specific language governing permissions and
+//   limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <protopuf/columnar.h>
+#include <cstring>
+#include <string_view>
+#include <vector>
+
+#include "test_fixture.h"
+
+using namespace pp;
+using namespace std;
+
+enum class Level : int32 { low = 1, high = 2 };
+
+using Address = message<string_field<"city", 1>>;
+using Person = message<
+    uint32_field<"id", 1>, string_field<"name", 2>, sint64_field<"score", 3, implicit>, bool_field<"admin", 4>,
+    double_field<"weight", 5>, enum_field<"level", 6, Level>, int32_field<"tags", 7, packed>, message_field<"address", 8, Address>
+>;
+
+template <typename T>
+vector<byte> encode_delimited(const vector<T>& msgs) {
+    vector<byte> out;
+    for (const auto& msg : msgs) {
+        const auto n = skipper<message_coder<T>>::encode_skip(msg);
+        const auto prefix = skipper<varint_coder<pp::uint<8>>>::encode_skip(n);
+        const auto offset = out.size();
+        out.resize(offset + prefix + n);
+
+        bytes b{out.data() + offset, prefix + n};
+        varint_coder<pp::uint<8>>::encode<safe_mode>(n, b);
+        message_coder<T>::encode(msg, b.subspan(prefix));
+    }
+    return out;
+}
+
+const vector<Person> people{
+    Person{1u, "tom", sint_zigzag<8>(-3), true, 60.5, Level::high, vector{1, 2}, Address{"shanghai"}},
+    Person{2u, std::nullopt, sint_zigzag<8>(0), std::nullopt, std::nullopt, std::nullopt, vector<int32>{}, std::nullopt},
+    Person{3u, "jerry", sint_zigzag<8>(7), false, std::nullopt, Level::low, vector{3}, std::nullopt},
+};
+
+template <typename T>
+struct test_columnar : test_fixture<T> {};
+TYPED_TEST_SUITE(test_columnar, coder_mode_types, test_name_generator);
+
+TYPED_TEST(test_columnar, append_delimited) {
+    using Mode = typename TestFixture::mode;
+
+    auto stream = encode_delimited(people);
+
+    columnar_batch<Person> batch;
+    bytes rest;
+    ASSERT_TRUE(Mode::get_value_from_result(batch.template append_delimited<Mode>(stream), rest));
+    EXPECT_TRUE(rest.empty());
+    ASSERT_EQ(batch.size(), 3);
+
+    const auto& id = batch.template column<"id">();
+    EXPECT_EQ(id.values.values, (vector<uint32>{1, 2, 3}));
+    EXPECT_EQ(id.null_count(), 0);
+
+    const auto& name = batch.template column<2>();
+    EXPECT_EQ(name.values.offsets, (vector<int64_t>{0, 3, 3, 8}));
+    EXPECT_EQ(string_view(reinterpret_cast<const char*>(name.values.data.data()), name.values.data.size()), "tomjerry");
+    EXPECT_EQ(name.null_count(), 1);
+    EXPECT_TRUE(name.is_null(1));
+
+    const auto& score = batch.template column<"score">();
+    EXPECT_EQ(score.values.values, (vector<int64>{-3, 0, 7}));
+    EXPECT_EQ(score.null_count(), 0);
+
+    const auto& admin = batch.template column<"admin">();
+    EXPECT_TRUE(admin.values.values[0]);
+    EXPECT_FALSE(admin.values.values[2]);
+    EXPECT_TRUE(admin.is_null(1));
+
+    EXPECT_EQ(batch.template column<"level">().values.values, (vector<int32>{2, 0, 1}));
+
+    const auto& tags = batch.template column<"tags">();
+    EXPECT_EQ(tags.offsets, (vector<int64_t>{0, 2, 2, 3}));
+    EXPECT_EQ(tags.values.values, (vector<int32>{1, 2, 3}));
+
+    static_assert(!arrow_column<Person::get_type_by_name<"address">>::exported);
+}
+
+GTEST_TEST(columnar, last_value_wins) {
+    using M = message<int32_field<"a", 1>, string_field<"b", 2>>;
+
+    // a = 1, b = "xy", a = 5, b = "z"
+    array<byte, 12> a{0x08_b, 0x01_b, 0x12_b, 0x02_b, 0x78_b, 0x79_b, 0x08_b, 0x05_b, 0x12_b, 0x01_b, 0x7a_b};
+
+    columnar_batch<M> batch;
+    EXPECT_TRUE(batch.append(bytes{a.data(), 11}));
+    EXPECT_EQ(batch.column<1>().values.values, (vector<int32>{5}));
+    EXPECT_EQ(batch.column<2>().values.offsets, (vector<int64_t>{0, 1}));
+    EXPECT_EQ(batch.column<2>().values.data, (vector<pp::uint<1>>{0x7a}));
+}
+
+GTEST_TEST(columnar, failure) {
+    auto stream = encode_delimited(people);
+
+    columnar_batch<Person> batch;
+    ASSERT_TRUE(batch.append_delimited(stream));
+
+    for (size_t i = 1; i < stream.size(); ++i) {
+        auto partial = batch;
+        if (partial.append_delimited(bytes{stream.data(), i})) {
+            // truncated at a message boundary
+            continue;
+        }
+        EXPECT_EQ(partial.size(), 3);
+        EXPECT_EQ(partial.column<"name">().values.data.size(), 8);
+        EXPECT_EQ(partial.column<"tags">().offsets.size(), 4);
+        EXPECT_EQ(partial.column<"admin">().validity.size(), 3);
+    }
+}
+
+GTEST_TEST(columnar, export_to) {
+    auto stream = encode_delimited(people);
+
+    columnar_batch<Person> batch;
+    ASSERT_TRUE(batch.append_delimited(stream));
+
+    ArrowArray array;
+    ArrowSchema schema;
+    std::move(batch).export_to(&array, &schema);
+    EXPECT_TRUE(batch.empty());
+
+    EXPECT_STREQ(schema.format, "+s");
+    ASSERT_EQ(schema.n_children, 7);
+    EXPECT_STREQ(schema.children[0]->format, "I");
+    EXPECT_STREQ(schema.children[0]->name, "id");
+    EXPECT_EQ(schema.children[0]->flags, ARROW_FLAG_NULLABLE);
+    EXPECT_STREQ(schema.children[1]->format, "U");
+    EXPECT_STREQ(schema.children[2]->format, "l");
+    EXPECT_EQ(schema.children[2]->flags, 0);
+    EXPECT_STREQ(schema.children[3]->format, "b");
+    EXPECT_STREQ(schema.children[4]->format, "g");
+    EXPECT_STREQ(schema.children[5]->format, "i");
+    EXPECT_STREQ(schema.children[6]->format, "+L");
+    EXPECT_STREQ(schema.children[6]->children[0]->format, "i");
+
+    EXPECT_EQ(array.length, 3);
+    ASSERT_EQ(array.n_children, 7);
+
+    const ArrowArray* id = array.children[0];
+    EXPECT_EQ(id->n_buffers, 2);
+    EXPECT_EQ(id->null_count, 0);
+    EXPECT_EQ(id->buffers[0], nullptr);
+    EXPECT_EQ(static_cast<const uint32*>(id->buffers[1])[2], 3);
+
+    const ArrowArray* name = array.children[1];
+    EXPECT_EQ(name->n_buffers, 3);
+    EXPECT_EQ(name->null_count, 1);
+    EXPECT_EQ(*static_cast<const uint8_t*>(name->buffers[0]), 0b101);
+    EXPECT_EQ(static_cast<const int64_t*>(name->buffers[1])[3], 8);
+    EXPECT_EQ(memcmp(name->buffers[2], "tomjerry", 8), 0);
+
+    const ArrowArray* tags = array.children[6];
+    EXPECT_EQ(tags->n_children, 1);
+    EXPECT_EQ(static_cast<const int64_t*>(tags->buffers[1])[1], 2);
+    EXPECT_EQ(static_cast<const int32*>(tags->children[0]->buffers[1])[2], 3);
+
+    // a child moved out by the consumer outlives its parent
+    ArrowArray moved = *array.children[1];
+    array.children[1]->release = nullptr;
+
+    array.release(&array);
+    EXPECT_EQ(array.release, nullptr);
+    EXPECT_EQ(memcmp(moved.buffers[2], "tomjerry", 8), 0);
+    moved.release(&moved);
+
+    schema.release(&schema);
+    EXPECT_EQ(schema.release, nullptr);
+}
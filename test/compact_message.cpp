@@ -0,0 +1,220 @@
+//   Copyright 2020-2021 PragmaTwice
+//
+//   Licensed under the Apache License, Version 2.0 (the "License");
+//   you may not use this file except in compliance with the License.
+//   You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the License is distributed on an "AS IS" BASIS,
+//   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//   See the License for the specific language governing permissions and
+//   limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <protopuf/compact_message.h>
+#include <array>
+
+#include "test_fixture.h"
+
+using namespace pp;
+using namespace std;
+
+GTEST_TEST(compact_message, function) {
+    compact_message<integer_field<"a", 1, int>, string_field<"b", 2>, floating_field<"c", 4, double>> m{12, "345", std::nullopt};
+    static_assert(m.size == 3);
+
+    EXPECT_EQ(m.get<1>(), 12);
+    EXPECT_EQ(m.get<"b">(), "345");
+    EXPECT_EQ(m.get<4>(), std::nullopt);
+    EXPECT_FALSE(m["c"_f].has_value());
+    EXPECT_EQ(m.present_count(), 2);
+
+    m.get<4>() = 1.5;
+    EXPECT_DOUBLE_EQ(m.get<4>().value(), 1.5);
+    EXPECT_EQ(m.present_count(), 3);
+
+    auto m2 = m;
+    EXPECT_EQ(m2, m);
+
+    m2.get<1>().reset();
+    EXPECT_FALSE(m2.get<1>());
+    EXPECT_NE(m2, m);
+    EXPECT_EQ(m2.get<1>().value_or(7), 7);
+    EXPECT_THROW(m2.get<1>().value(), std::bad_optional_access);
+
+    m2.get<1>() = m.get<1>();
+    EXPECT_EQ(m2, m);
+
+    m2.get<"b">()->append("6");
+    EXPECT_EQ(*m2[2_i], "3456");
+
+    const auto& cm = m2;
+    std::optional<std::string> b = cm.get<2>();
+    EXPECT_EQ(b, "3456");
+
+    m2.clear();
+    EXPECT_EQ(m2.present_count(), 0);
+    EXPECT_EQ(m2, decltype(m2){});
+}
+
+GTEST_TEST(compact_message, layout) {
+    using plain = message<bool_field<"a", 1>, double_field<"b", 2>, int32_field<"c", 3>, bool_field<"d", 4>, double_field<"e", 5>>;
+    using compact = compact_message<bool_field<"a", 1>, double_field<"b", 2>, int32_field<"c", 3>, bool_field<"d", 4>, double_field<"e", 5>>;
+
+    // two doubles, an int32, two bools and a byte of has-bits
+    static_assert(sizeof(compact) == 24);
+    static_assert(sizeof(compact) < sizeof(plain));
+
+    compact m;
+    m.get<1>() = true;
+    m.get<5>() = 2.5;
+    EXPECT_EQ(m.get<1>(), true);
+    EXPECT_EQ(m.get<2>(), std::nullopt);
+    EXPECT_EQ(m.get<3>(), std::nullopt);
+    EXPECT_EQ(m.get<5>(), 2.5);
+}
+
+GTEST_TEST(compact_message, many_has_bits) {
+    using compact = compact_message<
+        int32_field<"f1", 1>, int32_field<"f2", 2>, int32_field<"f3", 3>, int32_field<"f4", 4>, int32_field<"f5", 5>,
+        int32_field<"f6", 6>, int32_field<"f7", 7>, int32_field<"f8", 8>, int32_field<"f9", 9>, int32_field<"f10", 10>
+    >;
+
+    compact m;
+    m.get<1>() = 1;
+    m.get<9>() = 9;
+    m.get<10>() = 10;
+    EXPECT_EQ(m.present_count(), 3);
+
+    array<byte, 16> a{};
+    bytes n;
+    ASSERT_TRUE(safe_mode::get_value_from_result(message_coder<compact>::encode(m, a), n));
+    EXPECT_EQ(begin_diff(n, a), 6);
+    EXPECT_EQ(a, (array<byte, 16>{0x08_b, 0x01_b, 0x48_b, 0x09_b, 0x50_b, 0x0a_b}));
+    EXPECT_EQ(skipper<message_coder<compact>>::encode_skip(m), 6);
+
+    decode_value<compact> value;
+    ASSERT_TRUE(safe_mode::get_value_from_result(message_coder<compact>::decode(bytes{a.data(), n.data()}), value));
+    EXPECT_EQ(value.first, m);
+}
+
+template<typename T>
+struct test_compact_message_coder : test_fixture<T> {};
+TYPED_TEST_SUITE(test_compact_message_coder, coder_mode_types, test_name_generator);
+
+TYPED_TEST(test_compact_message_coder, encode) {
+    using Mode = typename TestFixture::mode;
+
+    // singular fields are encoded first, so the bytes are the same as a message while they are declared first
+    using plain = message<int32_field<"id", 1>, string_field<"name", 2>, sint64_field<"score", 3>, int32_field<"tags", 4, repeated>>;
+    using compact = compact_message<int32_field<"id", 1>, string_field<"name", 2>, sint64_field<"score", 3>, int32_field<"tags", 4, repeated>>;
+
+    plain p{150, "tom", std::nullopt, std::vector{1, 2}};
+    compact c{150, "tom", std::nullopt, std::vector{1, 2}};
+
+    array<byte, 32> a{}, b{};
+    bytes pn, cn;
+    ASSERT_TRUE(Mode::get_value_from_result(message_coder<plain>::encode<Mode>(p, a), pn));
+    ASSERT_TRUE(Mode::get_value_from_result(message_coder<compact>::encode<Mode>(c, b), cn));
+    EXPECT_EQ(begin_diff(cn, b), begin_diff(pn, a));
+    EXPECT_EQ(a, b);
+    EXPECT_EQ(skipper<message_coder<compact>>::encode_skip(c), skipper<message_coder<plain>>::encode_skip(p));
+}
+
+TYPED_TEST(test_compact_message_coder, decode) {
+    using Mode = typename TestFixture::mode;
+
+    using compact = compact_message<int32_field<"id", 1>, string_field<"name", 2>, sint64_field<"score", 3>, int32_field<"tags", 4, packed>>;
+
+    compact c{150, "tom", sint_zigzag<8>(-3), std::vector{1, 2}};
+    array<byte, 32> a{};
+    bytes n;
+    ASSERT_TRUE(Mode::get_value_from_result(message_coder<compact>::encode<Mode>(c, a), n));
+
+    decode_value<compact> value;
+    ASSERT_TRUE(Mode::get_value_from_result(message_coder<compact>::decode<Mode>(bytes{a.data(), n.data()}), value));
+    EXPECT_EQ(value.first, c);
+
+    compact d{7, "a long name which is allocated", std::nullopt, std::vector{3, 4, 5}};
+    const auto name_data = d.get<2>()->data();
+    const auto name_capacity = d.get<2>()->capacity();
+
+    c.get<1>().reset();
+    c.get<3>() = std::nullopt;
+    ASSERT_TRUE(Mode::get_value_from_result(message_coder<compact>::encode<Mode>(c, a), n));
+
+    bytes rest;
+    ASSERT_TRUE(Mode::get_value_from_result(message_coder<compact>::decode_to<Mode>(d, bytes{a.data(), n.data()}), rest));
+    EXPECT_EQ(d, c);
+    EXPECT_EQ(d.get<2>()->data(), name_data);
+    EXPECT_EQ(d.get<2>()->capacity(), name_capacity);
+}
+
+TYPED_TEST(test_compact_message_coder, nested) {
+    using Mode = typename TestFixture::mode;
+
+    using Student = compact_message<uint32_field<"id", 1>, string_field<"name", 3>>;
+    using Class = message<string_field<"name", 8>, message_field<"students", 3, Student, repeated>>;
+    using CompactClass = compact_message<string_field<"name", 8>, message_field<"monitor", 2, Student>, message_field<"students", 3, Student, repeated>>;
+
+    Class c{"class 101", std::vector{Student{123, "tom"}, Student{456, std::nullopt}}};
+    array<byte, 64> a{};
+    bytes n;
+    ASSERT_TRUE(Mode::get_value_from_result(message_coder<Class>::encode<Mode>(c, a), n));
+
+    decode_value<Class> value;
+    ASSERT_TRUE(Mode::get_value_from_result(message_coder<Class>::decode<Mode>(bytes{a.data(), n.data()}), value));
+    EXPECT_EQ(value.first, c);
+
+    CompactClass cc{"class 101", Student{1, "jerry"}, std::vector{Student{123, "tom"}}};
+    ASSERT_TRUE(Mode::get_value_from_result(message_coder<CompactClass>::encode<Mode>(cc, a), n));
+
+    decode_value<CompactClass> compact_value;
+    ASSERT_TRUE(Mode::get_value_from_result(message_coder<CompactClass>::decode<Mode>(bytes{a.data(), n.data()}), compact_value));
+    EXPECT_EQ(compact_value.first, cc);
+    EXPECT_EQ(compact_value.first.get<"monitor">()->get<"name">(), "jerry");
+}
+
+GTEST_TEST(compact_message_coder, encode_with_insufficient_buffer_size) {
+    using compact = compact_message<int32_field<"id", 1>, string_field<"name", 2>, int32_field<"tags", 4, repeated>>;
+    compact c{150, "tom", std::vector{1, 2}};
+
+    const auto size = skipper<message_coder<compact>>::encode_skip(c);
+    std::vector<byte> a(size);
+    for (std::size_t i = 0; i < size; ++i) {
+        EXPECT_FALSE(message_coder<compact>::encode(c, bytes{a.data(), i}));
+    }
+    EXPECT_TRUE(message_coder<compact>::encode(c, bytes{a.data(), size}));
+
+    for (std::size_t i = 1; i < size; ++i) {
+        if (i == 3 || i == 8 || i == 10) {
+            // truncated at a field boundary, which is a valid message
+            continue;
+        }
+        EXPECT_FALSE(message_coder<compact>::decode(bytes{a.data(), i}));
+    }
+}
+
+GTEST_TEST(compact_message_coder, oneof) {
+    using Event = compact_message<uint64_field<"id", 1>, oneof_field<"payload", string_field<"text", 2>, int32_field<"code", 3>>>;
+
+    Event e;
+    e["id"_f] = 1u;
+    e["payload"_f].emplace<"text">("hi");
+
+    array<byte, 16> a{};
+    bytes n;
+    ASSERT_TRUE(safe_mode::get_value_from_result(message_coder<Event>::encode(e, a), n));
+    EXPECT_EQ(begin_diff(n, a), 6);
+
+    Event d;
+    d["payload"_f].emplace<3>(5);
+    ASSERT_TRUE(message_coder<Event>::decode_to(d, bytes{a.data(), n.data()}));
+    EXPECT_EQ(d, e);
+
+    d.clear();
+    EXPECT_FALSE(d["payload"_f].has_value());
+}
@@ -24,6 +24,10 @@ using namespace std;
 
 using Student = message<uint32_field<"id", 1>, string_field<"name", 3>>;
 using Class = message<string_field<"name", 8>, message_field<"students", 3, Student, repeated>>;
+using ImplicitStudent = message<uint32_field<"id", 1, implicit>, string_field<"name", 3, implicit>>;
+using Report = message<uint32_field<"scores", 1, packed>, double_field<"weights", 2, packed>, sint64_field<"deltas", 3, repeated>>;
+using Event = message<uint64_field<"id", 1, implicit>,
+    oneof_field<"payload", string_field<"text", 2>, int32_field<"code", 3>, message_field<"student", 4, Student>>>;
 
 template<typename T>
 struct compatibility : test_fixture<T> {};
@@ -78,3 +82,89 @@ TYPED_TEST(compatibility, decode) {
     EXPECT_EQ(myClass["students"_f][1], (Student{123456, "jerry"}));
     EXPECT_EQ(myClass["students"_f][0], (Student{456, "tom"}));
 }
+
+TYPED_TEST(compatibility, encode_packed) {
+    Report myReport {vector<uint32>{1, 300, 70000}, vector<double>{0.5, 2.0}, vector<sint64>{sint64(-1), sint64(5)}};
+
+    array<byte, 64> buffer{};
+    bytes b;
+    ASSERT_TRUE(TestFixture::mode::get_value_from_result(
+        message_coder<Report>::encode<typename TestFixture::mode>(myReport, buffer), b));
+
+    pb::Report yourReport;
+    ASSERT_TRUE(yourReport.ParseFromArray(buffer.data(), begin_diff(b, buffer)));
+
+    EXPECT_EQ(yourReport.scores_size(), 3);
+    EXPECT_EQ(yourReport.scores(2), 70000);
+    EXPECT_EQ(yourReport.weights_size(), 2);
+    EXPECT_EQ(yourReport.weights(0), 0.5);
+    EXPECT_EQ(yourReport.deltas_size(), 2);
+    EXPECT_EQ(yourReport.deltas(0), -1);
+    EXPECT_EQ(yourReport.ByteSizeLong(), begin_diff(b, buffer));
+}
+
+TYPED_TEST(compatibility, decode_packed) {
+    pb::Report yourReport;
+    yourReport.add_scores(1);
+    yourReport.add_scores(300);
+    yourReport.add_weights(0.5);
+    yourReport.add_deltas(-1);
+    yourReport.add_deltas(5);
+
+    array<byte, 64> buffer{};
+    yourReport.SerializeToArray(buffer.data(), buffer.size());
+
+    decode_value<Report> value;
+    ASSERT_TRUE(TestFixture::mode::get_value_from_result(
+        message_coder<Report>::decode<typename TestFixture::mode>(bytes(buffer).first(yourReport.ByteSizeLong())), value));
+
+    const auto& [myReport, _] = value;
+    EXPECT_EQ(myReport["scores"_f], (vector<uint32>{1, 300}));
+    EXPECT_EQ(myReport["weights"_f], (vector<double>{0.5}));
+    EXPECT_EQ(myReport["deltas"_f], (vector<sint64>{sint64(-1), sint64(5)}));
+}
+
+TYPED_TEST(compatibility, implicit) {
+    for (const auto& myStudent : {ImplicitStudent{0u, "tom"}, ImplicitStudent{123u, ""}, ImplicitStudent{}}) {
+        array<byte, 64> buffer{};
+        bytes b;
+        ASSERT_TRUE(TestFixture::mode::get_value_from_result(
+            message_coder<ImplicitStudent>::encode<typename TestFixture::mode>(myStudent, buffer), b));
+
+        pb::Student yourStudent;
+        yourStudent.set_id(myStudent["id"_f].value());
+        yourStudent.set_name(myStudent["name"_f].value());
+        EXPECT_EQ(yourStudent.ByteSizeLong(), begin_diff(b, buffer));
+
+        array<byte, 64> yourBuffer{};
+        yourStudent.SerializeToArray(yourBuffer.data(), yourBuffer.size());
+        EXPECT_EQ(buffer, yourBuffer);
+    }
+}
+
+TYPED_TEST(compatibility, oneof) {
+    Event myEvent;
+    myEvent["id"_f] = 7u;
+    myEvent["payload"_f].emplace<"student">(Student{123, "tom"});
+
+    array<byte, 64> buffer{};
+    bytes b;
+    ASSERT_TRUE(TestFixture::mode::get_value_from_result(
+        message_coder<Event>::encode<typename TestFixture::mode>(myEvent, buffer), b));
+
+    pb::Event yourEvent;
+    ASSERT_TRUE(yourEvent.ParseFromArray(buffer.data(), begin_diff(b, buffer)));
+    EXPECT_EQ(yourEvent.id(), 7);
+    ASSERT_EQ(yourEvent.payload_case(), pb::Event::kStudent);
+    EXPECT_EQ(yourEvent.student().id(), 123);
+    EXPECT_EQ(yourEvent.student().name(), "tom");
+
+    yourEvent.set_code(-5);
+    yourEvent.SerializeToArray(buffer.data(), buffer.size());
+
+    decode_value<Event> value;
+    ASSERT_TRUE(TestFixture::mode::get_value_from_result(
+        message_coder<Event>::decode<typename TestFixture::mode>(bytes(buffer).first(yourEvent.ByteSizeLong())), value));
+    EXPECT_EQ(value.first["payload"_f].active_number(), 3);
+    EXPECT_EQ(*value.first["payload"_f].get_if<"code">(), -5);
+}
@@ -0,0 +1,163 @@
+//   Copyright 2020-2021 PragmaTwice
+//
+//   Licensed under the Apache License, Version 2.0 (the "License");
+//   you may not use this file except in compliance with the License.
+//   You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the License is distributed on an "AS IS" BASIS,
+//   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//   See the License for the specific language governing permissions and
+//   limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <protopuf/counting.h>
+#include <protopuf/thread_pool.h>
+#include <array>
+#include <numeric>
+#include <string>
+#include <vector>
+
+using namespace pp;
+using namespace std;
+
+using Student = message<uint32_field<"id", 1>, string_field<"name", 3>>;
+using Class = message<string_field<"name", 8>, message_field<"students", 3, Student, repeated>,
+    uint32_field<"scores", 4, packed>, float_field<"ratio", 5>>;
+using School = message<message_field<"classes", 1, Class, repeated>, uint64_field<"id", 2>>;
+
+// a user-defined coder, which encodes a pair of 16-bit integers
+struct point_coder {
+    using value_type = pair<pp::uint<2>, pp::uint<2>>;
+
+    template <coder_mode Mode>
+    static encode_result<Mode> encode(const value_type& v, bytes b) {
+        if (!Mode::get_value_from_result(integer_coder<pp::uint<2>>::encode<Mode>(v.first, b), b)) {
+            return {};
+        }
+        return integer_coder<pp::uint<2>>::encode<Mode>(v.second, b);
+    }
+
+    template <coder_mode Mode>
+    static decode_result<value_type, Mode> decode(bytes b) {
+        decode_value<pp::uint<2>> first, second;
+        if (!Mode::get_value_from_result(integer_coder<pp::uint<2>>::decode<Mode>(b), first) ||
+            !Mode::get_value_from_result(integer_coder<pp::uint<2>>::decode<Mode>(first.second), second)) {
+            return {};
+        }
+        return Mode::template make_result<decode_result<value_type, Mode>>(value_type{first.first, second.first}, second.second);
+    }
+};
+
+// the skipper of the user-defined coder, by which its encoded sizes are measured
+template <>
+struct pp::skipper<point_coder> {
+    using coder = point_coder;
+    using value_type = point_coder::value_type;
+
+    static constexpr size_t encode_skip(const value_type&) {
+        return 4;
+    }
+};
+
+// a user-defined coder without a skipper, which encodes strings as string_coder does
+struct blob_coder : string_coder {};
+
+template <typename C>
+concept measurable = requires(const typename C::value_type& v) {
+    encoded_size<C>(v);
+};
+
+GTEST_TEST(counting_mode, static) {
+    static_assert(coder_mode<counting_mode>);
+    static_assert(coder<point_coder>);
+    static_assert(coder<blob_coder>);
+    static_assert(measurable<point_coder>);
+    static_assert(measurable<string_coder>);
+    static_assert(!measurable<blob_coder>);
+}
+
+GTEST_TEST(counting_mode, encoded_size) {
+    counting_mode::reset();
+
+    Class c{"class 101", vector<Student>{Student{123, "tom"}, Student{456, "jerry"}}, vector<pp::uint<4>>{1, 2, 300}, 0.5f};
+    EXPECT_EQ(encoded_size<message_coder<Class>>(c), skipper<message_coder<Class>>::encode_skip(c));
+    EXPECT_EQ(encoded_size<embedded_message_coder<Class>>(c), skipper<embedded_message_coder<Class>>::encode_skip(c));
+    EXPECT_EQ(encoded_size<point_coder>({1, 2}), 4);
+
+    EXPECT_EQ(encoded_size<string_coder>(string(10000, 'x')), 10002);
+
+    EXPECT_EQ(counting_mode::counts().encoded_bytes, 2 * skipper<message_coder<Class>>::encode_skip(c) + 1 + 4 + 10002);
+    EXPECT_EQ(counting_mode::counts().decoded_bytes, 0);
+}
+
+GTEST_TEST(counting_mode, decode) {
+    Class c{"class 101", vector<Student>{Student{123, "tom"}, Student{456, "jerry"}}, vector<pp::uint<4>>{1, 2, 300}, 0.5f};
+    Class other;
+    other["name"_f] = "class 102";
+
+    School s;
+    s["classes"_f] = vector<Class>{c, other};
+    s["id"_f] = 1ull << 40;
+
+    array<byte, 128> a{};
+    bytes b;
+    ASSERT_TRUE(safe_mode::get_value_from_result(message_coder<School>::encode(s, a), b));
+    const auto size = begin_diff(b, a);
+
+    counting_mode::reset();
+    decode_value<School> v;
+    ASSERT_TRUE(counting_mode::get_value_from_result(message_coder<School>::decode<counting_mode>(bytes{a.data(), size}), v));
+    EXPECT_EQ(v.first, s);
+
+    const auto& counts = counting_mode::counts();
+    EXPECT_EQ(counts.decoded_bytes, size);
+    EXPECT_EQ(accumulate(counts.wire_bytes.begin(), counts.wire_bytes.end(), size_t(0)), size);
+    EXPECT_EQ(counts.max_depth, 3);
+
+    // fields: classes (2), id, class names (2), students (2), student fields (4), scores, ratio
+    EXPECT_EQ(counts.decoded_fields, 13);
+
+    // the ids of the students, and the id of the school
+    EXPECT_EQ(counts.wire_bytes[0], 2 + 3 + 7);
+    EXPECT_EQ(counts.wire_bytes[5], 5);
+    EXPECT_EQ(counts.wire_bytes[1], 0);
+
+    // the truncated id of the school is not counted, while the nesting is balanced after the failure
+    counting_mode::reset();
+    EXPECT_FALSE((message_coder<School>::decode<counting_mode>(bytes{a.data(), size - 1})));
+    EXPECT_EQ(counts.decoded_bytes, size - 7);
+    counting_mode::reset();
+    ASSERT_TRUE(counting_mode::get_value_from_result(message_coder<School>::decode<counting_mode>(bytes{a.data(), size}), v));
+    EXPECT_EQ(counts.decoded_bytes, size);
+    EXPECT_EQ(counts.max_depth, 3);
+}
+
+GTEST_TEST(counting_mode, decode_by_executor) {
+    School s;
+    for (uint32 i = 0; i < 100; ++i) {
+        Class c{"class " + to_string(i), vector<Student>{Student{i, "tom"}, Student{i + 1, "jerry"}}, vector<pp::uint<4>>{i}, 0.5f};
+        s["classes"_f].push_back(c);
+    }
+    s["id"_f] = 1;
+
+    vector<byte> a(skipper<message_coder<School>>::encode_skip(s));
+    ASSERT_TRUE(message_coder<School>::encode(s, a));
+
+    counting_mode::reset();
+    ASSERT_TRUE(message_coder<School>::decode<counting_mode>(a));
+    const auto sequential = counting_mode::counts();
+    EXPECT_EQ(sequential.decoded_bytes, a.size());
+    EXPECT_EQ(sequential.max_depth, 3);
+
+    // elements are decoded under their fields in the calling thread, as they are sequentially
+    thread_pool pool(4);
+    counting_mode::reset();
+    auto result = message_coder<School>::decode<counting_mode>(a, pool);
+    ASSERT_TRUE(result);
+    EXPECT_EQ(result->first, s);
+    EXPECT_EQ(counting_mode::counts(), sequential);
+}
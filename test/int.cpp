@@ -130,6 +130,23 @@ TYPED_TEST(test_integer_coder, signed) {
     EXPECT_EQ(m1e, m1);
 }
 
+TYPED_TEST(test_integer_coder, decode_to) {
+    array<byte, 6> a{0x78_b, 0x56_b, 0x34_b, 0x12_b, 0xfe_b, 0xff_b};
+    bytes b = a, r;
+
+    pp::uint<4> u = 0;
+    ASSERT_TRUE(TestFixture::mode::get_value_from_result(
+        integer_coder<pp::uint<4>>::decode_to<typename TestFixture::mode>(u, b), r));
+    EXPECT_EQ(u, 0x12345678);
+    EXPECT_EQ(begin_diff(r, b), 4);
+
+    sint<2> s = 0;
+    ASSERT_TRUE(TestFixture::mode::get_value_from_result(
+        integer_coder<sint<2>>::decode_to<typename TestFixture::mode>(s, r), r));
+    EXPECT_EQ(s, -2);
+    EXPECT_EQ(begin_diff(r, b), 6);
+}
+
 GTEST_TEST(integer_coder, encode_with_insufficient_buffer_size) {
     run_safe_encode_tests_with_insufficient_buffer_size<integer_coder<sint<4>>, 4>(-1);
 }
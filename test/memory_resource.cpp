@@ -0,0 +1,162 @@
+//   Copyright 2020-2021 PragmaTwice
+//
+//   Licensed under the Apache License, Version 2.0 (the "License");
+//   you may not use this file except in compliance with the License.
+//   You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the License is distributed on an "AS IS" BASIS,
+//   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//   See the License for the specific language governing permissions and
+//   limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <protopuf/map.h>
+#include <protopuf/message.h>
+#include <protopuf/thread_pool.h>
+#include <memory_resource>
+#include <vector>
+
+#include "test_fixture.h"
+
+using namespace pp;
+using namespace std;
+
+using Student = message<pp::pmr::field<"id", 1, varint_coder<uint32>>, pp::pmr::string_field<"name", 3>>;
+using Class = message<pp::pmr::string_field<"name", 8>, pp::pmr::message_field<"students", 3, Student, repeated>,
+    pp::pmr::message_field<"monitor", 4, Student>, pp::pmr::field<"grades", 6, varint_coder<uint32>, repeated>,
+    pp::pmr::bytes_field<"logo", 7>, pp::pmr::map_field<"scores", 9, pp::pmr::string_coder, varint_coder<uint32>>>;
+
+// the default resource is replaced by the null resource during decoding, so that any allocation out of the arena throws
+struct default_resource_guard {
+    std::pmr::memory_resource* previous = std::pmr::set_default_resource(std::pmr::null_memory_resource());
+
+    ~default_resource_guard() {
+        std::pmr::set_default_resource(previous);
+    }
+};
+
+static vector<byte> make_class_buffer() {
+    Class c;
+    c["name"_f] = "a class name long enough to be allocated";
+    c["monitor"_f] = Student{1u, "a student name long enough to be allocated"};
+    for (uint32 i = 0; i < 100; ++i) {
+        c["students"_f].push_back(Student{i, std::pmr::string("student name long enough to be allocated ") + to_string(i).c_str()});
+        c["grades"_f].push_back(i * i);
+        c["scores"_f].emplace(std::pmr::string("subject name long enough to be allocated ") + to_string(i).c_str(), i);
+    }
+    c["logo"_f] = std::pmr::vector<pp::uint<1>>(100, 1);
+
+    vector<byte> buffer(skipper<message_coder<Class>>::encode_skip(c));
+    message_coder<Class>::encode<unsafe_mode>(c, buffer);
+    return buffer;
+}
+
+GTEST_TEST(memory_resource, scope) {
+    std::pmr::monotonic_buffer_resource outer, inner;
+
+    EXPECT_EQ(current_memory_resource(), std::pmr::get_default_resource());
+    {
+        memory_resource_scope s1(&outer);
+        EXPECT_EQ(current_memory_resource(), &outer);
+        {
+            memory_resource_scope s2(&inner);
+            EXPECT_EQ(current_memory_resource(), &inner);
+            EXPECT_EQ(make_value<std::pmr::string>().get_allocator().resource(), &inner);
+            EXPECT_EQ(Class{}["grades"_f].get_allocator().resource(), &inner);
+        }
+        EXPECT_EQ(current_memory_resource(), &outer);
+    }
+    EXPECT_EQ(current_memory_resource(), std::pmr::get_default_resource());
+}
+
+template <typename T>
+struct test_memory_resource : testing::Test {};
+TYPED_TEST_SUITE(test_memory_resource, coder_mode_types, test_name_generator);
+
+TYPED_TEST(test_memory_resource, decode) {
+    using Mode = TypeParam;
+
+    auto buffer = make_class_buffer();
+    auto expected = message_coder<Class>::decode<unsafe_mode>(buffer).first;
+
+    std::pmr::monotonic_buffer_resource arena;
+    std::pmr::unsynchronized_pool_resource pool(&arena);
+    {
+        default_resource_guard guard;
+
+        auto value = [&pool] {
+            memory_resource_scope scope(&pool);
+            return make_decode_value<Class>();
+        }();
+
+        ASSERT_TRUE(Mode::get_value_from_result(message_coder<Class>::decode<Mode>(buffer, &pool), value));
+        const auto& v = value.first;
+
+        EXPECT_EQ(v["name"_f]->get_allocator().resource(), &pool);
+        EXPECT_EQ(v["students"_f].get_allocator().resource(), &pool);
+        EXPECT_EQ(v["students"_f][42]["name"_f]->get_allocator().resource(), &pool);
+        EXPECT_EQ(v["monitor"_f].value()["name"_f]->get_allocator().resource(), &pool);
+        EXPECT_EQ(v["scores"_f].begin()->first->get_allocator().resource(), &pool);
+
+        EXPECT_EQ(v, expected);
+    }
+}
+
+GTEST_TEST(memory_resource, parallel_decode) {
+    auto buffer = make_class_buffer();
+    auto expected = message_coder<Class>::decode<unsafe_mode>(buffer).first;
+
+    std::pmr::synchronized_pool_resource pool;
+    thread_pool threads(4);
+    {
+        default_resource_guard guard;
+        memory_resource_scope scope(&pool);
+
+        auto value = make_decode_value<Class>();
+        ASSERT_TRUE(safe_mode::get_value_from_result(message_coder<Class>::decode<safe_mode>(buffer, threads), value));
+        EXPECT_EQ(value.first["students"_f][99]["name"_f]->get_allocator().resource(), &pool);
+        EXPECT_EQ(value.first, expected);
+    }
+}
+
+// an executor which counts loops run by it
+struct counting_executor {
+    size_t loops = 0;
+
+    template <typename F>
+    void parallel_for(size_t n, F&& f) {
+        ++loops;
+        if (n > 0) {
+            f(0, n);
+        }
+    }
+};
+
+GTEST_TEST(memory_resource, parallel_decode_in_unsynchronized_resource) {
+    auto buffer = make_class_buffer();
+    auto expected = message_coder<Class>::decode<unsafe_mode>(buffer).first;
+
+    std::pmr::monotonic_buffer_resource arena;
+    thread_pool threads(4);
+    counting_executor exec;
+    {
+        default_resource_guard guard;
+        memory_resource_scope scope(&arena);
+
+        auto value = make_decode_value<Class>();
+        ASSERT_TRUE(safe_mode::get_value_from_result(message_coder<Class>::decode<safe_mode>(buffer, threads), value));
+        EXPECT_EQ(value.first["students"_f][99]["name"_f]->get_allocator().resource(), &arena);
+        EXPECT_EQ(value.first, expected);
+
+        auto value2 = make_decode_value<Class>();
+        ASSERT_TRUE(safe_mode::get_value_from_result(message_coder<Class>::decode<safe_mode>(buffer, exec), value2));
+        EXPECT_EQ(value2.first, expected);
+    }
+
+    // elements are decoded in the calling thread, which is the only one using the arena
+    EXPECT_EQ(exec.loops, 0);
+}
@@ -15,6 +15,7 @@
 #include <gtest/gtest.h>
 
 #include <protopuf/message.h>
+#include <protopuf/map.h>
 #include <array>
 
 #include "test_fixture.h"
@@ -411,6 +412,339 @@ TYPED_TEST(test_message_coder, nested_decode) {
     }
 }
 
+TYPED_TEST(test_message_coder, decode_into) {
+    using Mode = typename TestFixture::mode;
+    using Student = message<uint32_field<"id", 1>, string_field<"name", 3>>;
+    using Class = message<string_field<"name", 8>, message_field<"students", 3, Student, repeated>,
+        message_field<"monitor", 4, Student>, uint32_field<"grades", 6, repeated>, bytes_field<"logo", 7>,
+        map_field<"scores", 9, string_coder, varint_coder<uint32>>>;
+    using Scores = typename Class::template get_type_by_number<9>::base_type;
+
+    auto encode = [](const Class& c) {
+        vector<byte> buffer(skipper<message_coder<Class>>::encode_skip(c));
+        message_coder<Class>::encode<unsafe_mode>(c, buffer);
+        return buffer;
+    };
+
+    Class first{"class 101", vector{Student{1u, "tom"}, Student{2u, "jerry"}, Student{3u, "twice"}},
+        Student{1u, "tom"}, vector<uint32>{1, 2, 3}, vector<pp::uint<1>>{4, 5}, Scores{{"math", 90}}};
+    Class second{"class 2", vector{Student{4u, "alice"}, Student{5u, ""}},
+        optional<Student>{}, vector<uint32>{7}, optional<vector<pp::uint<1>>>{}, Scores{{"art", 80}}};
+    Class third{"class 3", vector{Student{6u, "bob"}, Student{7u, "carol"}, Student{8u, "dave"}, Student{9u, "eve"}},
+        Student{6u, "bob"}, vector<uint32>{}, vector<pp::uint<1>>{1}, Scores{}};
+
+    Class v;
+    for (const auto& expected : {first, second, first, third, first}) {
+        const auto buffer = encode(expected);
+
+        bytes rest;
+        ASSERT_TRUE(Mode::get_value_from_result(message_coder<Class>::decode_into<Mode>(v, bytes{const_cast<byte*>(buffer.data()), buffer.size()}), rest));
+        EXPECT_TRUE(rest.empty());
+        EXPECT_EQ(v, expected);
+    }
+
+    const auto buffer = encode(first);
+    const auto students_data = v["students"_f].data();
+    const auto name_data = v["students"_f][2]["name"_f]->data();
+    const auto grades_data = v["grades"_f].data();
+
+    bytes rest;
+    ASSERT_TRUE(Mode::get_value_from_result(message_coder<Class>::decode_into<Mode>(v, bytes{const_cast<byte*>(buffer.data()), buffer.size()}), rest));
+    EXPECT_EQ(v, first);
+    EXPECT_EQ(v["students"_f].data(), students_data);
+    EXPECT_EQ(v["students"_f][2]["name"_f]->data(), name_data);
+    EXPECT_EQ(v["grades"_f].data(), grades_data);
+}
+
+TYPED_TEST(test_message_coder, decode_with_reserve_repeated) {
+    using Mode = typename TestFixture::mode;
+    using Student = message<uint32_field<"id", 1>, string_field<"name", 3>>;
+    using Class = message<string_field<"name", 8>, message_field<"students", 3, Student, repeated>,
+        uint32_field<"grades", 6, repeated>, string_field<"tags", 7, repeated>, uint32_field<"scores", 9, packed>>;
+
+    Class c{"class 101", vector<Student>{}, vector<uint32>{}, vector<string>{"a", "b", "c"}, vector<uint32>{}};
+    for (uint32 i = 0; i < 100; ++i) {
+        c["students"_f].push_back(Student{i, "student"});
+        c["grades"_f].push_back(i);
+        c["scores"_f].push_back(i * 100);
+    }
+
+    vector<byte> buffer(skipper<message_coder<Class>>::encode_skip(c));
+    message_coder<Class>::encode<unsafe_mode>(c, buffer);
+
+    decode_value<Class> value;
+    ASSERT_TRUE(Mode::get_value_from_result(message_coder<Class>::decode<Mode>(buffer, reserve_repeated), value));
+    const auto& [v, n] = value;
+    EXPECT_TRUE(n.empty());
+    EXPECT_EQ(v, c);
+    EXPECT_EQ(v["students"_f].capacity(), 100);
+    EXPECT_EQ(v["grades"_f].capacity(), 100);
+    EXPECT_EQ(v["tags"_f].capacity(), 3);
+    EXPECT_EQ(v["scores"_f].capacity(), 100);
+
+    Class w;
+    bytes rest;
+    ASSERT_TRUE(Mode::get_value_from_result(message_coder<Class>::decode_into<Mode>(w, buffer, reserve_repeated), rest));
+    EXPECT_EQ(w, c);
+    EXPECT_EQ(w["students"_f].capacity(), 100);
+}
+
+TYPED_TEST(test_message_coder, packed) {
+    using Mode = typename TestFixture::mode;
+    using Packed = message<uint32_field<"ids", 1, packed>, fixed32_field<"codes", 2, packed>, string_field<"name", 3>>;
+    using Unpacked = message<uint32_field<"ids", 1, repeated>, fixed32_field<"codes", 2, repeated>, string_field<"name", 3>>;
+
+    const array<byte, 19> packed_bytes{0x0a_b, 0x04_b, 0x01_b, 0x96_b, 0x01_b, 0x03_b,
+                                       0x12_b, 0x08_b, 0x01_b, 0x00_b, 0x00_b, 0x00_b, 0x02_b, 0x00_b, 0x00_b, 0x00_b,
+                                       0x1a_b, 0x01_b, 0x61_b};
+    const array<byte, 20> unpacked_bytes{0x08_b, 0x01_b, 0x08_b, 0x96_b, 0x01_b, 0x08_b, 0x03_b,
+                                         0x15_b, 0x01_b, 0x00_b, 0x00_b, 0x00_b, 0x15_b, 0x02_b, 0x00_b, 0x00_b, 0x00_b,
+                                         0x1a_b, 0x01_b, 0x61_b};
+
+    Packed p{vector<uint32>{1, 150, 3}, vector<uint32>{1, 2}, "a"};
+    EXPECT_EQ(skipper<message_coder<Packed>>::encode_skip(p), packed_bytes.size());
+
+    array<byte, 32> buffer{};
+    bytes rest;
+    ASSERT_TRUE(Mode::get_value_from_result(message_coder<Packed>::encode<Mode>(p, buffer), rest));
+    EXPECT_EQ(begin_diff(rest, buffer), packed_bytes.size());
+    EXPECT_TRUE(equal(packed_bytes.begin(), packed_bytes.end(), buffer.begin()));
+
+    auto decode_packed = [](bytes b) {
+        decode_value<Packed> value;
+        EXPECT_TRUE(Mode::get_value_from_result(message_coder<Packed>::decode<Mode>(b), value));
+        return value.first;
+    };
+    auto decode_unpacked = [](bytes b) {
+        decode_value<Unpacked> value;
+        EXPECT_TRUE(Mode::get_value_from_result(message_coder<Unpacked>::decode<Mode>(b), value));
+        return value.first;
+    };
+
+    Unpacked u{vector<uint32>{1, 150, 3}, vector<uint32>{1, 2}, "a"};
+    auto packed_span = bytes{const_cast<byte*>(packed_bytes.data()), packed_bytes.size()};
+    auto unpacked_span = bytes{const_cast<byte*>(unpacked_bytes.data()), unpacked_bytes.size()};
+    EXPECT_EQ(decode_packed(packed_span), p);
+    EXPECT_EQ(decode_packed(unpacked_span), p);
+    EXPECT_EQ(decode_unpacked(packed_span), u);
+    EXPECT_EQ(decode_unpacked(unpacked_span), u);
+
+    Packed v{vector<uint32>{7, 8, 9, 10}, vector<uint32>{}, "b"};
+    ASSERT_TRUE(Mode::get_value_from_result(message_coder<Packed>::decode_to<Mode>(v, unpacked_span), rest));
+    EXPECT_EQ(v, p);
+    ASSERT_TRUE(Mode::get_value_from_result(message_coder<Packed>::decode_to<Mode>(v, packed_span), rest));
+    EXPECT_EQ(v, p);
+}
+
+enum class Color { red, green };
+using Point = message<int32_field<"x", 1, implicit>, double_field<"y", 2, implicit>, string_field<"label", 3, implicit>,
+    enum_field<"color", 4, Color, implicit>, bool_field<"visible", 5, implicit>>;
+
+TYPED_TEST(test_message_coder, implicit) {
+    using Mode = typename TestFixture::mode;
+
+    static_assert(sizeof(Point::get_type_by_number<1>) == sizeof(int32));
+    static_assert(sizeof(Point::get_type_by_number<2>) == sizeof(double));
+
+    Point p;
+    EXPECT_FALSE(p["x"_f].has_value());
+    EXPECT_EQ(p["x"_f], 0);
+    EXPECT_EQ(skipper<message_coder<Point>>::encode_skip(p), 0);
+
+    p["x"_f] = 0;
+    p["y"_f] = -0.0;
+    p["label"_f] = "";
+    EXPECT_FALSE(p["x"_f].has_value());
+    EXPECT_TRUE(p["y"_f].has_value());
+    EXPECT_EQ(skipper<message_coder<Point>>::encode_skip(p), 9);
+
+    p = Point{150, 0.0, "a", Color::green, false};
+    array<byte, 16> buffer{};
+    bytes rest;
+    ASSERT_TRUE(Mode::get_value_from_result(message_coder<Point>::encode<Mode>(p, buffer), rest));
+    EXPECT_EQ(begin_diff(rest, buffer), 8);
+    EXPECT_EQ(buffer, (array<byte, 16>{0x08_b, 0x96_b, 0x01_b, 0x1a_b, 0x01_b, 0x61_b, 0x20_b, 0x01_b}));
+
+    decode_value<Point> value;
+    ASSERT_TRUE(Mode::get_value_from_result(message_coder<Point>::decode<Mode>(bytes(buffer).first(8)), value));
+    EXPECT_EQ(value.first, p);
+    EXPECT_EQ(value.first["x"_f], 150);
+    EXPECT_EQ(*value.first["label"_f], "a");
+
+    // an explicitly encoded default value is decoded as the default value
+    array<byte, 2> zero{0x08_b, 0x00_b};
+    ASSERT_TRUE(Mode::get_value_from_result(message_coder<Point>::decode_to<Mode>(value.first, zero), rest));
+    EXPECT_EQ(value.first, Point{});
+}
+
+using Login = message<string_field<"user", 1>>;
+using Event = message<uint64_field<"id", 1>, oneof_field<"payload", string_field<"text", 2>, int32_field<"code", 3>,
+    message_field<"login", 4, Login>>, string_field<"source", 5>>;
+
+TYPED_TEST(test_message_coder, oneof) {
+    using Mode = typename TestFixture::mode;
+    using Payload = Event::get_type_by_name<"payload">;
+
+    static_assert(std::is_same_v<Event::get_type_by_number<2>, Payload>);
+    static_assert(std::is_same_v<Event::get_type_by_number<4>, Payload>);
+    static_assert(sizeof(Payload) == sizeof(std::variant<std::monostate, std::string, int32, Login>));
+
+    Event e;
+    e["id"_f] = 1;
+    EXPECT_FALSE(e["payload"_f].has_value());
+    EXPECT_EQ(e["payload"_f].active_number(), 0);
+
+    e.get<3>().emplace<3>(150);
+    EXPECT_TRUE(e["payload"_f].holds<"code">());
+    EXPECT_EQ(e["payload"_f].active_number(), 3);
+    EXPECT_EQ(*e["payload"_f].get_if<3>(), 150);
+    EXPECT_EQ(e["payload"_f].get_if<"text">(), nullptr);
+
+    array<byte, 16> buffer{};
+    bytes rest;
+    ASSERT_TRUE(Mode::get_value_from_result(message_coder<Event>::encode<Mode>(e, buffer), rest));
+    EXPECT_EQ(begin_diff(rest, buffer), 5);
+    EXPECT_EQ(buffer, (array<byte, 16>{0x08_b, 0x01_b, 0x18_b, 0x96_b, 0x01_b}));
+    EXPECT_EQ(skipper<message_coder<Event>>::encode_skip(e), 5);
+
+    decode_value<Event> value;
+    ASSERT_TRUE(Mode::get_value_from_result(message_coder<Event>::decode<Mode>(bytes(buffer).first(5)), value));
+    EXPECT_EQ(value.first, e);
+
+    // values of all members are decoded into the oneof field, where the last one wins
+    array<byte, 10> members{0x12_b, 0x01_b, 0x61_b, 0x18_b, 0x05_b, 0x22_b, 0x03_b, 0x0a_b, 0x01_b, 0x62_b};
+    ASSERT_TRUE(Mode::get_value_from_result(message_coder<Event>::decode<Mode>(members), value));
+    EXPECT_TRUE(value.first["payload"_f].holds<"login">());
+    EXPECT_EQ(value.first["payload"_f].get_if<4>()->get<"user">(), "b");
+
+    ASSERT_TRUE(Mode::get_value_from_result(message_coder<Event>::decode_to<Mode>(e, members), rest));
+    EXPECT_EQ(e, value.first);
+    EXPECT_FALSE(e["id"_f].has_value());
+
+    ASSERT_TRUE(Mode::get_value_from_result(message_coder<Event>::decode_to<Mode>(e, bytes(buffer).first(5)), rest));
+    EXPECT_EQ(e["payload"_f].active_number(), 3);
+    EXPECT_EQ(*e["payload"_f].get_if<"code">(), 150);
+}
+
+template <unknown_storage St>
+using Proxy = message<uint32_field<"id", 1>, unknown_fields_field<"unknown", St>>;
+
+template <typename Mode, unknown_storage St>
+void test_unknown_fields() {
+    using P = Proxy<St>;
+
+    // id = 1, name (2) = "ab", age (3) = 5, id = 7, code (4, fixed32) = 0x04030201
+    array<byte, 15> a{0x08_b, 0x01_b, 0x12_b, 0x02_b, 0x61_b, 0x62_b, 0x18_b, 0x05_b, 0x08_b, 0x07_b,
+                      0x25_b, 0x01_b, 0x02_b, 0x03_b, 0x04_b};
+
+    decode_value<P> value;
+    ASSERT_TRUE(Mode::get_value_from_result(message_coder<P>::template decode<Mode>(a), value));
+    auto& p = value.first;
+    EXPECT_EQ(p["id"_f], 7);
+    EXPECT_EQ(p["unknown"_f].size(), 11);
+    EXPECT_EQ(p["unknown"_f].run_count(), St == unknown_storage::owned ? 1 : 2);
+
+    // unknown fields are encoded after the declared fields
+    p["id"_f] = 9;
+    array<byte, 16> buffer{};
+    bytes rest;
+    ASSERT_TRUE(Mode::get_value_from_result(message_coder<P>::template encode<Mode>(p, buffer), rest));
+    EXPECT_EQ(begin_diff(rest, buffer), 13);
+    EXPECT_EQ(skipper<message_coder<P>>::encode_skip(p), 13);
+    EXPECT_EQ(buffer, (array<byte, 16>{0x08_b, 0x09_b, 0x12_b, 0x02_b, 0x61_b, 0x62_b, 0x18_b, 0x05_b,
+                                       0x25_b, 0x01_b, 0x02_b, 0x03_b, 0x04_b}));
+
+    decode_value<P> reencoded;
+    ASSERT_TRUE(Mode::get_value_from_result(message_coder<P>::template decode<Mode>(bytes(buffer).first(13)), reencoded));
+    EXPECT_EQ(reencoded.first, p);
+    EXPECT_EQ(reencoded.first["unknown"_f].run_count(), 1);
+
+    // decoding into an existing message drops the fields recorded before
+    ASSERT_TRUE(Mode::get_value_from_result(message_coder<P>::template decode_to<Mode>(p, bytes(a).first(2)), rest));
+    EXPECT_TRUE(p["unknown"_f].empty());
+    ASSERT_TRUE(Mode::get_value_from_result(message_coder<P>::template decode_to<Mode>(p, bytes(a).first(8)), rest));
+    EXPECT_EQ(p["unknown"_f].size(), 6);
+    ASSERT_TRUE(Mode::get_value_from_result(message_coder<P>::template decode_to<Mode>(p, bytes(a).first(8)), rest));
+    EXPECT_EQ(p["unknown"_f].size(), 6);
+
+    P merged = p;
+    merged.merge(reencoded.first);
+    EXPECT_EQ(merged["id"_f], 9);
+    EXPECT_EQ(merged["unknown"_f].size(), 17);
+
+    // the message without the unknown fields slot skips them
+    decode_value<message<uint32_field<"id", 1>>> skipped;
+    ASSERT_TRUE(Mode::get_value_from_result(message_coder<message<uint32_field<"id", 1>>>::template decode<Mode>(a), skipped));
+    EXPECT_EQ(skipped.first["id"_f], 7);
+}
+
+TYPED_TEST(test_message_coder, unknown_fields) {
+    test_unknown_fields<typename TestFixture::mode, unknown_storage::owned>();
+    test_unknown_fields<typename TestFixture::mode, unknown_storage::view>();
+}
+
+GTEST_TEST(message_coder, unknown_fields_with_insufficient_buffer_size) {
+    Proxy<unknown_storage::owned> p;
+    p["id"_f] = 1;
+    array<byte, 4> unknown{0x18_b, 0x05_b, 0x20_b, 0x06_b};
+    p["unknown"_f].append(unknown);
+
+    run_safe_encode_tests_with_insufficient_buffer_size<message_coder<Proxy<unknown_storage::owned>>, 6>(p);
+}
+
+GTEST_TEST(message_coder, packed_with_insufficient_buffer_size) {
+    using Packed = message<uint32_field<"ids", 1, packed>, fixed32_field<"codes", 2, packed>>;
+
+    Packed p{vector<uint32>{1, 150, 3}, vector<uint32>{1, 2}};
+    vector<byte> buffer(skipper<message_coder<Packed>>::encode_skip(p));
+    message_coder<Packed>::encode<unsafe_mode>(p, buffer);
+
+    for (size_t i = 1; i < buffer.size(); ++i) {
+        EXPECT_FALSE(message_coder<Packed>::encode<safe_mode>(p, bytes{buffer.data(), i})) << "size " << i;
+        // the bytes truncated between two fields are still a valid message
+        if (i != 6) {
+            EXPECT_FALSE(message_coder<Packed>::decode<safe_mode>(bytes{buffer.data(), i})) << "size " << i;
+        }
+    }
+
+    // the length of packed fixed-length values should be a multiple of the value size
+    array<byte, 7> misaligned{0x12_b, 0x05_b, 0x01_b, 0x00_b, 0x00_b, 0x00_b, 0x02_b};
+    EXPECT_FALSE(message_coder<Packed>::decode<safe_mode>(misaligned));
+}
+
+GTEST_TEST(message_coder, decode_with_reserve_repeated_and_insufficient_buffer_size) {
+    using Class = message<string_field<"name", 8>, uint32_field<"grades", 6, repeated>>;
+
+    Class c{"class 101", vector<uint32>{1, 2, 3}};
+    vector<byte> buffer(skipper<message_coder<Class>>::encode_skip(c));
+    message_coder<Class>::encode<unsafe_mode>(c, buffer);
+
+    for (size_t i = 1; i < buffer.size(); ++i) {
+        const auto decoded = message_coder<Class>::decode<safe_mode>(bytes{buffer.data(), i});
+        const auto reserved = message_coder<Class>::decode<safe_mode>(bytes{buffer.data(), i}, reserve_repeated);
+        ASSERT_EQ(reserved.has_value(), decoded.has_value()) << "size " << i;
+    }
+}
+
+GTEST_TEST(message_coder, decode_into_with_insufficient_buffer_size) {
+    using Student = message<uint32_field<"id", 1>, string_field<"name", 3>>;
+    using Class = message<string_field<"name", 8>, message_field<"students", 3, Student, repeated>>;
+
+    Class c{"class 101", vector{Student{1u, "tom"}, Student{2u, "jerry"}}};
+    vector<byte> buffer(skipper<message_coder<Class>>::encode_skip(c));
+    message_coder<Class>::encode<unsafe_mode>(c, buffer);
+
+    for (size_t i = 1; i < buffer.size(); ++i) {
+        Class v = c;
+        const auto decoded = message_coder<Class>::decode<safe_mode>(bytes{buffer.data(), i});
+        const auto decoded_into = message_coder<Class>::decode_into<safe_mode>(v, bytes{buffer.data(), i});
+        ASSERT_EQ(decoded_into.has_value(), decoded.has_value()) << "size " << i;
+        if (decoded) {
+            EXPECT_EQ(v, decoded->first);
+        }
+    }
+}
+
 GTEST_TEST(message, fold) {
     message<int32_field<"int", 1>, string_field<"str", 2>> m {1, "hello"};
 
@@ -0,0 +1,237 @@
+//   Copyright 2020-2021 PragmaTwice
+//
+//   Licensed under the Apache License, Version 2.0 (the "License");
+//   you may not use this file except in compliance with the License.
+//   You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the License is distributed on an "AS IS" BASIS,
+//   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//   See the License for the specific language governing permissions and
+//   limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <protopuf/compact_message.h>
+#include <protopuf/field_stats.h>
+#include <protopuf/thread_pool.h>
+#include <array>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+using namespace pp;
+using namespace std;
+
+using Student = message<uint32_field<"id", 1>, string_field<"name", 3>>;
+using Class = message<string_field<"name", 8>, message_field<"students", 3, Student, repeated>,
+    uint32_field<"scores", 100, packed>>;
+
+struct recording_observer {
+    static inline vector<pair<bool, field_event>> events;
+
+    template <typename T>
+    static void on_field(const field_event& e) {
+        events.emplace_back(same_as<T, Student>, e);
+    }
+};
+
+GTEST_TEST(observer, static) {
+    static_assert(coder_observer<recording_observer>);
+    static_assert(coder_observer<field_stats<>>);
+    static_assert(coder_mode<observed_mode<recording_observer>>);
+    static_assert(coder_mode<observed_mode<field_stats<>, unsafe_mode>>);
+
+    // observations are empty out of observed modes
+    static_assert(is_empty_v<field_observation<safe_mode, Student>>);
+    static_assert(is_trivially_destructible_v<field_observation<observed_mode<recording_observer>, Student>>);
+    static_assert(!is_empty_v<field_observation<observed_mode<field_stats<void, true>>, Student>>);
+}
+
+GTEST_TEST(observer, events) {
+    using Mode = observed_mode<recording_observer>;
+
+    Class c{"class 101", vector<Student>{Student{123, "tom"}, Student{456, "jerry"}}, vector<pp::uint<4>>{1, 2, 300}};
+
+    array<byte, 64> a{};
+    bytes b;
+    recording_observer::events.clear();
+    ASSERT_TRUE(Mode::get_value_from_result(message_coder<Class>::encode<Mode>(c, a), b));
+    const auto size = begin_diff(b, a);
+
+    // fields of the students are encoded before the students themselves
+    const vector<pair<bool, pp::uint<4>>> encoded{{false, 8}, {true, 1}, {true, 3}, {false, 3}, {true, 1}, {true, 3}, {false, 3}, {false, 100}};
+    ASSERT_EQ(recording_observer::events.size(), encoded.size());
+    size_t total = 0;
+    for (size_t i = 0; i < encoded.size(); ++i) {
+        const auto& [is_student, e] = recording_observer::events[i];
+        EXPECT_EQ(is_student, encoded[i].first);
+        EXPECT_EQ(e.number, encoded[i].second);
+        EXPECT_EQ(e.direction, coder_direction::encode);
+        EXPECT_EQ(e.duration.count(), 0);
+        total += is_student ? 0 : e.size;
+    }
+    EXPECT_EQ(total, size);
+    EXPECT_EQ(recording_observer::events[0].second.size, 11);
+    EXPECT_EQ(recording_observer::events[0].second.wire_type, 2);
+    EXPECT_EQ(recording_observer::events[1].second.wire_type, 0);
+
+    recording_observer::events.clear();
+    decode_value<Class> v;
+    ASSERT_TRUE(Mode::get_value_from_result(message_coder<Class>::decode<Mode>(bytes{a.data(), size}), v));
+    EXPECT_EQ(v.first, c);
+    ASSERT_EQ(recording_observer::events.size(), encoded.size());
+    for (size_t i = 0; i < encoded.size(); ++i) {
+        EXPECT_EQ(recording_observer::events[i].second.number, encoded[i].second);
+        EXPECT_EQ(recording_observer::events[i].second.direction, coder_direction::decode);
+    }
+
+    // failed fields are not observed
+    recording_observer::events.clear();
+    EXPECT_FALSE((message_coder<Class>::decode<Mode>(bytes{a.data(), 10})));
+    EXPECT_TRUE(recording_observer::events.empty());
+}
+
+GTEST_TEST(observer, field_stats) {
+    struct tag {};
+    using stats = field_stats<tag, true>;
+    using Mode = observed_mode<stats, error_mode>;
+
+    Class c{"class 101", vector<Student>{Student{123, "tom"}, Student{456, "jerry"}}, vector<pp::uint<4>>{1, 2, 300}};
+
+    array<byte, 64> a{};
+    bytes b;
+    ASSERT_TRUE(Mode::get_value_from_result(message_coder<Class>::encode<Mode>(c, a), b));
+    const auto size = begin_diff(b, a);
+
+    vector<thread> threads;
+    for (size_t i = 0; i < 4; ++i) {
+        threads.emplace_back([&a, size] {
+            for (size_t j = 0; j < 100; ++j) {
+                Class v;
+                bytes rest;
+                EXPECT_TRUE(Mode::get_value_from_result(message_coder<Class>::decode_to<Mode>(v, bytes{a.data(), size}), rest));
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+
+    EXPECT_EQ((stats::totals<Student>(coder_direction::encode, 1)), (field_totals{2, 5, stats::totals<Student>(coder_direction::encode, 1).nanoseconds}));
+    EXPECT_EQ((stats::totals<Student>(coder_direction::decode, 1).count), 800);
+    EXPECT_EQ((stats::totals<Class>(coder_direction::decode, 3).count), 800);
+    EXPECT_EQ((stats::totals<Class>(coder_direction::decode, 8).bytes), 400 * 11);
+    EXPECT_EQ((stats::totals<Class>(coder_direction::decode, 100).count), 400);
+    EXPECT_EQ((stats::totals<Class>(coder_direction::decode, 2).count), 0);
+
+    ostringstream os;
+    stats::dump(os);
+    const string report = os.str();
+    EXPECT_NE(report.find("message<name, students, scores>\n"), string::npos) << report;
+    EXPECT_NE(report.find("message<id, name>\n"), string::npos) << report;
+    EXPECT_NE(report.find("  8 name: encode 1 times 11 bytes "), string::npos) << report;
+    EXPECT_NE(report.find("fields > 63: encode 1 times"), string::npos) << report;
+    EXPECT_NE(report.find("decode 400 times 4400 bytes "), string::npos) << report;
+
+    stats::reset();
+    EXPECT_EQ((stats::totals<Class>(coder_direction::decode, 8)), field_totals{});
+}
+
+using Event = message<uint32_field<"id", 1>, oneof_field<"payload", string_field<"text", 2>, int32_field<"code", 3>>>;
+
+GTEST_TEST(observer, field_stats_oneof) {
+    struct tag {};
+    using stats = field_stats<tag>;
+    using Mode = observed_mode<stats>;
+
+    Event e;
+    e["id"_f] = 1;
+    e["payload"_f].emplace<"text">("hi");
+
+    array<byte, 16> a{};
+    bytes b;
+    ASSERT_TRUE(Mode::get_value_from_result(message_coder<Event>::encode<Mode>(e, a), b));
+
+    decode_value<Event> v;
+    ASSERT_TRUE(Mode::get_value_from_result(message_coder<Event>::decode<Mode>(bytes{a.data(), b.data()}), v));
+    EXPECT_EQ(v.first, e);
+
+    // members of the oneof field are counted by their own numbers and names
+    EXPECT_EQ(observed_field_name<Event>(2), "text");
+    EXPECT_EQ(observed_field_name<Event>(3), "code");
+    EXPECT_EQ(observed_field_name<Event>(4), "");
+    EXPECT_EQ((stats::totals<Event>(coder_direction::encode, 2)), (field_totals{1, 4, 0}));
+    EXPECT_EQ((stats::totals<Event>(coder_direction::decode, 2)), (field_totals{1, 4, 0}));
+
+    ostringstream os;
+    stats::dump(os);
+    const string report = os.str();
+    EXPECT_NE(report.find("message<id, payload>\n"), string::npos) << report;
+    EXPECT_NE(report.find("  2 text: encode 1 times 4 bytes decode 1 times 4 bytes\n"), string::npos) << report;
+}
+
+using CompactStudent = compact_message<uint32_field<"id", 1>, string_field<"name", 3>, uint32_field<"scores", 4, packed>>;
+
+GTEST_TEST(observer, field_stats_compact_message) {
+    struct tag {};
+    using stats = field_stats<tag>;
+    using Mode = observed_mode<stats>;
+
+    CompactStudent s;
+    s["id"_f] = 123u;
+    s["name"_f] = "tom";
+    s["scores"_f] = vector<pp::uint<4>>{1, 2};
+
+    array<byte, 16> a{};
+    bytes b;
+    ASSERT_TRUE(Mode::get_value_from_result(message_coder<CompactStudent>::encode<Mode>(s, a), b));
+
+    decode_value<CompactStudent> v;
+    ASSERT_TRUE(Mode::get_value_from_result(message_coder<CompactStudent>::decode<Mode>(bytes{a.data(), b.data()}), v));
+    EXPECT_EQ(v.first, s);
+
+    // all fields are observed as fields of the compact message, whether they are singular or not
+    EXPECT_EQ(observed_field_name<CompactStudent>(3), "name");
+    EXPECT_EQ((stats::totals<CompactStudent>(coder_direction::encode, 1)), (field_totals{1, 2, 0}));
+    EXPECT_EQ((stats::totals<CompactStudent>(coder_direction::encode, 3)), (field_totals{1, 5, 0}));
+    EXPECT_EQ((stats::totals<CompactStudent>(coder_direction::encode, 4)), (field_totals{1, 4, 0}));
+    EXPECT_EQ((stats::totals<CompactStudent>(coder_direction::decode, 1)), (field_totals{1, 2, 0}));
+    EXPECT_EQ((stats::totals<CompactStudent>(coder_direction::decode, 3)), (field_totals{1, 5, 0}));
+    EXPECT_EQ((stats::totals<CompactStudent>(coder_direction::decode, 4)), (field_totals{1, 4, 0}));
+
+    ostringstream os;
+    stats::dump(os);
+    const string report = os.str();
+    EXPECT_EQ(report.find("compact_message<id, name, scores>\n"), 0) << report;
+    EXPECT_EQ(report.find("\nmessage<"), string::npos) << report;
+    EXPECT_NE(report.find("  3 name: encode 1 times 5 bytes decode 1 times 5 bytes\n"), string::npos) << report;
+}
+
+GTEST_TEST(observer, field_stats_executor) {
+    struct tag {};
+    using stats = field_stats<tag>;
+    using Mode = observed_mode<stats>;
+
+    Class c;
+    for (pp::uint<4> i = 0; i < 100; ++i) {
+        c["students"_f].push_back(Student{i, "tom"});
+    }
+
+    vector<byte> a(skipper<message_coder<Class>>::encode_skip(c));
+    thread_pool pool(4);
+    ASSERT_TRUE(message_coder<Class>::encode<Mode>(c, a, pool));
+
+    decode_value<Class> v;
+    ASSERT_TRUE(Mode::get_value_from_result(message_coder<Class>::decode<Mode>(a, pool), v));
+    EXPECT_EQ(v.first, c);
+
+    // elements coded by other threads are observed as well
+    for (auto direction : {coder_direction::encode, coder_direction::decode}) {
+        EXPECT_EQ((stats::totals<Class>(direction, 3)), (field_totals{100, a.size(), 0}));
+        EXPECT_EQ((stats::totals<Student>(direction, 1).count), 100);
+        EXPECT_EQ((stats::totals<Student>(direction, 3).count), 100);
+    }
+}
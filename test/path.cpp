@@ -0,0 +1,150 @@
+//   Copyright 2020-2021 PragmaTwice
+//
+//   Licensed under the Apache License, Version 2.0 (the "License");
+//   you may not use this file except in compliance with the License.
+//   You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the License is distributed on an "AS IS" BASIS,
+//   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//   See the License for the specific language governing permissions and
+//   limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <protopuf/path.h>
+#include <array>
+#include <vector>
+
+#include "test_fixture.h"
+
+using namespace pp;
+using namespace std;
+
+using Book = message<string_field<"name", 1>, bytes_field<"isbn", 2>>;
+using Student = message<uint32_field<"id", 1>, string_field<"name", 3>, message_field<"books", 5, Book, repeated>>;
+using Class = message<string_field<"name", 8>, message_field<"students", 3, Student, repeated>>;
+
+GTEST_TEST(field_path, static) {
+    static_assert(is_same_v<field_name_path<Class, "name">, field_type_path<Class::get_type_by_name<"name">>>);
+    static_assert(is_same_v<field_name_path<Class, "students", "id">,
+        field_type_path<Class::get_type_by_name<"students">, Student::get_type_by_name<"id">>>);
+    static_assert(is_same_v<field_name_path<Class, "students", "books", "name">, field_number_path<Class, 3, 5, 1>>);
+
+    static_assert(is_same_v<view_decoder<string_coder>::value_type, string_view>);
+    static_assert(is_same_v<view_decoder<bytes_coder>::value_type, span<const pp::uint<1>>>);
+    static_assert(is_same_v<view_decoder<embedded_message_coder<Book>>::value_type, bytes>);
+    static_assert(is_same_v<view_decoder<varint_coder<pp::uint<4>>>::value_type, pp::uint<4>>);
+}
+
+template<typename T>
+struct test_field_path : test_fixture<T> {};
+TYPED_TEST_SUITE(test_field_path, coder_mode_types, test_name_generator);
+
+TYPED_TEST(test_field_path, extract) {
+    Book a{"a", vector<pp::uint<1>>{1, 2}}, b{"b", optional<vector<pp::uint<1>>>{}}, c{"c", vector<pp::uint<1>>{3}};
+    Student twice {123u, "twice", vector{a, b}}, tom{456u, "tom", vector<Book>{}}, jerry{123456u, "jerry", vector{c}};
+    Class myClass {"class 101", vector{tom, jerry, twice}};
+
+    array<byte, 128> buffer{};
+    bytes end;
+    ASSERT_TRUE(TestFixture::mode::get_value_from_result(
+        message_coder<Class>::encode<typename TestFixture::mode>(myClass, buffer), end));
+    bytes encoded = bytes(buffer).first(begin_diff(end, buffer));
+
+    {
+        vector<pp::uint<4>> ids;
+        bytes rest;
+        ASSERT_TRUE(TestFixture::mode::get_value_from_result(
+            field_name_path<Class, "students", "id">::extract<typename TestFixture::mode>(encoded, [&ids](pp::uint<4> id) {
+                ids.push_back(id);
+            }), rest));
+        EXPECT_EQ(ids, (vector<pp::uint<4>>{456, 123456, 123}));
+        EXPECT_EQ(begin_diff(rest, encoded), encoded.size());
+    }
+
+    {
+        vector<string_view> names;
+        bytes rest;
+        ASSERT_TRUE(TestFixture::mode::get_value_from_result(
+            field_name_path<Class, "students", "books", "name">::extract<typename TestFixture::mode>(encoded, [&names](string_view name) {
+                names.push_back(name);
+            }), rest));
+        EXPECT_EQ(names, (vector<string_view>{"c", "a", "b"}));
+        EXPECT_GE(reinterpret_cast<const byte*>(names[0].data()), encoded.data());
+        EXPECT_LT(reinterpret_cast<const byte*>(names[0].data()), encoded.data() + encoded.size());
+    }
+
+    {
+        vector<pp::uint<1>> isbn;
+        bytes rest;
+        ASSERT_TRUE(TestFixture::mode::get_value_from_result(
+            field_number_path<Class, 3, 5, 2>::extract<typename TestFixture::mode>(encoded, [&isbn](span<const pp::uint<1>> s) {
+                isbn.insert(isbn.end(), s.begin(), s.end());
+            }), rest));
+        EXPECT_EQ(isbn, (vector<pp::uint<1>>{3, 1, 2}));
+    }
+
+    {
+        vector<Student> students;
+        bytes rest;
+        ASSERT_TRUE(TestFixture::mode::get_value_from_result(
+            field_name_path<Class, "students">::extract<typename TestFixture::mode>(encoded, [&students](bytes s) {
+                students.push_back(message_coder<Student>::decode<unsafe_mode>(s).first);
+            }), rest));
+        EXPECT_EQ(students, (vector<Student>{tom, jerry, twice}));
+    }
+
+    {
+        string_view name;
+        bytes rest;
+        ASSERT_TRUE(TestFixture::mode::get_value_from_result(
+            field_name_path<Class, "name">::extract<typename TestFixture::mode>(encoded, [&name](string_view s) {
+                name = s;
+            }), rest));
+        EXPECT_EQ(name, "class 101");
+    }
+}
+
+TYPED_TEST(test_field_path, extract_packed) {
+    using Report = message<string_field<"name", 1>, uint32_field<"scores", 2, packed>>;
+    using Reports = message<message_field<"reports", 1, Report, repeated>>;
+
+    Reports reports{vector{Report{"a", vector<pp::uint<4>>{1, 300}}, Report{"b", vector<pp::uint<4>>{}}, Report{"c", vector<pp::uint<4>>{7}}}};
+
+    array<byte, 64> buffer{};
+    bytes end;
+    ASSERT_TRUE(TestFixture::mode::get_value_from_result(
+        message_coder<Reports>::encode<typename TestFixture::mode>(reports, buffer), end));
+    bytes encoded = bytes(buffer).first(begin_diff(end, buffer));
+
+    vector<pp::uint<4>> scores;
+    bytes rest;
+    ASSERT_TRUE(TestFixture::mode::get_value_from_result(
+        (field_name_path<Reports, "reports", "scores">::extract<typename TestFixture::mode>(encoded, [&scores](pp::uint<4> i) {
+            scores.push_back(i);
+        })), rest));
+    EXPECT_EQ(scores, (vector<pp::uint<4>>{1, 300, 7}));
+}
+
+GTEST_TEST(field_path, extract_with_insufficient_buffer_size) {
+    Student twice {123u, "twice", vector<Book>{}}, tom{456u, "tom", vector<Book>{}};
+    Class myClass {"class 101", vector{tom, twice}};
+
+    array<byte, 64> buffer{};
+    auto end = *message_coder<Class>::encode<safe_mode>(myClass, buffer);
+    bytes encoded = bytes(buffer).first(begin_diff(end, buffer));
+
+    for (size_t i = 1; i < encoded.size(); ++i) {
+        auto truncated = encoded.first(i);
+        auto result = field_name_path<Class, "students", "id">::extract<safe_mode>(truncated, [](auto) {});
+        auto decoded = message_coder<Class>::decode<safe_mode>(truncated);
+        EXPECT_EQ(result.has_value(), decoded.has_value()) << "Buffer size " << i;
+    }
+
+    array<byte, 3> bad_wire_type{0x0b_b, 0x00_b, 0x00_b};
+    auto bad_result = field_name_path<Class, "students", "id">::extract<safe_mode>(bad_wire_type, [](auto) {});
+    EXPECT_FALSE(bad_result);
+}
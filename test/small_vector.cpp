@@ -0,0 +1,180 @@
+//   Copyright 2020-2021 PragmaTwice
+//
+//   Licensed under the Apache License, Version 2.0 (the "License");
+//   you may not use this file except in compliance with the License.
+//   You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the License is distributed on an "AS IS" BASIS,
+//   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//   See the License for the specific language governing permissions and
+//   limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <protopuf/message.h>
+#include <protopuf/small_vector.h>
+#include <array>
+#include <limits>
+#include <string>
+
+#include "test_fixture.h"
+
+using namespace pp;
+using namespace std;
+
+GTEST_TEST(small_vector, static) {
+    static_assert(std::ranges::contiguous_range<small_vector<int, 4>>);
+    static_assert(std::ranges::sized_range<small_vector<int, 4>>);
+    static_assert(!bounded_range<small_vector<int, 4>>);
+    static_assert(bounded_range<static_vector<int, 4>>);
+    static_assert(bounded_range<inline_string<16>>);
+    static_assert(insertable_sized_range<small_vector<string, 4>>);
+    static_assert(insertable_sized_range<inline_string<16>>);
+}
+
+GTEST_TEST(small_vector, grow) {
+    small_vector<string, 2> v{"a", "b"};
+    EXPECT_TRUE(v.is_inline());
+    EXPECT_EQ(v.capacity(), 2);
+
+    v.push_back(v[0]);
+    EXPECT_FALSE(v.is_inline());
+    EXPECT_EQ(v, (small_vector<string, 2>{"a", "b", "a"}));
+
+    v.insert(v.begin() + 1, "c");
+    EXPECT_EQ(v, (small_vector<string, 2>{"a", "c", "b", "a"}));
+
+    v.erase(v.begin(), v.begin() + 2);
+    EXPECT_EQ(v, (small_vector<string, 2>{"b", "a"}));
+
+    v.resize(3);
+    EXPECT_EQ(v, (small_vector<string, 2>{"b", "a", ""}));
+
+    v.clear();
+    EXPECT_TRUE(v.empty());
+}
+
+GTEST_TEST(small_vector, copy_and_move) {
+    small_vector<string, 2> inline_v{"a", "b"}, heap_v{"a", "b", "c"};
+
+    auto inline_copy = inline_v, heap_copy = heap_v;
+    EXPECT_EQ(inline_copy, inline_v);
+    EXPECT_EQ(heap_copy, heap_v);
+
+    const auto heap_data = heap_v.data();
+    auto inline_moved = std::move(inline_v), heap_moved = std::move(heap_v);
+    EXPECT_EQ(inline_moved, inline_copy);
+    EXPECT_TRUE(inline_moved.is_inline());
+    EXPECT_EQ(heap_moved, heap_copy);
+    EXPECT_EQ(heap_moved.data(), heap_data);
+    EXPECT_TRUE(inline_v.empty());
+    EXPECT_TRUE(heap_v.empty());
+
+    inline_moved = std::move(heap_moved);
+    EXPECT_EQ(inline_moved, heap_copy);
+    heap_moved = inline_copy;
+    EXPECT_EQ(heap_moved, inline_copy);
+}
+
+GTEST_TEST(static_vector, bounded) {
+    static_vector<int, 2> v{1, 2};
+    EXPECT_THROW(v.push_back(3), std::length_error);
+    EXPECT_EQ(v, (static_vector<int, 2>{1, 2}));
+    EXPECT_EQ((static_vector<int, 2>::static_capacity), 2);
+}
+
+GTEST_TEST(inline_string, string) {
+    inline_string<8> s = "hello";
+    EXPECT_EQ(s, "hello");
+    EXPECT_EQ(s, string_view("hello"));
+    EXPECT_EQ(s.length(), 5);
+    EXPECT_EQ(string(s.view()), "hello");
+    EXPECT_THROW((inline_string<4>("hello")), std::length_error);
+}
+
+GTEST_TEST(max_encoded_size, static) {
+    static_assert(max_encoded_size<varint_coder<uint32>> == 5);
+    static_assert(max_encoded_size<varint_coder<uint64>> == 10);
+    static_assert(max_encoded_size<varint_coder<int32>> == 5);
+    static_assert(max_encoded_size<varint_coder<sint64>> == 10);
+    static_assert(max_encoded_size<integer_coder<uint32>> == 4);
+    static_assert(max_encoded_size<bool_coder> == 1);
+    static_assert(max_encoded_size<inline_string_coder<24>> == 25);
+    static_assert(max_encoded_size<inline_string_coder<200>> == 202);
+    static_assert(max_encoded_size<array_coder<varint_coder<uint32>, static_vector<uint32, 4>>> == 21);
+    static_assert(!bounded_coder<string_coder>);
+    static_assert(!bounded_coder<array_coder<varint_coder<uint32>, small_vector<uint32, 4>>>);
+
+    using Student = message<uint32_field<"id", 1>, inline_string_field<"name", 3, 8>>;
+    using Class = message<inline_string_field<"name", 8, 16>, message_field<"students", 3, Student, repeated, static_vector<Student, 2>>>;
+    static_assert(max_encoded_size<message_coder<Student>> == 1 + 5 + 1 + 9);
+    static_assert(max_encoded_size<message_coder<Class>> == 1 + 17 + 2 * (1 + 1 + 16));
+    static_assert(!bounded_coder<message_coder<message<uint32_field<"id", 1>, string_field<"name", 3>>>>);
+    static_assert(!bounded_coder<message_coder<message<uint32_field<"ids", 1, repeated>>>>);
+}
+
+using Student = message<uint32_field<"id", 1>, inline_string_field<"name", 3, 8>>;
+using Class = message<inline_string_field<"name", 8, 16>, message_field<"students", 3, Student, repeated, static_vector<Student, 2>>,
+    uint32_field<"grades", 6, repeated, small_vector<uint32, 4>>>;
+
+template <typename T>
+struct test_small_vector : testing::Test {};
+TYPED_TEST_SUITE(test_small_vector, coder_mode_types, test_name_generator);
+
+TYPED_TEST(test_small_vector, round_trip) {
+    using Mode = TypeParam;
+    using SmallClass = message<inline_string_field<"name", 8, 16>, message_field<"students", 3, Student, repeated, static_vector<Student, 2>>>;
+
+    SmallClass c{"class 101", static_vector<Student, 2>{Student{numeric_limits<uint32>::max(), "12345678"}, Student{2u, "tom"}}};
+
+    array<byte, max_encoded_size<message_coder<SmallClass>>> buffer{};
+    bytes rest;
+    ASSERT_TRUE(Mode::get_value_from_result(message_coder<SmallClass>::encode<Mode>(c, buffer), rest));
+
+    decode_value<SmallClass> value;
+    ASSERT_TRUE(Mode::get_value_from_result(message_coder<SmallClass>::decode<Mode>(bytes{buffer.data(), static_cast<size_t>(rest.data() - buffer.data())}), value));
+    EXPECT_EQ(value.first, c);
+
+    Class full{"class 101", static_vector<Student, 2>{Student{1u, "twice"}, Student{2u, "tom"}}, small_vector<uint32, 4>{1, 2, 3, 4, 5}};
+    vector<byte> full_buffer(skipper<message_coder<Class>>::encode_skip(full));
+    message_coder<Class>::encode<unsafe_mode>(full, full_buffer);
+
+    decode_value<Class> full_value;
+    ASSERT_TRUE(Mode::get_value_from_result(message_coder<Class>::decode<Mode>(full_buffer), full_value));
+    EXPECT_EQ(full_value.first, full);
+    EXPECT_FALSE(full_value.first["grades"_f].is_inline());
+
+    Class into;
+    ASSERT_TRUE(Mode::get_value_from_result(message_coder<Class>::decode_into<Mode>(into, full_buffer), rest));
+    EXPECT_EQ(into, full);
+}
+
+GTEST_TEST(small_vector, decode_oversize) {
+    using LongStudent = message<uint32_field<"id", 1>, string_field<"name", 3>>;
+    using LongClass = message<string_field<"name", 8>, message_field<"students", 3, LongStudent, repeated>>;
+
+    auto encode = [](const LongClass& c) -> vector<byte> {
+        vector<byte> buffer(skipper<message_coder<LongClass>>::encode_skip(c));
+        message_coder<LongClass>::encode<unsafe_mode>(c, buffer);
+        return buffer;
+    };
+
+    auto long_name = encode(LongClass{"a class name over 16 bytes", vector<LongStudent>{}});
+    EXPECT_FALSE(message_coder<Class>::decode<safe_mode>(long_name).has_value());
+    Class into;
+    EXPECT_FALSE(message_coder<Class>::decode_into<safe_mode>(into, long_name).has_value());
+
+    auto many_students = encode(LongClass{"class", vector{LongStudent{1u, "a"}, LongStudent{2u, "b"}, LongStudent{3u, "c"}}});
+    EXPECT_FALSE(message_coder<Class>::decode<safe_mode>(many_students).has_value());
+    EXPECT_FALSE(message_coder<Class>::decode_into<safe_mode>(into, many_students).has_value());
+
+    auto long_student_name = encode(LongClass{"class", vector{LongStudent{1u, "a student name"}}});
+    EXPECT_FALSE(message_coder<Class>::decode<safe_mode>(long_student_name).has_value());
+    EXPECT_FALSE(message_coder<Class>::decode_into<safe_mode>(into, long_student_name).has_value());
+
+    auto fit = encode(LongClass{"class", vector{LongStudent{1u, "a"}, LongStudent{2u, "b"}}});
+    EXPECT_TRUE(message_coder<Class>::decode<safe_mode>(fit).has_value());
+}
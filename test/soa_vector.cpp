@@ -0,0 +1,142 @@
+//   Copyright 2020-2021 PragmaTwice
+//
+//   Licensed under the Apache License, Version 2.0 (the "License");
+//   you may not use this file except in compliance with the License.
+//   You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the License is distributed on an "AS IS" BASIS,
+//   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//   See the License for the specific language governing permissions and
+//   limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <protopuf/soa_vector.h>
+#include <array>
+
+#include "test_fixture.h"
+
+using namespace pp;
+using namespace std;
+
+using Row = message<uint32_field<"id", 1>, string_field<"name", 2>, int32_field<"tags", 3, repeated>>;
+using Table = message<string_field<"title", 1>, message_field<"rows", 2, Row, repeated, soa_vector<Row>>>;
+using PlainTable = message<string_field<"title", 1>, message_field<"rows", 2, Row, repeated>>;
+
+static_assert(std::random_access_iterator<soa_vector<Row>::iterator>);
+static_assert(std::random_access_iterator<soa_vector<Row>::const_iterator>);
+static_assert(self_decoding_container<soa_vector<Row>, embedded_message_coder<Row>, safe_mode>);
+
+GTEST_TEST(soa_vector, function) {
+    soa_vector<Row> rows{Row{1, "tom", std::vector{1}}, Row{2, std::nullopt, std::vector<int32>{}}};
+    EXPECT_EQ(rows.size(), 2);
+
+    EXPECT_EQ(rows[0]["id"_f], 1);
+    EXPECT_EQ(rows[0].get<2>(), "tom");
+    EXPECT_EQ(rows[1]["name"_f], std::nullopt);
+    EXPECT_EQ(rows[0]["tags"_f], (std::vector{1}));
+    EXPECT_EQ(Row(rows[1]), (Row{2, std::nullopt, std::vector<int32>{}}));
+
+    rows[1]["name"_f] = "jerry";
+    rows[1]["tags"_f].push_back(3);
+    EXPECT_EQ(rows[1], (Row{2, "jerry", std::vector{3}}));
+
+    EXPECT_EQ(rows.column<"id">().values, (std::vector<uint32>{1, 2}));
+    EXPECT_EQ(rows.column<2>().present_count(), 2);
+
+    auto row = rows.emplace_back();
+    EXPECT_EQ(rows.size(), 3);
+    EXPECT_FALSE(row.get<1>().has_value());
+    row.get<1>() = 3u;
+
+    rows.insert(rows.begin() + 1, Row{4, "spike", std::vector<int32>{}});
+    EXPECT_EQ(rows.size(), 4);
+    EXPECT_EQ(rows[1]["id"_f], 4);
+    EXPECT_EQ(rows[2]["name"_f], "jerry");
+    EXPECT_EQ(rows.back()["name"_f], std::nullopt);
+
+    std::vector<uint32> ids;
+    for (const auto& r : rows) {
+        ids.push_back(*r.get<1>());
+    }
+    EXPECT_EQ(ids, (std::vector<uint32>{1, 4, 2, 3}));
+
+    rows.pop_back();
+    rows.emplace_back();
+    EXPECT_FALSE(rows.back()["id"_f].has_value());
+
+    auto copy = rows;
+    EXPECT_EQ(copy, rows);
+    copy[0] = copy[1];
+    EXPECT_EQ(copy[0], (Row{4, "spike", std::vector<int32>{}}));
+    EXPECT_FALSE(copy == rows);
+
+    rows.clear();
+    EXPECT_TRUE(rows.empty());
+}
+
+GTEST_TEST(soa_vector, many_rows) {
+    soa_vector<Row> rows;
+    rows.resize(130);
+    for (std::size_t i = 0; i < rows.size(); i += 3) {
+        rows[i]["id"_f] = static_cast<uint32>(i);
+    }
+
+    EXPECT_EQ(rows.column<"id">().present_count(), 44);
+    EXPECT_EQ(rows[129]["id"_f], 129);
+    EXPECT_FALSE(rows[128]["id"_f].has_value());
+
+    rows.resize(64);
+    rows.resize(130);
+    EXPECT_EQ(rows.column<"id">().present_count(), 22);
+    EXPECT_FALSE(rows[129]["id"_f].has_value());
+}
+
+template<typename T>
+struct test_soa_vector : test_fixture<T> {};
+TYPED_TEST_SUITE(test_soa_vector, coder_mode_types, test_name_generator);
+
+TYPED_TEST(test_soa_vector, coder) {
+    using Mode = typename TestFixture::mode;
+
+    PlainTable p{"students", std::vector{Row{1, "tom", std::vector{1, 2}}, Row{2, std::nullopt, std::vector<int32>{}}, Row{3, "jerry", std::vector{3}}}};
+    Table t{"students", soa_vector<Row>{Row{1, "tom", std::vector{1, 2}}, Row{2, std::nullopt, std::vector<int32>{}}, Row{3, "jerry", std::vector{3}}}};
+
+    array<byte, 64> a{}, b{};
+    bytes pn, tn;
+    ASSERT_TRUE(Mode::get_value_from_result(message_coder<PlainTable>::encode<Mode>(p, a), pn));
+    ASSERT_TRUE(Mode::get_value_from_result(message_coder<Table>::encode<Mode>(t, b), tn));
+    EXPECT_EQ(begin_diff(tn, b), begin_diff(pn, a));
+    EXPECT_EQ(a, b);
+    EXPECT_EQ(skipper<message_coder<Table>>::encode_skip(t), skipper<message_coder<PlainTable>>::encode_skip(p));
+
+    decode_value<Table> value;
+    ASSERT_TRUE(Mode::get_value_from_result(message_coder<Table>::decode<Mode>(bytes{a.data(), pn.data()}), value));
+    EXPECT_EQ(value.first, t);
+    EXPECT_EQ(value.first["rows"_f].column<"id">().values, (std::vector<uint32>{1, 2, 3}));
+    EXPECT_EQ(value.first["rows"_f].column<"name">().present_count(), 2);
+
+    Table d{"old", soa_vector<Row>{Row{9, "spike", std::vector{9}}}};
+    bytes rest;
+    ASSERT_TRUE(Mode::get_value_from_result(message_coder<Table>::decode_to<Mode>(d, bytes{a.data(), pn.data()}), rest));
+    EXPECT_EQ(d, t);
+}
+
+GTEST_TEST(soa_vector_coder, decode_with_insufficient_buffer_size) {
+    Table t{"t", soa_vector<Row>{Row{1, "tom", std::vector{1, 2}}}};
+
+    const auto size = skipper<message_coder<Table>>::encode_skip(t);
+    std::vector<byte> a(size);
+    ASSERT_TRUE(message_coder<Table>::encode(t, bytes{a.data(), size}));
+
+    for (std::size_t i = 1; i < size; ++i) {
+        if (i == 3) {
+            // truncated at a field boundary, which is a valid message
+            continue;
+        }
+        EXPECT_FALSE(message_coder<Table>::decode(bytes{a.data(), i}));
+    }
+}
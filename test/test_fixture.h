@@ -33,7 +33,7 @@ struct test_fixture : testing::Test {
     using mode = T;
 };
 
-using coder_mode_types = testing::Types<pp::unsafe_mode, pp::safe_mode>;
+using coder_mode_types = testing::Types<pp::unsafe_mode, pp::safe_mode, pp::error_mode>;
 
 class test_name_generator {
 public:
@@ -41,6 +41,7 @@ public:
     static std::string GetName(int) {
         if constexpr (std::is_same_v<T, pp::safe_mode>) return "safe";
         if constexpr (std::is_same_v<T, pp::unsafe_mode>) return "unsafe";
+        if constexpr (std::is_same_v<T, pp::error_mode>) return "error";
   }
 };
 
@@ -64,6 +65,12 @@ inline void run_safe_decode_test_with_insufficient_buffer_size(pp::bytes buffer,
                 source_location::current()) {
     ASSERT_FALSE(Coder::template decode<pp::safe_mode>(buffer.subspan(0, size))) << "Buffer size " << size << ' ' <<
         '(' << location.file_name() << ':' << location.line() << ')';
+
+    if constexpr (pp::in_place_decoder<Coder, pp::safe_mode>) {
+        typename Coder::value_type v{};
+        ASSERT_FALSE(Coder::template decode_to<pp::safe_mode>(v, buffer.subspan(0, size))) << "Buffer size " << size << ' ' <<
+            '(' << location.file_name() << ':' << location.line() << ')';
+    }
 }
 
 template<pp::coder Coder, std::size_t size>
@@ -0,0 +1,211 @@
+//   Copyright 2020-2021 PragmaTwice
+//
+//   Licensed under the Apache License, Version 2.0 (the "License");
+//   you may not use this file except in compliance with the License.
+//   You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the License is distributed on an "AS IS" BASIS,
+//   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//   See the License for the specific language governing permissions and
+//   limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <protopuf/message.h>
+#include <protopuf/thread_pool.h>
+#include <atomic>
+#include <chrono>
+#include <vector>
+
+#include "test_fixture.h"
+
+using namespace pp;
+using namespace std;
+
+GTEST_TEST(thread_pool, static) {
+    static_assert(executor<thread_pool>);
+    static_assert(executor<sequential_executor>);
+}
+
+GTEST_TEST(thread_pool, parallel_for) {
+    for (size_t concurrency : {1, 2, 4, 7}) {
+        thread_pool pool(concurrency);
+        EXPECT_EQ(pool.concurrency(), concurrency);
+
+        for (size_t n : {0, 1, 3, 100, 10007}) {
+            vector<atomic<int>> visited(n);
+            pool.parallel_for(n, [&visited](size_t begin, size_t end) {
+                for (size_t i = begin; i < end; ++i) {
+                    ++visited[i];
+                }
+            });
+
+            for (size_t i = 0; i < n; ++i) {
+                ASSERT_EQ(visited[i], 1) << "index " << i << " of " << n << " with concurrency " << concurrency;
+            }
+        }
+    }
+}
+
+GTEST_TEST(thread_pool, nested_parallel_for) {
+    thread_pool pool(4);
+    atomic<size_t> count = 0;
+
+    pool.parallel_for(16, [&pool, &count](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            pool.parallel_for(100, [&count](size_t b, size_t e) {
+                count += e - b;
+            });
+        }
+    }, 1);
+
+    EXPECT_EQ(count, 1600);
+}
+
+GTEST_TEST(thread_pool, unbalanced_parallel_for) {
+    thread_pool pool(4);
+    vector<atomic<int>> visited(1000);
+
+    // the first chunks are much more expensive, so that the other threads have to steal them
+    pool.parallel_for(visited.size(), [&visited](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            if (i < 100) {
+                this_thread::sleep_for(chrono::microseconds(100));
+            }
+            ++visited[i];
+        }
+    }, 1);
+
+    for (size_t i = 0; i < visited.size(); ++i) {
+        ASSERT_EQ(visited[i], 1) << "index " << i;
+    }
+}
+
+using Student = message<uint32_field<"id", 1>, string_field<"name", 3>>;
+using Class = message<string_field<"name", 8>, message_field<"students", 3, Student, repeated>, message_field<"monitor", 4, Student>,
+    string_field<"tags", 5, repeated>, uint32_field<"grades", 6, repeated>>;
+
+static vector<byte> make_class_buffer(Class& c, size_t students) {
+    c["name"_f] = "class 101";
+    c["monitor"_f] = Student{1u, "twice"};
+    for (size_t i = 0; i < students; ++i) {
+        c["students"_f].push_back(Student{static_cast<uint32>(i), "student " + to_string(i)});
+        c["tags"_f].push_back(string(i % 200, 'x'));
+        c["grades"_f].push_back(static_cast<uint32>(i * i));
+    }
+
+    vector<byte> buffer(skipper<message_coder<Class>>::encode_skip(c));
+    message_coder<Class>::encode<unsafe_mode>(c, buffer);
+    return buffer;
+}
+
+template<typename T>
+struct test_parallel_decode : test_fixture<T> {};
+TYPED_TEST_SUITE(test_parallel_decode, coder_mode_types, test_name_generator);
+
+TYPED_TEST(test_parallel_decode, decode) {
+    thread_pool pool(4);
+
+    for (size_t students : {0, 1, 2, 1000}) {
+        Class c;
+        auto buffer = make_class_buffer(c, students);
+
+        decode_value<Class> value;
+        ASSERT_TRUE(TestFixture::mode::get_value_from_result(
+            message_coder<Class>::decode<typename TestFixture::mode>(buffer, pool), value));
+        const auto& [v, n] = value;
+        EXPECT_EQ(v, c);
+        EXPECT_EQ(begin_diff(n, buffer), buffer.size());
+
+        decode_value<Class> value2;
+        sequential_executor seq;
+        ASSERT_TRUE(TestFixture::mode::get_value_from_result(
+            message_coder<Class>::decode<typename TestFixture::mode>(buffer, seq), value2));
+        EXPECT_EQ(value2.first, c);
+    }
+}
+
+GTEST_TEST(parallel_decode, decode_with_insufficient_buffer_size) {
+    thread_pool pool(4);
+
+    Class c;
+    auto buffer = make_class_buffer(c, 100);
+
+    for (size_t size = 0; size < buffer.size(); size += 7) {
+        bytes truncated = bytes(buffer).first(size);
+        EXPECT_EQ(message_coder<Class>::decode<safe_mode>(truncated, pool).has_value(),
+                  message_coder<Class>::decode<safe_mode>(truncated).has_value()) << "Buffer size " << size;
+    }
+
+    // make the length prefix of the last student name overflow the student message
+    auto corrupted = buffer;
+    for (size_t i = corrupted.size() - 3; i > 0; --i) {
+        if (corrupted[i] == 0x1a_b && corrupted[i + 1] == 0x0a_b && corrupted[i + 2] == byte{'s'}) {
+            corrupted[i + 1] = 0x7f_b;
+            break;
+        }
+    }
+    EXPECT_FALSE(message_coder<Class>::decode<safe_mode>(corrupted).has_value());
+    EXPECT_FALSE(message_coder<Class>::decode<safe_mode>(corrupted, pool).has_value());
+}
+
+template<typename T>
+struct test_parallel_encode : test_fixture<T> {};
+TYPED_TEST_SUITE(test_parallel_encode, coder_mode_types, test_name_generator);
+
+TYPED_TEST(test_parallel_encode, encode) {
+    thread_pool pool(4);
+
+    for (size_t students : {0, 1, 2, 1000}) {
+        Class c;
+        auto expected = make_class_buffer(c, students);
+
+        vector<byte> buffer(expected.size() + 10);
+        bytes n;
+        ASSERT_TRUE(TestFixture::mode::get_value_from_result(
+            message_coder<Class>::encode<typename TestFixture::mode>(c, buffer, pool), n));
+        EXPECT_EQ(begin_diff(n, buffer), expected.size());
+        EXPECT_TRUE(equal(expected.begin(), expected.end(), buffer.begin()));
+    }
+}
+
+GTEST_TEST(parallel_encode, encode_with_insufficient_buffer_size) {
+    thread_pool pool(4);
+
+    Class c;
+    auto expected = make_class_buffer(c, 100);
+
+    for (size_t size = 0; size < expected.size(); size += 7) {
+        vector<byte> buffer(size);
+        EXPECT_FALSE(message_coder<Class>::encode<safe_mode>(c, buffer, pool).has_value()) << "Buffer size " << size;
+    }
+}
+
+// an executor which runs loops in the calling thread and counts them
+struct counting_executor {
+    size_t loops = 0;
+
+    template <typename F>
+    void parallel_for(size_t n, F&& f) {
+        ++loops;
+        if (n > 0) {
+            f(0, n);
+        }
+    }
+};
+
+GTEST_TEST(parallel_encode, encode_small_fields_sequentially) {
+    for (size_t students : {min_parallel_encode_elements - 1, min_parallel_encode_elements}) {
+        Class c;
+        auto expected = make_class_buffer(c, students);
+
+        counting_executor exec;
+        vector<byte> buffer(expected.size());
+        ASSERT_TRUE(message_coder<Class>::encode<safe_mode>(c, buffer, exec).has_value());
+        EXPECT_EQ(buffer, expected);
+        EXPECT_EQ(exec.loops, students < min_parallel_encode_elements ? 0 : 4) << "Students " << students;
+    }
+}
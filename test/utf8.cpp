@@ -0,0 +1,158 @@
+//   Copyright 2020-2021 PragmaTwice
+//
+//   Licensed under the Apache License, Version 2.0 (the "License");
+//   you may not use this file except in compliance with the License.
+//   You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the License is distributed on an "AS IS" BASIS,
+//   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//   See the License for the specific language governing permissions and
+//   limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <protopuf/message.h>
+#include <protopuf/path.h>
+#include <array>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "test_fixture.h"
+
+using namespace pp;
+using namespace std;
+
+static bool scalar_valid(const vector<unsigned char>& s) {
+    return validate_utf8_scalar(s.data(), s.size(), 0, s.size()) != numeric_limits<size_t>::max();
+}
+
+static bool copy_valid(const vector<unsigned char>& s) {
+    vector<unsigned char> out(s.size());
+    const bool valid = copy_utf8(out.data(), as_bytes(span(s)));
+    if (valid) {
+        EXPECT_EQ(out, s);
+    }
+    return valid;
+}
+
+GTEST_TEST(utf8, block_boundaries) {
+    // every kind of character and error, put at every offset around the 16 and 32 byte blocks
+    const vector<vector<unsigned char>> pieces{
+        {0xc2, 0xa9}, {0xe4, 0xbd, 0xa0}, {0xf0, 0x9f, 0x98, 0x80}, {0xf4, 0x8f, 0xbf, 0xbf}, {0xef, 0xbf, 0xbf},
+        {0x80}, {0xc0, 0xaf}, {0xc1, 0xbf}, {0xe0, 0x80, 0xaf}, {0xed, 0xa0, 0x80}, {0xf0, 0x8f, 0xbf, 0xbf},
+        {0xf4, 0x90, 0x80, 0x80}, {0xf5, 0x80, 0x80, 0x80}, {0xff}, {0xe4, 0xbd}, {0xf0, 0x9f, 0x98}, {0xc2, 0xc2, 0xa9},
+    };
+
+    for (const auto& piece : pieces) {
+        for (size_t offset = 0; offset <= 70; ++offset) {
+            for (size_t suffix : {0, 1, 40}) {
+                vector<unsigned char> s(offset, 'a');
+                s.insert(s.end(), piece.begin(), piece.end());
+                s.insert(s.end(), suffix, 'b');
+                EXPECT_EQ(copy_valid(s), scalar_valid(s)) << offset << ' ' << suffix << ' ' << int(piece[0]);
+            }
+        }
+    }
+}
+
+GTEST_TEST(utf8, random) {
+    mt19937 gen(42);
+    const array<unsigned char, 12> alphabet{'a', 0x80, 0x9f, 0xa0, 0xbf, 0xc2, 0xdf, 0xe0, 0xed, 0xef, 0xf0, 0xf4};
+
+    size_t valid = 0;
+    for (size_t i = 0; i < 20000; ++i) {
+        vector<unsigned char> s(gen() % 100);
+        for (auto& c : s) {
+            c = alphabet[gen() % alphabet.size()];
+        }
+        const bool expected = scalar_valid(s);
+        valid += expected;
+        EXPECT_EQ(copy_valid(s), expected);
+    }
+    EXPECT_GT(valid, 0);
+
+    // valid strings from random code points
+    for (size_t i = 0; i < 2000; ++i) {
+        vector<unsigned char> s;
+        for (size_t n = gen() % 60; n > 0; --n) {
+            uint32_t cp = gen() % 0x110000;
+            if (cp >= 0xd800 && cp < 0xe000) {
+                cp = 'x';
+            }
+            if (cp < 0x80) {
+                s.push_back(cp);
+            } else if (cp < 0x800) {
+                s.insert(s.end(), {static_cast<unsigned char>(0xc0 | cp >> 6), static_cast<unsigned char>(0x80 | (cp & 0x3f))});
+            } else if (cp < 0x10000) {
+                s.insert(s.end(), {static_cast<unsigned char>(0xe0 | cp >> 12), static_cast<unsigned char>(0x80 | (cp >> 6 & 0x3f)),
+                                   static_cast<unsigned char>(0x80 | (cp & 0x3f))});
+            } else {
+                s.insert(s.end(), {static_cast<unsigned char>(0xf0 | cp >> 18), static_cast<unsigned char>(0x80 | (cp >> 12 & 0x3f)),
+                                   static_cast<unsigned char>(0x80 | (cp >> 6 & 0x3f)), static_cast<unsigned char>(0x80 | (cp & 0x3f))});
+            }
+        }
+        EXPECT_TRUE(scalar_valid(s));
+        EXPECT_TRUE(copy_valid(s));
+    }
+}
+
+template <typename T>
+struct test_utf8_string_coder : test_fixture<T> {};
+TYPED_TEST_SUITE(test_utf8_string_coder, coder_mode_types, test_name_generator);
+
+TYPED_TEST(test_utf8_string_coder, round_trip) {
+    using Mode = typename TestFixture::mode;
+
+    const string s = "hello \xe4\xbd\xa0\xe5\xa5\xbd, a long enough string to be copied in blocks \xf0\x9f\x98\x80";
+    array<byte, 128> a{};
+    bytes b;
+    ASSERT_TRUE(Mode::get_value_from_result(utf8_string_coder<>::encode<Mode>(s, a), b));
+
+    decode_value<string> v;
+    ASSERT_TRUE(Mode::get_value_from_result(utf8_string_coder<>::decode<Mode>(a), v));
+    EXPECT_EQ(v.first, s);
+    EXPECT_EQ(begin_diff(v.second, a), begin_diff(b, a));
+
+    string reused = "previous";
+    bytes rest;
+    ASSERT_TRUE(Mode::get_value_from_result(utf8_string_coder<>::decode_to<Mode>(reused, a), rest));
+    EXPECT_EQ(reused, s);
+}
+
+GTEST_TEST(utf8_string_coder, invalid) {
+    array<byte, 5> a{0x04_b, 0x61_b, 0xc0_b, 0xaf_b, 0x62_b};
+    EXPECT_FALSE(utf8_string_coder<>::decode<safe_mode>(a));
+    EXPECT_TRUE((string_coder::decode<safe_mode>(a)));
+
+    string s = "kept";
+    EXPECT_FALSE(utf8_string_coder<>::decode_append<safe_mode>(s, a));
+    EXPECT_EQ(s, "kept");
+
+    // unsafe mode trusts the input
+    decode_value<string> v;
+    unsafe_mode::get_value_from_result(utf8_string_coder<>::decode<unsafe_mode>(a), v);
+    EXPECT_EQ(v.first, "a\xc0\xaf" "b");
+}
+
+GTEST_TEST(utf8_string_coder, message) {
+    using M = message<utf8_string_field<"name", 1>, utf8_string_field<"tags", 2, repeated>>;
+
+    M m{"\xe4\xbd\xa0\xe5\xa5\xbd", vector<string>{"a", "\xc2\xa9"}};
+    array<byte, 64> a{};
+    bytes b;
+    ASSERT_TRUE(safe_mode::get_value_from_result(message_coder<M>::encode(m, a), b));
+    const auto size = begin_diff(b, a);
+
+    decode_value<M> v;
+    ASSERT_TRUE(safe_mode::get_value_from_result(message_coder<M>::decode(bytes{a.data(), size}), v));
+    EXPECT_EQ(v.first, m);
+
+    // break the last character of the last tag
+    a[size - 1] = 0x41_b;
+    EXPECT_FALSE(message_coder<M>::decode(bytes{a.data(), size}));
+    EXPECT_FALSE((field_name_path<M, "tags">::extract<safe_mode>(bytes{a.data(), size}, [](string_view) {})));
+}
@@ -0,0 +1,175 @@
+//   Copyright 2020-2021 PragmaTwice
+//
+//   Licensed under the Apache License, Version 2.0 (the "License");
+//   you may not use this file except in compliance with the License.
+//   You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the License is distributed on an "AS IS" BASIS,
+//   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//   See the License for the specific language governing permissions and
+//   limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <protopuf/validate.h>
+#include <algorithm>
+#include <array>
+#include <string_view>
+#include <vector>
+
+#include "test_fixture.h"
+
+using namespace pp;
+using namespace std;
+
+using Student = message<uint32_field<"id", 1>, string_field<"name", 3>>;
+using Class = message<
+    string_field<"name", 8>, message_field<"students", 3, Student, repeated>, int64_field<"scores", 4, packed>,
+    bytes_field<"avatar", 5>, oneof_field<"monitor", uint32_field<"monitor_id", 6>, string_field<"monitor_name", 7>>
+>;
+
+static bytes as_bytes_of(std::string_view s) {
+    return {reinterpret_cast<byte*>(const_cast<char*>(s.data())), s.size()};
+}
+
+GTEST_TEST(validate, varint_size) {
+    array<byte, 12> a{0x81_b, 0x82_b, 0x03_b};
+    EXPECT_EQ(varint_size(bytes{a.data(), 3}), 3);
+    EXPECT_EQ(varint_size(a), 3);
+    EXPECT_EQ(varint_size(bytes{a.data(), 2}), 0);
+    EXPECT_EQ(varint_size<2>(a), 0);
+
+    a.fill(0xff_b);
+    a[9] = 0x01_b;
+    EXPECT_EQ(varint_size(a), 10);
+    a[9] = 0x81_b;
+    EXPECT_EQ(varint_size(a), 0);
+}
+
+GTEST_TEST(validate, validate_varints) {
+    // varints of every size from 1 to 10 bytes, so that they cross word boundaries
+    vector<byte> v;
+    for (size_t n = 1; n <= 10; ++n) {
+        for (size_t i = 1; i < n; ++i) {
+            v.push_back(0x80_b);
+        }
+        v.push_back(0x01_b);
+    }
+
+    // only prefixes ending at varint boundaries are valid
+    vector<size_t> boundaries{0};
+    for (size_t n = 1; n <= 10; ++n) {
+        boundaries.push_back(boundaries.back() + n);
+    }
+
+    for (size_t i = 0; i <= v.size(); ++i) {
+        const bool expected = std::find(boundaries.begin(), boundaries.end(), i) != boundaries.end();
+        EXPECT_EQ(validate_varints(bytes{v.data(), i}), expected) << i;
+    }
+
+    vector<byte> overlong(11, 0x80_b);
+    overlong.back() = 0x01_b;
+    EXPECT_FALSE(validate_varints(overlong));
+    overlong.erase(overlong.begin());
+    EXPECT_TRUE(validate_varints(overlong));
+
+    vector<byte> tail(5, 0x01_b);
+    tail.insert(tail.end(), 10, 0x80_b);
+    tail.push_back(0x01_b);
+    EXPECT_FALSE(validate_varints(tail));
+}
+
+GTEST_TEST(validate, utf8) {
+    EXPECT_TRUE(validate_utf8(as_bytes_of("")));
+    EXPECT_TRUE(validate_utf8(as_bytes_of("hello, protopuf!")));
+    EXPECT_TRUE(validate_utf8(as_bytes_of("\xc2\xa9 \xe4\xbd\xa0\xe5\xa5\xbd \xf0\x9f\x98\x80 \xf4\x8f\xbf\xbf")));
+
+    EXPECT_FALSE(validate_utf8(as_bytes_of("\x80")));
+    EXPECT_FALSE(validate_utf8(as_bytes_of("ab\xc0\xaf")));             // overlong
+    EXPECT_FALSE(validate_utf8(as_bytes_of("\xe0\x80\xaf")));           // overlong
+    EXPECT_FALSE(validate_utf8(as_bytes_of("\xed\xa0\x80")));           // surrogate
+    EXPECT_FALSE(validate_utf8(as_bytes_of("\xf4\x90\x80\x80")));       // beyond U+10FFFF
+    EXPECT_FALSE(validate_utf8(as_bytes_of("abcdefgh\xe4\xbd")));       // truncated
+    EXPECT_FALSE(validate_utf8(as_bytes_of("\xe4\xbd\x41")));
+}
+
+GTEST_TEST(validate, message) {
+    Class c;
+    c["name"_f] = "class 101";
+    c["students"_f] = vector{Student{123, "tom"}, Student{456, "jerry"}};
+    c["scores"_f] = vector<int64>{1, -1, 300};
+    c["avatar"_f] = vector<pp::uint<1>>{0xff, 0xfe};
+    c["monitor"_f].emplace<"monitor_name">("tom");
+
+    array<byte, 128> a{};
+    bytes n;
+    ASSERT_TRUE(safe_mode::get_value_from_result(message_coder<Class>::encode(c, a), n));
+    const auto size = begin_diff(n, a);
+    EXPECT_TRUE(validate<Class>(bytes{a.data(), size}));
+    EXPECT_TRUE((validate<Class, true>(bytes{a.data(), size})));
+
+    // a truncated message is valid only if it ends at a field boundary
+    for (size_t i = 0; i < size; ++i) {
+        EXPECT_EQ(validate<Class>(bytes{a.data(), i}), message_coder<Class>::decode(bytes{a.data(), i}).has_value()) << i;
+    }
+}
+
+GTEST_TEST(validate, malformed) {
+    // field number 0
+    array<byte, 2> zero{0x00_b, 0x01_b};
+    EXPECT_FALSE(validate<Student>(zero));
+
+    // a string value for the varint field `id`
+    array<byte, 3> mismatch{0x0a_b, 0x01_b, 0x41_b};
+    EXPECT_FALSE(validate<Student>(mismatch));
+
+    // unknown fields are skipped by their wire types, except groups
+    array<byte, 9> unknown{0x10_b, 0x96_b, 0x01_b, 0x25_b, 0x01_b, 0x02_b, 0x03_b, 0x04_b, 0x08_b};
+    EXPECT_FALSE(validate<Student>(unknown));
+    EXPECT_TRUE(validate<Student>(bytes{unknown.data(), 8}));
+    array<byte, 2> group{0x13_b, 0x14_b};
+    EXPECT_FALSE(validate<Student>(group));
+
+    // varints are at most 10 bytes
+    array<byte, 11> longest{0x08_b};
+    std::fill(longest.begin() + 1, longest.end() - 1, 0x80_b);
+    longest.back() = 0x01_b;
+    EXPECT_TRUE(validate<Student>(longest));
+
+    array<byte, 12> overlong{0x08_b};
+    std::fill(overlong.begin() + 1, overlong.end() - 1, 0x80_b);
+    overlong.back() = 0x01_b;
+    EXPECT_FALSE(validate<Student>(overlong));
+
+    // a key beyond 32 bits
+    array<byte, 7> long_key{0x80_b, 0x80_b, 0x80_b, 0x80_b, 0x80_b, 0x01_b, 0x00_b};
+    EXPECT_FALSE(validate<Student>(long_key));
+
+    // a malformed embedded message: the key of `id` is followed by nothing
+    array<byte, 3> nested{0x1a_b, 0x01_b, 0x08_b};
+    EXPECT_FALSE(validate<Class>(nested));
+
+    // packed values ending in the middle of a varint
+    array<byte, 4> packed{0x22_b, 0x02_b, 0x01_b, 0x80_b};
+    EXPECT_FALSE(validate<Class>(packed));
+    packed[3] = 0x7f_b;
+    EXPECT_TRUE(validate<Class>(packed));
+}
+
+GTEST_TEST(validate, utf8_fields) {
+    using M = message<string_field<"name", 1>, bytes_field<"data", 2>, message_field<"student", 3, Student>>;
+
+    array<byte, 4> name{0x0a_b, 0x02_b, 0xc0_b, 0xaf_b};
+    EXPECT_TRUE(validate<M>(name));
+    EXPECT_FALSE((validate<M, true>(name)));
+
+    array<byte, 4> data{0x12_b, 0x02_b, 0xc0_b, 0xaf_b};
+    EXPECT_TRUE((validate<M, true>(data)));
+
+    array<byte, 6> nested{0x1a_b, 0x04_b, 0x1a_b, 0x02_b, 0xc0_b, 0xaf_b};
+    EXPECT_TRUE(validate<M>(nested));
+    EXPECT_FALSE((validate<M, true>(nested)));
+}
@@ -125,6 +125,24 @@ TYPED_TEST(test_varint, decode) {
     }
 }
 
+TYPED_TEST(test_varint, decode_to) {
+    array<byte, 10> a{0x80_b, 1_b, 0xff_b};
+    bytes b = a, r;
+
+    pp::uint<2> u = 0;
+    ASSERT_TRUE(TestFixture::mode::get_value_from_result(
+        varint_coder<pp::uint<2>>::decode_to<typename TestFixture::mode>(u, b), r));
+    EXPECT_EQ(u, 128);
+    EXPECT_EQ(begin_diff(r, b), 2);
+
+    a = {0xff_b, 0xff_b, 0xff_b, 0xff_b, 0x0f_b};
+    sint<4> s = 0;
+    ASSERT_TRUE(TestFixture::mode::get_value_from_result(
+        varint_coder<sint<4>>::decode_to<typename TestFixture::mode>(s, b), r));
+    EXPECT_EQ(s, -1);
+    EXPECT_EQ(begin_diff(r, b), 5);
+}
+
 GTEST_TEST(varint_coder, encode_with_insufficient_buffer_size) {
     run_safe_encode_tests_with_insufficient_buffer_size<varint_coder<pp::uint<2>>, 2>(pp::uint<2>(256));
 }